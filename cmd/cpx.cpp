@@ -1,6 +1,11 @@
 #include "custom_logger.h"
 #include <boost/algorithm/string.hpp>
 #include "cpx.h"
+#include "daq_sink_factory.h"
+#include "fitter.h"
+#include "experiment.h"
+#include "custom_timer.h"
+#include "offline_sort.h"
 
 const int MAX_CHARS_PER_LINE = 512;
 const int MAX_TOKENS_PER_LINE = 20;
@@ -155,6 +160,12 @@ bool Cpx::interpret(std::list<CpxLine> commands, std::vector<double> variables)
       success = run_mca(line.params);
     else if (line.command == "save_qpx")
       success = save_qpx(line.params);
+    else if (line.command == "benchmark_fit")
+      success = benchmark_fit(line.params);
+    else if (line.command == "batch_fit")
+      success = batch_fit(line.params);
+    else if (line.command == "sort_list")
+      success = sort_list(line.params);
     else if (line.command == "endfor") {
       if (variables.size())
         return true;
@@ -249,6 +260,140 @@ bool Cpx::save_qpx(std::vector<std::string> &tokens) {
   return true;
 }
 
+bool Cpx::benchmark_fit(std::vector<std::string> &tokens) {
+  if (tokens.size() < 1) {
+    ERR << "<cpx> expected syntax: benchmark_fit spectrum_file [spectrum_file ...]";
+    return false;
+  }
+
+  for (auto &file : tokens) {
+    SinkPtr spectrum = SinkFactory::getInstance().create_from_file(file);
+    if (!spectrum) {
+      ERR << "<cpx> could not load spectrum from " << file;
+      return false;
+    }
+
+    std::map<OptimizerType, std::map<double, Peak>> results;
+    for (auto &t : optimizer_types()) {
+      Fitter fitter(spectrum);
+      FitSettings fs = fitter.settings();
+      fs.optimizer = t;
+      fitter.apply_settings(fs);
+      fitter.find_regions();
+
+      std::vector<double> regions;
+      for (auto &r : fitter.regions())
+        regions.push_back(r.first);
+
+      CustomTimer timer(true);
+      for (auto &r : regions)
+        fitter.auto_fit(r, interruptor_);
+      timer.stop();
+
+      results[t] = fitter.peaks();
+      LINFO << "<cpx> " << file << " optimizer=" << optimizer_to_string(t)
+            << " regions=" << regions.size()
+            << " peaks=" << results[t].size()
+            << " time=" << timer.ms() << "ms";
+    }
+
+    //compare hypermet areas of matching peaks against fityk as reference
+    const std::map<double, Peak> &reference = results[OptimizerType::fityk];
+    for (auto &t : optimizer_types()) {
+      if ((t == OptimizerType::fityk) || reference.empty())
+        continue;
+      double sum_diff = 0, sum_rsq = 0, sum_rsq_ref = 0;
+      size_t matched = 0;
+      for (auto &p : results[t]) {
+        auto ref = reference.lower_bound(p.first - 1);
+        if ((ref == reference.end()) || (std::abs(ref->first - p.first) > 1))
+          continue;
+        double a_ref = ref->second.area_hyp().value();
+        if (a_ref != 0)
+          sum_diff += std::abs(p.second.area_hyp().value() - a_ref) / std::abs(a_ref);
+        sum_rsq += p.second.hypermet().rsq();
+        sum_rsq_ref += ref->second.hypermet().rsq();
+        matched++;
+      }
+      if (!matched)
+        continue;
+      LINFO << "<cpx> " << file << " optimizer=" << optimizer_to_string(t)
+            << " matched=" << matched
+            << " mean_area_deviation=" << (sum_diff / matched)
+            << " mean_rsq=" << (sum_rsq / matched)
+            << " mean_rsq_fityk=" << (sum_rsq_ref / matched);
+    }
+  }
+  return true;
+}
+
+bool Cpx::batch_fit(std::vector<std::string> &tokens) {
+  if (tokens.size() < 3) {
+    ERR << "<cpx> expected syntax: batch_fit [settings.set|-] [energy|-] file.qpx [file.qpx ...]";
+    return false;
+  }
+
+  FitSettings fs;
+  if (tokens[0] != "-") {
+    pugi::xml_document doc;
+    if (!doc.load_file(tokens[0].c_str())) {
+      ERR << "<cpx> could not read fit settings from " << tokens[0];
+      return false;
+    }
+    pugi::xml_node node = doc.find_node([&fs](pugi::xml_node n) {
+        return fs.xml_element_name() == n.name(); });
+    if (!node) {
+      ERR << "<cpx> no " << fs.xml_element_name() << " in " << tokens[0];
+      return false;
+    }
+    fs.from_xml(node);
+  }
+
+  double energy = std::numeric_limits<double>::quiet_NaN();
+  if (tokens[1] != "-")
+    energy = boost::lexical_cast<double>(tokens[1]);
+
+  ExperimentProject experiment;
+  std::map<int64_t, std::string> files;
+  for (size_t i=2; i < tokens.size(); ++i) {
+    ProjectPtr proj(new Project());
+    proj->read_xml(tokens[i], true, true);
+    if (proj->empty()) {
+      ERR << "<cpx> could not load project from " << tokens[i];
+      return false;
+    }
+    files[experiment.add_data(proj)] = tokens[i];
+  }
+
+  experiment.batch_fit(fs, energy, interruptor_);
+
+  for (auto &r : experiment.results()) {
+    if (!r.selected_peak.center().finite())
+      continue;
+    LINFO << "<cpx> " << files[r.idx_proj]
+          << " \"" << r.spectrum_info.get_attribute("name").value_text << "\""
+          << " energy=" << r.selected_peak.energy().to_string()
+          << " area_hyp=" << r.selected_peak.area_hyp().to_string()
+          << " area_sum4=" << r.selected_peak.area_sum4().to_string()
+          << " cps=" << r.selected_peak.cps_best().to_string();
+  }
+  return true;
+}
+
+bool Cpx::sort_list(std::vector<std::string> &tokens) {
+  if (tokens.size() < 1) {
+    ERR << "<cpx> expected syntax: sort_list list_file.qls [threads]";
+    return false;
+  }
+
+  unsigned int threads = 0;
+  if (tokens.size() > 1)
+    threads = boost::lexical_cast<unsigned int>(tokens[1]);
+
+  OfflineSorter sorter;
+  return sorter.sort(tokens[0], spectra_, interruptor_, threads);
+}
+
 bool Cpx::boot(std::vector<std::string> &tokens) {
   if (tokens.size() < 2) {
     ERR << "<cpx> expected syntax: boot [path/profile.set] [path/settingsdir]";
@@ -23,6 +23,9 @@ private:
   bool templates(std::vector<std::string> &tokens);
   bool run_mca(std::vector<std::string> &tokens);
   bool save_qpx(std::vector<std::string> &tokens);
+  bool benchmark_fit(std::vector<std::string> &tokens);
+  bool batch_fit(std::vector<std::string> &tokens);
+  bool sort_list(std::vector<std::string> &tokens);
 
   Qpx::ProjectPtr   spectra_;
   Qpx::Engine       &engine_;
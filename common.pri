@@ -88,10 +88,6 @@ win32 {
   error( "Couldn't find the sinks.pri file!" )
 }
 
-contains( DAQ_SOURCES, fitter_ceres ) {
-  DEFINES += "FITTER_CERES_ENABLED"
-}
-
 contains( DAQ_SOURCES, nexus ) {
   LIBS += -lNeXus 
   DEFINES += "NEXUS_ENABLED"
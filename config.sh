@@ -12,7 +12,6 @@ pixie4="off"
 hv8="off"
 vme="off"
 parser_evt="off"
-fitter_ceres="off"
 nexus="off"
 
 if [ ! -f config.pri ]; then
@@ -37,9 +36,6 @@ else
   if grep -q parser_evt config.pri; then 
     parser_evt="on" 
   fi
-  if grep -q fitter_ceres config.pri; then 
-    fitter_ceres="on" 
-  fi
   if grep -q nexus config.pri; then 
     nexus="on" 
   fi
@@ -53,8 +49,7 @@ options=(
          4 "Radiation Technologies HV-8" "$hv8"
          5 "VME (Wiener, Mesytec, Iseg)" "$vme"
          6 "Parser for NSCL *.evt" "$parser_evt"
-         7 "Ceres solver (fitter, experimental)" "$fitter_ceres"
-         8 "NeXus (experimental)" "$nexus"
+         7 "NeXus (experimental)" "$nexus"
         )
 choices=$("${cmd[@]}" "${options[@]}" 2>&1 >/dev/tty)
 
@@ -94,11 +89,6 @@ do
             text="${text} parser_evt"
             ;;
         7)
-            text="${text} fitter_ceres"
-            sudo apt-get install cmake libgoogle-glog-dev libatlas-base-dev libeigen3-dev libsuitesparse-dev
-
-            ;;
-        8)
             text="${text} nexus"
 
             ;;
@@ -113,6 +103,12 @@ if [ "" == "$PKG_OK" ]; then
   sudo apt-get --yes install libnlopt-dev
 fi
 
+PKG_OK=$(dpkg-query -W --showformat='${Status}\n' libeigen3-dev|grep "install ok installed")
+if [ "" == "$PKG_OK" ]; then
+  echo "Installing libeigen3"
+  sudo apt-get --yes install libeigen3-dev
+fi
+
 echo "Preparing makefiles..."
 ./prep.sh
 
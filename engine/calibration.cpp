@@ -126,10 +126,61 @@ std::string Calibration::fancy_equation(int precision, bool with_rsq) {
 }
 
 std::vector<double> Calibration::transform(std::vector<double> chans, uint16_t bits) const {
-  std::vector<double> results;
-  for (auto &q : chans)
-    results.push_back(transform(q, bits));
-  return results;
+  if (coefficients_.empty() || !bits_ || !bits)
+    return chans;
+
+  if (bits > bits_) {
+    double factor = pow(2, bits - bits_);
+    for (auto &q : chans)
+      q = q / factor;
+  }
+  if (bits < bits_) {
+    double factor = pow(2, bits_ - bits);
+    for (auto &q : chans)
+      q = q * factor;
+  }
+
+  //construct model once and evaluate in bulk
+  if (model_ == CalibrationModel::polynomial)
+    return PolyBounded(coefficients_, 0, r_squared_).eval_array(chans);
+  else if (model_ == CalibrationModel::sqrt_poly)
+    return SqrtPoly(coefficients_, 0, r_squared_).eval_array(chans);
+  else if (model_ == CalibrationModel::polylog)
+    return PolyLog(coefficients_, 0, r_squared_).eval_array(chans);
+  else if (model_ == CalibrationModel::loginverse)
+    return LogInverse(coefficients_, 0, r_squared_).eval_array(chans);
+  else if (model_ == CalibrationModel::effit)
+    return Effit(coefficients_).evaluate_array(chans);
+  else
+    return chans;
+}
+
+std::vector<double> Calibration::inverse_transform(const std::vector<double> &energies, uint16_t bits) const {
+  if (coefficients_.empty() || !bits_ || !bits)
+    return energies;
+
+  std::vector<double> bins = energies;
+  if (model_ == CalibrationModel::polynomial) {
+    //tabulate once over calibrated range, Newton only for targets outside it
+    PolyBounded poly(coefficients_, 0, r_squared_);
+    bins = poly.eval_inverse_array(energies, 0, pow(2, bits_) - 1);
+    for (size_t i=0; i < bins.size(); ++i)
+      if (std::isnan(bins[i]))
+        bins[i] = poly.eval_inverse(energies[i]);
+  }
+
+  if (bits > bits_) {
+    double factor = pow(2, bits - bits_);
+    for (auto &q : bins)
+      q = q / factor;
+  }
+  if (bits < bits_) {
+    double factor = pow(2, bits_ - bits);
+    for (auto &q : bins)
+      q = q * factor;
+  }
+
+  return bins;
 }
 
 std::string Calibration::coef_to_string() const{
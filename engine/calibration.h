@@ -63,6 +63,7 @@ class Calibration : public XMLable {
   double inverse_transform(double, uint16_t) const;
 
   std::vector<double> transform(std::vector<double>, uint16_t) const;
+  std::vector<double> inverse_transform(const std::vector<double>&, uint16_t) const;
   std::string coef_to_string() const;
   void coef_from_string(std::string);
   std::string axis_name() const;
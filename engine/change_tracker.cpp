@@ -0,0 +1,94 @@
+/*******************************************************************************
+ *
+ * This software was developed at the National Institute of Standards and
+ * Technology (NIST) by employees of the Federal Government in the course
+ * of their official duties. Pursuant to title 17 Section 105 of the
+ * United States Code, this software is not subject to copyright protection
+ * and is in the public domain. NIST assumes no responsibility whatsoever for
+ * its use by other parties, and makes no guarantees, expressed or implied,
+ * about its quality, reliability, or any other characteristic.
+ *
+ * Author(s):
+ *      Martin Shetty (NIST)
+ *
+ * Description:
+ *      Qpx::ChangeTracker - tiles of binned data touched per generation,
+ *                           lets readers fetch only what changed
+ *
+ ******************************************************************************/
+
+#include "change_tracker.h"
+#include <algorithm>
+
+namespace Qpx {
+
+ChangeTracker::ChangeTracker()
+  : generation_(1)
+  , reset_generation_(1)
+  , tile_bits_(0)
+  , size0_(0), size1_(0)
+  , tiles0_(0), tiles1_(0)
+  , last_tile_(-1)
+{}
+
+void ChangeTracker::resize(size_t size0, size_t size1, uint16_t tile_bits)
+{
+  tile_bits_ = tile_bits;
+  size0_ = size0;
+  size1_ = std::max(size1, size_t(1));
+  tiles0_ = (size0_ + (size_t(1) << tile_bits_) - 1) >> tile_bits_;
+  tiles1_ = (size1_ + (size_t(1) << tile_bits_) - 1) >> tile_bits_;
+  touch_all();
+}
+
+void ChangeTracker::touch_all()
+{
+  pending_.clear();
+  last_tile_ = -1;
+  history_.clear();
+  reset_generation_ = generation_++;
+}
+
+void ChangeTracker::advance()
+{
+  if (!pending_.empty()) {
+    history_.push_back(Touched{generation_, std::vector<size_t>(pending_.begin(), pending_.end())});
+    pending_.clear();
+    last_tile_ = -1;
+  }
+  generation_++;
+
+  while (history_.size() > max_history) {
+    reset_generation_ = std::max(reset_generation_, history_.front().generation);
+    history_.pop_front();
+  }
+}
+
+bool ChangeTracker::all_since(uint64_t since) const
+{
+  return (since == 0) || (reset_generation_ >= since);
+}
+
+std::vector<ChangeTracker::Tile> ChangeTracker::dirty_since(uint64_t since) const
+{
+  std::vector<size_t> touched(pending_.begin(), pending_.end());
+  for (auto &h : history_)
+    if (h.generation >= since)
+      touched.insert(touched.end(), h.tiles.begin(), h.tiles.end());
+  std::sort(touched.begin(), touched.end());
+  touched.erase(std::unique(touched.begin(), touched.end()), touched.end());
+
+  std::vector<Tile> ret;
+  size_t span = size_t(1) << tile_bits_;
+  for (auto t : touched) {
+    Tile tile;
+    tile.min0 = (t % tiles0_) * span;
+    tile.max0 = std::min(tile.min0 + span, size0_) - 1;
+    tile.min1 = (t / tiles0_) * span;
+    tile.max1 = std::min(tile.min1 + span, size1_) - 1;
+    ret.push_back(tile);
+  }
+  return ret;
+}
+
+}
@@ -0,0 +1,94 @@
+/*******************************************************************************
+ *
+ * This software was developed at the National Institute of Standards and
+ * Technology (NIST) by employees of the Federal Government in the course
+ * of their official duties. Pursuant to title 17 Section 105 of the
+ * United States Code, this software is not subject to copyright protection
+ * and is in the public domain. NIST assumes no responsibility whatsoever for
+ * its use by other parties, and makes no guarantees, expressed or implied,
+ * about its quality, reliability, or any other characteristic.
+ *
+ * Author(s):
+ *      Martin Shetty (NIST)
+ *
+ * Description:
+ *      Qpx::ChangeTracker - tiles of binned data touched per generation,
+ *                           lets readers fetch only what changed
+ *
+ ******************************************************************************/
+
+#ifndef QPX_CHANGE_TRACKER_H
+#define QPX_CHANGE_TRACKER_H
+
+#include <vector>
+#include <deque>
+#include <unordered_set>
+#include <cstdint>
+#include <cstddef>
+
+namespace Qpx {
+
+class ChangeTracker {
+public:
+  //inclusive bin ranges covered by one tile
+  struct Tile {
+    size_t min0, max0;
+    size_t min1, max1;
+  };
+
+  ChangeTracker();
+
+  //tiles of 2^tile_bits bins per dimension, everything marked as changed
+  void resize(size_t size0, size_t size1, uint16_t tile_bits);
+
+  //bins outside of tracked extent fall back to marking everything;
+  //only touched tiles are kept, so cost follows activity, not extent
+  inline void touch(size_t c0, size_t c1 = 0)
+  {
+    size_t t0 = c0 >> tile_bits_;
+    size_t t1 = c1 >> tile_bits_;
+    if ((t0 < tiles0_) && (t1 < tiles1_)) {
+      size_t t = t1 * tiles0_ + t0;
+      if (t != last_tile_) {
+        pending_.insert(t);
+        last_tile_ = t;
+      }
+    } else
+      reset_generation_ = generation_; //advanced by owner after the batch
+  }
+
+  void touch_all();
+  void advance();
+
+  uint64_t generation() const { return generation_; }
+
+  //true if tiles cannot tell, readers should take everything
+  bool all_since(uint64_t since) const;
+
+  //tiles touched at or after given generation
+  std::vector<Tile> dirty_since(uint64_t since) const;
+
+private:
+  //older generations are forgotten, readers that far behind take everything
+  static const size_t max_history = 64;
+
+  struct Touched {
+    uint64_t generation;
+    std::vector<size_t> tiles;
+  };
+
+  uint64_t generation_;
+  uint64_t reset_generation_;
+
+  uint16_t tile_bits_;
+  size_t size0_, size1_;
+  size_t tiles0_, tiles1_;
+
+  std::unordered_set<size_t> pending_; //touched in current generation
+  size_t last_tile_;                    //skips rehashing runs in one tile
+  std::deque<Touched> history_;
+};
+
+}
+
+#endif
@@ -22,6 +22,8 @@
  *
  ******************************************************************************/
 
+#include <limits>
+#include <memory>
 #include <boost/algorithm/string.hpp>
 #include "daq_sink.h"
 #include "custom_logger.h"
@@ -275,28 +277,192 @@ PreciseFloat Sink::data(std::initializer_list<size_t> list ) const {
   return this->_data(list);
 }
 
-std::unique_ptr<std::list<Entry>> Sink::data_range(std::initializer_list<Pair> list) {
+bool Sink::data_dense(std::initializer_list<Pair> list, std::vector<double> &values) const {
   boost::shared_lock<boost::shared_mutex> lock(shared_mutex_);
   if (list.size() != this->metadata_.dimensions())
-    return 0; //wtf???
-  else {
-    //    std::vector<Pair> ranges(list.begin(), list.end());
-    return this->_data_range(list);
+    return false;
+
+  size_t total = 1;
+  for (auto &r : list) {
+    if (r.second < r.first)
+      return false;
+    total *= (r.second - r.first + 1);
   }
+
+  values.assign(total, 0.0);
+  this->_data_dense(list, values);
+  return true;
 }
 
-void Sink::append(const Entry& e) {
+bool Sink::data_sparse(std::initializer_list<Pair> list, SparseData &data) const {
+  boost::shared_lock<boost::shared_mutex> lock(shared_mutex_);
+  data.clear();
+  data.dimensions = this->metadata_.dimensions();
+  if (list.size() != data.dimensions)
+    return false;
+  this->_data_sparse(list, data);
+  return true;
+}
+
+bool Sink::data_rebinned(uint16_t level, std::initializer_list<Pair> list, std::vector<double> &values) const {
   boost::shared_lock<boost::shared_mutex> lock(shared_mutex_);
+  if (list.size() != this->metadata_.dimensions())
+    return false;
+
+  size_t total = 1;
+  for (auto &r : list) {
+    if (r.second < r.first)
+      return false;
+    total *= (r.second - r.first + 1);
+  }
+
+  values.assign(total, 0.0);
+  this->_data_rebinned(level, list, values);
+  return true;
+}
+
+std::unique_ptr<std::list<Entry>> Sink::data_range(std::initializer_list<Pair> list) const {
+  SparseData data;
+  if (!data_sparse(list, data))
+    return 0;
+
+  std::unique_ptr<std::list<Entry>> result(new std::list<Entry>);
+  auto c = data.coords.begin();
+  for (auto &v : data.values) {
+    Entry newentry;
+    newentry.first.assign(c, c + data.dimensions);
+    newentry.second = v;
+    result->push_back(newentry);
+    c += data.dimensions;
+  }
+  return result;
+}
+
+void Sink::_data_dense(std::initializer_list<Pair> list, std::vector<double> &values) const {
+  SparseData data;
+  data.dimensions = list.size();
+  this->_data_sparse(list, data);
+
+  std::vector<Pair> ranges(list.begin(), list.end());
+  auto c = data.coords.begin();
+  for (auto &v : data.values) {
+    size_t idx = 0, stride = 1;
+    bool in_range = true;
+    for (size_t d = 0; d < ranges.size(); ++d) {
+      size_t coord = *(c + d);
+      if ((coord < ranges[d].first) || (coord > ranges[d].second)) {
+        in_range = false;
+        break;
+      }
+      idx += (coord - ranges[d].first) * stride;
+      stride *= (ranges[d].second - ranges[d].first + 1);
+    }
+    if (in_range)
+      values[idx] += v;
+    c += data.dimensions;
+  }
+}
+
+void Sink::append(const Entry& e) {
+  boost::unique_lock<boost::shared_mutex> uniqueLock(shared_mutex_);
   if (metadata_.dimensions() < 1)
     return;
+  this->_append(e);
+  changes_.advance();
+  snapshot_stale_ = true;
+}
+
+bool Sink::merge(const Sink &other, bool same_run) {
+  if (&other == this)
+    return false;
+  //lock both together, a.merge(b) racing b.merge(a) must not deadlock
+  boost::unique_lock<boost::shared_mutex> uniqueLock(shared_mutex_, boost::defer_lock);
+  boost::shared_lock<boost::shared_mutex> otherLock(other.shared_mutex_, boost::defer_lock);
+  boost::lock(uniqueLock, otherLock);
+  if ((other.my_type() != my_type())
+      || (other.metadata_.dimensions() != metadata_.dimensions()))
+    return false;
+  if (!this->_merge(other, same_run))
+    return false;
+  changes_.advance();
+  changed_ = true;
+  snapshot_stale_ = true;
+  return true;
+}
+
+uint64_t Sink::generation() const {
+  boost::shared_lock<boost::shared_mutex> lock(shared_mutex_);
+  return changes_.generation();
+}
+
+uint64_t Sink::changes_since(uint64_t generation, SparseData &changes) const {
+  boost::shared_lock<boost::shared_mutex> lock(shared_mutex_);
+  changes.clear();
+  changes.dimensions = this->metadata_.dimensions();
+
+  //read before data, anything binned meanwhile is reported again next time
+  uint64_t current = changes_.generation();
+  if (changes_.all_since(generation))
+    this->_data_all(changes);
   else
-    this->_append(e);
+    this->_changes_since(generation, changes);
+  return current;
+}
+
+void Sink::_data_rebinned(uint16_t level, std::initializer_list<Pair> list, std::vector<double> &values) const {
+  SparseData data;
+  data.dimensions = list.size();
+  this->_data_all(data);
+
+  std::vector<Pair> ranges(list.begin(), list.end());
+  auto c = data.coords.begin();
+  for (auto &v : data.values) {
+    size_t idx = 0, stride = 1;
+    bool in_range = true;
+    for (size_t d = 0; d < ranges.size(); ++d) {
+      size_t coord = *(c + d) >> level;
+      if ((coord < ranges[d].first) || (coord > ranges[d].second)) {
+        in_range = false;
+        break;
+      }
+      idx += (coord - ranges[d].first) * stride;
+      stride *= (ranges[d].second - ranges[d].first + 1);
+    }
+    if (in_range)
+      values[idx] += v;
+    c += data.dimensions;
+  }
+}
+
+void Sink::_data_all(SparseData &data) const {
+  size_t max = std::numeric_limits<size_t>::max();
+  if (metadata_.dimensions() == 1)
+    this->_data_sparse({{0, max}}, data);
+  else if (metadata_.dimensions() == 2)
+    this->_data_sparse({{0, max}, {0, max}}, data);
+}
+
+bool Sink::add_sum4_monitor(const SUM4Stream &region) {
+  boost::unique_lock<boost::shared_mutex> uniqueLock(shared_mutex_);
+  if (!region.valid())
+    return false;
+  snapshot_stale_ = true;
+  return this->_add_sum4_monitor(region);
+}
+
+std::vector<SUM4Stream> Sink::sum4_monitors() const {
+  boost::shared_lock<boost::shared_mutex> lock(shared_mutex_);
+  return this->_sum4_monitors();
+}
+
+void Sink::clear_sum4_monitors() {
+  boost::unique_lock<boost::shared_mutex> uniqueLock(shared_mutex_);
+  this->_clear_sum4_monitors();
+  snapshot_stale_ = true;
 }
 
 bool Sink::from_prototype(const Metadata& newtemplate) {
-  boost::unique_lock<boost::mutex> uniqueLock(unique_mutex_, boost::defer_lock);
-  while (!uniqueLock.try_lock())
-    boost::this_thread::sleep_for(boost::chrono::seconds{1});
+  boost::unique_lock<boost::shared_mutex> uniqueLock(shared_mutex_);
 
   if (metadata_.type() != newtemplate.type())
     return false;
@@ -304,16 +470,18 @@ bool Sink::from_prototype(const Metadata& newtemplate) {
   metadata_.overwrite_all_attributes(newtemplate.attributes());
   metadata_.detectors.clear(); // really?
 
+  changes_.touch_all();
+  snapshot_stale_ = true;
   return (this->_initialize());
 //  DBG << "<Sink::from_prototype>" << metadata_.get_attribute("name").value_text << " made with dims=" << metadata_.dimensions();
 //  DBG << "from prototype " << metadata_.debug();
 }
 
 void Sink::push_spill(const Spill& one_spill) {
-  boost::unique_lock<boost::mutex> uniqueLock(unique_mutex_, boost::defer_lock);
-  while (!uniqueLock.try_lock())
-    boost::this_thread::sleep_for(boost::chrono::seconds{1});
+  boost::unique_lock<boost::shared_mutex> uniqueLock(shared_mutex_);
   this->_push_spill(one_spill);
+  changes_.advance();
+  snapshot_stale_ = true;
 }
 
 void Sink::_push_spill(const Spill& one_spill) {
@@ -336,10 +504,52 @@ void Sink::_push_spill(const Spill& one_spill) {
 }
 
 void Sink::flush() {
-  boost::unique_lock<boost::mutex> uniqueLock(unique_mutex_, boost::defer_lock);
-  while (!uniqueLock.try_lock())
-    boost::this_thread::sleep_for(boost::chrono::seconds{1});
+  boost::unique_lock<boost::shared_mutex> uniqueLock(shared_mutex_);
   this->_flush();
+  changes_.advance();
+  snapshot_stale_ = true;
+}
+
+bool Sink::set_sort_window(double from_ns, double to_ns) {
+  boost::unique_lock<boost::shared_mutex> uniqueLock(shared_mutex_);
+  return this->_set_sort_window(from_ns, to_ns);
+}
+
+double Sink::sort_margin() const {
+  boost::shared_lock<boost::shared_mutex> lock(shared_mutex_);
+  return this->_sort_margin();
+}
+
+std::shared_ptr<const Sink> Sink::snapshot() const
+{
+  std::shared_ptr<const Sink> previous;
+  {
+    boost::unique_lock<boost::mutex> snapLock(snapshot_mutex_);
+    if (snapshot_ && !snapshot_stale_)
+      return snapshot_;
+    previous = snapshot_;
+  }
+
+  //published copies are immutable, so duplicating one needs no lock on this sink
+  std::unique_ptr<Sink> older(previous ? previous->clone() : nullptr);
+  uint64_t since = older ? older->changes_.generation() : 0;
+
+  //waits at most for the spill being binned, sorting then only waits for the delta
+  boost::shared_lock<boost::shared_mutex> lock(shared_mutex_);
+  Sink* fresh = nullptr;
+  if (older && !changes_.all_since(since))
+    fresh = this->_clone_onto(*older, since);
+  if (!fresh)
+    fresh = this->clone();
+  std::shared_ptr<const Sink> ret(fresh);
+
+  boost::unique_lock<boost::mutex> snapLock(snapshot_mutex_);
+  //another reader may have published a newer one meanwhile
+  if (!snapshot_ || (snapshot_->changes_.generation() <= fresh->changes_.generation())) {
+    snapshot_ = ret;
+    snapshot_stale_ = false;
+  }
+  return ret;
 }
 
 
@@ -360,18 +570,15 @@ bool Sink::changed() const
 }
 
 void Sink::set_detectors(const std::vector<Qpx::Detector>& dets) {
-  boost::unique_lock<boost::mutex> uniqueLock(unique_mutex_, boost::defer_lock);
-  while (!uniqueLock.try_lock())
-    boost::this_thread::sleep_for(boost::chrono::seconds{1});
+  boost::unique_lock<boost::shared_mutex> uniqueLock(shared_mutex_);
   
   this->_set_detectors(dets);
   changed_ = true;
+  snapshot_stale_ = true;
 }
 
 void Sink::reset_changed() {
-  boost::unique_lock<boost::mutex> uniqueLock(unique_mutex_, boost::defer_lock);
-  while (!uniqueLock.try_lock())
-    boost::this_thread::sleep_for(boost::chrono::seconds{1});
+  boost::unique_lock<boost::shared_mutex> uniqueLock(shared_mutex_);
   changed_ = false;
 }
 
@@ -381,16 +588,18 @@ bool Sink::write_file(std::string dir, std::string format) const {
 }
 
 bool Sink::read_file(std::string name, std::string format) {
-  boost::unique_lock<boost::mutex> uniqueLock(unique_mutex_, boost::defer_lock);
-  while (!uniqueLock.try_lock())
-    boost::this_thread::sleep_for(boost::chrono::seconds{1});
+  boost::unique_lock<boost::shared_mutex> uniqueLock(shared_mutex_);
+  changes_.touch_all();
+  snapshot_stale_ = true;
   return _read_file(name, format);
 }
 
 //accessors for various properties
 Metadata Sink::metadata() const {
   boost::shared_lock<boost::shared_mutex> lock(shared_mutex_);
-  return metadata_;
+  Metadata ret = metadata_;
+  this->_export_attributes(ret);
+  return ret;
 }
 
 std::string Sink::type() const {
@@ -435,19 +644,17 @@ std::string Sink::debug() const
 //change stuff
 
 void Sink::set_attribute(const Setting &setting) {
-  boost::unique_lock<boost::mutex> uniqueLock(unique_mutex_, boost::defer_lock);
-  while (!uniqueLock.try_lock())
-    boost::this_thread::sleep_for(boost::chrono::seconds{1});
+  boost::unique_lock<boost::shared_mutex> uniqueLock(shared_mutex_);
   metadata_.set_attribute(setting);
   changed_ = true;
+  snapshot_stale_ = true;
 }
 
 void Sink::set_attributes(const Setting &settings) {
-  boost::unique_lock<boost::mutex> uniqueLock(unique_mutex_, boost::defer_lock);
-  while (!uniqueLock.try_lock())
-    boost::this_thread::sleep_for(boost::chrono::seconds{1});
+  boost::unique_lock<boost::shared_mutex> uniqueLock(shared_mutex_);
   metadata_.set_attributes(settings);
   changed_ = true;
+  snapshot_stale_ = true;
 }
 
 
@@ -463,7 +670,9 @@ void Sink::save(pugi::xml_node &root) const {
   pugi::xml_node node = root.append_child("Sink");
   node.append_attribute("type").set_value(this->my_type().c_str());
 
-  metadata_.to_xml(node);
+  Metadata md = metadata_;
+  this->_export_attributes(md);
+  md.to_xml(node);
 //  if (archive.operator bool())
 //    _save_data(*archive);
 
@@ -473,9 +682,7 @@ void Sink::save(pugi::xml_node &root) const {
 
 bool Sink::load(const pugi::xml_node &node) {
 
-  boost::unique_lock<boost::mutex> uniqueLock(unique_mutex_, boost::defer_lock);
-  while (!uniqueLock.try_lock())
-    boost::this_thread::sleep_for(boost::chrono::seconds{1});
+  boost::unique_lock<boost::shared_mutex> uniqueLock(shared_mutex_);
 
   if (node.child(metadata_.xml_element_name().c_str()))
     metadata_.from_xml(node.child(metadata_.xml_element_name().c_str()));
@@ -485,7 +692,8 @@ bool Sink::load(const pugi::xml_node &node) {
     this_data = std::string(node.child_value("Data"));
   boost::algorithm::trim(this_data);
   this->_data_from_xml(this_data);
-
+  changes_.touch_all();
+  snapshot_stale_ = true;
 
 //  DBG << "Settings just prior to init \n" + metadata_.attributes().debug();
 
@@ -33,10 +33,13 @@
 
 #include <initializer_list>
 #include <boost/thread.hpp>
+#include <boost/atomic.hpp>
 
 #include "spill.h"
 #include "detector.h"
 #include "custom_logger.h"
+#include "sum4_stream.h"
+#include "change_tracker.h"
 
 namespace Qpx {
 
@@ -44,6 +47,20 @@ typedef std::pair<std::vector<size_t>, PreciseFloat> Entry;
 typedef std::list<Entry> EntryList;
 typedef std::pair<size_t, size_t> Pair;
 
+//contiguous bulk data in coordinate format,
+//coords holds dimensions values per point, in the order of values
+struct SparseData {
+  uint16_t dimensions {0};
+  std::vector<size_t> coords;
+  std::vector<double> values;
+
+  size_t size() const {return values.size();}
+  void clear() {coords.clear(); values.clear();}
+  void add(size_t c0, double val) {coords.push_back(c0); values.push_back(val);}
+  void add(size_t c0, size_t c1, double val)
+    {coords.push_back(c0); coords.push_back(c1); values.push_back(val);}
+};
+
 
 class Metadata : public XMLable {
 public:
@@ -105,15 +122,23 @@ protected:
   Metadata metadata_;
   std::vector<std::vector<double> > axes_;
 
+  //readers share, writers (acquisition, setters, loading) block until exclusive
   mutable boost::shared_mutex shared_mutex_;
-  mutable boost::mutex unique_mutex_;
   bool changed_;
 
+  ChangeTracker changes_;
+
+  //last published immutable copy, not carried over to clones
+  mutable boost::mutex snapshot_mutex_;
+  mutable std::shared_ptr<const Sink> snapshot_;
+  mutable boost::atomic<bool> snapshot_stale_ {true};
+
 public:
   Sink();
   Sink(const Sink& other)
     : metadata_(other.metadata_)
-    , axes_ (other.axes_) {}
+    , axes_ (other.axes_)
+    , changes_ (other.changes_) {}
   virtual Sink* clone() const = 0;
   virtual ~Sink() {}
 
@@ -126,14 +151,51 @@ public:
   void push_spill(const Spill&);
   void flush();
 
+  //offline sorting in time slices: only events starting in [from_ns, to_ns)
+  //are counted, hits within sort_margin of the slice must still be pushed;
+  //false if sink's data cannot be summed from slices
+  bool set_sort_window(double from_ns, double to_ns);
+  double sort_margin() const;
+
+  //immutable copy for readers, built on the reader's thread; writers never copy,
+  //and after the first one only cells changed since the previous copy are taken
+  //while holding the sink, the bulk is duplicated from the previous copy unlocked
+  std::shared_ptr<const Sink> snapshot() const;
+
   //get count at coordinates in n-dimensional list
   PreciseFloat data(std::initializer_list<size_t> list = {}) const;
 
-  //optimized retrieval of bulk data as list of Entries
-  //parameters take dimensions_number of ranges (inclusive)
-  std::unique_ptr<EntryList> data_range(std::initializer_list<Pair> list = {});
+  //bulk data into contiguous buffers, parameters take dimensions_number of ranges (inclusive)
+  //dense: values resized to cover requested ranges, dimension 0 varies fastest,
+  //       cells beyond extent of sink are zero
+  //sparse: only points held by sink (native order), coordinates interleaved
+  bool data_dense(std::initializer_list<Pair> list, std::vector<double> &values) const;
+  bool data_sparse(std::initializer_list<Pair> list, SparseData &data) const;
+
+  //dense counts rebinned by 2^level per dimension, for overview display
+  //ranges given in rebinned coordinates
+  bool data_rebinned(uint16_t level, std::initializer_list<Pair> list, std::vector<double> &values) const;
+
+  //bulk data as list of Entries, adapter over data_sparse
+  std::unique_ptr<EntryList> data_range(std::initializer_list<Pair> list = {}) const;
   void append(const Entry&);
 
+  //adds all of other's data at once, for sinks no longer acquiring;
+  //live and real times add up too, unless other sorted part of same run;
+  //false if other is of another type or resolution
+  bool merge(const Sink &other, bool same_run = false);
+
+  //change tracking, generation advances with every batch of data
+  //changes_since fills bins touched at or after given generation (0 for all)
+  //and returns the generation to pass next time
+  uint64_t generation() const;
+  uint64_t changes_since(uint64_t generation, SparseData &changes) const;
+
+  //live SUM4 integrals of regions, updated as data is binned (1D only)
+  bool add_sum4_monitor(const SUM4Stream &region);
+  std::vector<SUM4Stream> sum4_monitors() const;
+  void clear_sum4_monitors();
+
   //retrieve axis-values for given dimension (can be precalculated energies)
   std::vector<double> axis_values(uint16_t dimension) const;
 
@@ -174,16 +236,34 @@ protected:
   virtual void _flush() {}
 
   virtual PreciseFloat _data(std::initializer_list<size_t>) const {return 0;}
-  virtual std::unique_ptr<std::list<Entry>> _data_range(std::initializer_list<Pair>)
-    { return std::unique_ptr<std::list<Entry>>(new std::list<Entry>); }
+  virtual void _data_sparse(std::initializer_list<Pair>, SparseData&) const {}
+  virtual void _data_dense(std::initializer_list<Pair>, std::vector<double>&) const; //scatters _data_sparse
+  virtual void _changes_since(uint64_t, SparseData &changes) const { _data_all(changes); }
+  //copy of this sink reusing counts moved out of an older private copy of it,
+  //taking only cells changed since generation; nullptr if type cannot, then cloned
+  virtual Sink* _clone_onto(Sink& /*older*/, uint64_t /*since*/) const { return nullptr; }
+  virtual void _data_rebinned(uint16_t level, std::initializer_list<Pair>, std::vector<double>&) const; //from _data_all
   virtual void _append(const Entry&) {}
+  virtual bool _merge(const Sink&, bool) {return false;}
+
+  virtual bool _set_sort_window(double, double) {return false;}
+  virtual double _sort_margin() const {return 0;}
+
+  virtual bool _add_sum4_monitor(const SUM4Stream&) {return false;}
+  virtual std::vector<SUM4Stream> _sum4_monitors() const {return std::vector<SUM4Stream>();}
+  virtual void _clear_sum4_monitors() {}
 
   virtual bool _write_file(std::string, std::string) const {return false;}
   virtual bool _read_file(std::string, std::string) {return false;}
 
+  //runtime values kept in typed members during acquisition are folded
+  //into a copy of metadata only when someone asks for it
+  virtual void _export_attributes(Metadata&) const {}
+
   virtual std::string _data_to_xml() const = 0;
   virtual uint16_t _data_from_xml(const std::string&) = 0;
 
+  void _data_all(SparseData &data) const;
 };
 
 typedef std::shared_ptr<Sink> SinkPtr;
@@ -66,6 +66,9 @@ public:
   virtual bool write_settings_bulk(Qpx::Setting &set) {return false;}
   virtual bool read_settings_bulk(Qpx::Setting &set) const {return false;}
   virtual void get_all_settings() {}
+  //refresh only what the device may change by itself (readbacks, run state),
+  //cached values of everything else are assumed current
+  virtual void get_volatile_settings() {get_all_settings();}
 
   virtual std::list<Hit> oscilloscope() {return std::list<Hit>();}
 
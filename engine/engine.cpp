@@ -30,6 +30,8 @@
 #include <boost/algorithm/string.hpp>
 #include "custom_logger.h"
 #include "daq_source_factory.h"
+#include "time_unwrap.h"
+#include "list_file.h"
 #include <iomanip>
 
 
@@ -38,6 +40,7 @@ namespace Qpx {
 Engine::Engine() {
   aggregate_status_ = SourceStatus(0);
   intrinsic_status_ = SourceStatus(0);
+  settings_stale_ = true;
 
   total_det_num_.id_ = "Total detectors";
   total_det_num_.name = "Total detectors";
@@ -90,6 +93,8 @@ void Engine::initialize(std::string profile_path, std::string settings_path) {
 
   die();
   devices_.clear();
+  //new devices have been told nothing yet, push_settings must write every branch
+  settings_tree_.branches.clear();
 
   for (auto &q : tree.branches.my_data_) {
     if (q.id_ != "Detectors") {
@@ -135,57 +140,70 @@ Qpx::Setting Engine::pull_settings() const {
 }
 
 void Engine::push_settings(const Qpx::Setting& newsettings) {
+  Qpx::Setting previous = settings_tree_;
   settings_tree_ = newsettings;
-  write_settings_bulk();
+
+  //devices only hear about branches that differ from what they were last given
+  for (auto &set : settings_tree_.branches.my_data_)
+    if (!previous.branches.has(set))
+      write_branch(set);
+  settings_index_.rebuild(settings_tree_);
 
 //  LINFO << "settings pushed branches = " << settings_tree_.branches.size();
 }
 
 bool Engine::read_settings_bulk(){
   for (auto &set : settings_tree_.branches.my_data_)
-  {
-    if (set.id_ == "Detectors") {
+    read_branch(set);
+  settings_index_.rebuild(settings_tree_);
+  save_optimization();
+  return true;
+}
 
-      //set.metadata.step = 2; //to always save
-      Qpx::Setting totaldets(total_det_num_);
-      totaldets.value_int = detectors_.size();
+void Engine::read_branch(Qpx::Setting &set) {
+  if (set.id_ == "Detectors") {
 
-      Qpx::Setting det(single_det_);
+    //set.metadata.step = 2; //to always save
+    Qpx::Setting totaldets(total_det_num_);
+    totaldets.value_int = detectors_.size();
 
-      set.branches.clear();
-      set.branches.add_a(totaldets);
+    Qpx::Setting det(single_det_);
 
-      for (size_t i=0; i < detectors_.size(); ++i) {
-        det.metadata.name = "Detector " + std::to_string(i);
-        det.value_text = detectors_[i].name_;
-        det.indices.clear();
-        det.indices.insert(i);
-        det.metadata.writable = true;
-        set.branches.add_a(det);
-      }
+    set.branches.clear();
+    set.branches.add_a(totaldets);
 
-    } else if (devices_.count(set.id_)) {
-      //DBG << "read settings bulk > " << set.id_;
-      devices_[set.id_]->read_settings_bulk(set);
+    for (size_t i=0; i < detectors_.size(); ++i) {
+      det.metadata.name = "Detector " + std::to_string(i);
+      det.value_text = detectors_[i].name_;
+      det.indices.clear();
+      det.indices.insert(i);
+      det.metadata.writable = true;
+      set.branches.add_a(det);
     }
 
+  } else if (devices_.count(set.id_)) {
+    //DBG << "read settings bulk > " << set.id_;
+    devices_[set.id_]->read_settings_bulk(set);
   }
-  save_optimization();
-  return true;
 }
 
 bool Engine::write_settings_bulk(){
-  for (auto &set : settings_tree_.branches.my_data_) {
-    if (set.id_ == "Detectors") {
-      rebuild_structure(set);
-    } else if (devices_.count(set.id_)) {
-      //DBG << "write settings bulk > " << set.id_;
-      devices_[set.id_]->write_settings_bulk(set);
-    }
-  }
+  for (auto &set : settings_tree_.branches.my_data_)
+    write_branch(set);
+  settings_index_.rebuild(settings_tree_);
   return true;
 }
 
+void Engine::write_branch(Qpx::Setting &set) {
+  settings_stale_ = true;
+  if (set.id_ == "Detectors") {
+    rebuild_structure(set);
+  } else if (devices_.count(set.id_)) {
+    //DBG << "write settings bulk > " << set.id_;
+    devices_[set.id_]->write_settings_bulk(set);
+  }
+}
+
 void Engine::rebuild_structure(Qpx::Setting &set) {
   Qpx::Setting totaldets = set.get_setting(Qpx::Setting("Total detectors"), Qpx::Match::id);
   int oldtotal = detectors_.size();
@@ -304,8 +322,9 @@ void Engine::save_optimization() {
 //    DBG << "Saving optimization channel " << i << " settings for " << detectors_[i].name_;
 //    detectors_[i].settings_ = Qpx::Setting();
     detectors_[i].settings_.indices.insert(i);
-    detectors_[i].settings_.branches.my_data_ =
-      settings_tree_.find_all(detectors_[i].settings_, Qpx::Match::indices);
+    detectors_[i].settings_.branches.my_data_.clear();
+    for (auto &q : settings_index_.find_all(detectors_[i].settings_, Qpx::Match::indices))
+      detectors_[i].settings_.branches.my_data_.push_back(*q);
     if (detectors_[i].settings_.branches.size() > 0) {
       detectors_[i].settings_.metadata.setting_type = Qpx::SettingType::stem;
       detectors_[i].settings_.id_ = "Optimization";
@@ -338,17 +357,27 @@ void Engine::load_optimization(size_t i) {
       q.indices.clear();
       q.indices.insert(i);
     }
-    settings_tree_.set_all(detectors_[i].settings_.branches.my_data_, Qpx::Match::id | Qpx::Match::indices);
+    settings_index_.set_all(detectors_[i].settings_.branches.my_data_, Qpx::Match::id | Qpx::Match::indices);
   }
 }
 
 void Engine::set_setting(Qpx::Setting address, Qpx::Match flags) {
-  if (settings_tree_.set_setting_r(address, flags))
-  {
-//    DBG << "<Engine> Success setting " << address.id_;
+  Qpx::Setting *node = settings_index_.find(address, flags);
+  Qpx::Setting *branch = settings_index_.branch_of(node);
+  if (node)
+    node->set_value(address);
+
+  if (!branch || (branch == &settings_tree_)) {
+    write_settings_bulk();
+    read_settings_bulk();
+    return;
   }
-  write_settings_bulk();
-  read_settings_bulk();
+
+  //only the device owning the setting needs to hear about it
+  write_branch(*branch);
+  read_branch(*branch);
+  settings_index_.rebuild(settings_tree_);
+  save_optimization();
 }
 
 void Engine::get_all_settings() {
@@ -358,6 +387,21 @@ void Engine::get_all_settings() {
     aggregate_status_ = aggregate_status_ | q.second->status();
   }
   read_settings_bulk();
+  settings_stale_ = false;
+}
+
+void Engine::refresh_settings() {
+  if (settings_stale_) {
+    get_all_settings();
+    return;
+  }
+
+  aggregate_status_ = SourceStatus(0);
+  for (auto &q : devices_) {
+    q.second->get_volatile_settings();
+    aggregate_status_ = aggregate_status_ | q.second->status();
+  }
+  read_settings_bulk();
 }
 
 void Engine::getMca(uint64_t timeout, ProjectPtr spectra, boost::atomic<bool>& interruptor) {
@@ -387,7 +431,7 @@ void Engine::getMca(uint64_t timeout, ProjectPtr spectra, boost::atomic<bool>& i
   boost::thread builder(boost::bind(&Qpx::Engine::worker_MCA, this, &parsedQueue, spectra));
 
   Spill* spill = new Spill;
-  get_all_settings();
+  refresh_settings();
   spill->state = pull_settings();
   spill->detectors = get_detectors();
   parsedQueue.enqueue(spill);
@@ -421,7 +465,7 @@ void Engine::getMca(uint64_t timeout, ProjectPtr spectra, boost::atomic<bool>& i
   delete anouncement_timer;
 
   spill = new Spill;
-  get_all_settings();
+  refresh_settings();
   spill->state = pull_settings();
   parsedQueue.enqueue(spill);
 
@@ -435,13 +479,19 @@ void Engine::getMca(uint64_t timeout, ProjectPtr spectra, boost::atomic<bool>& i
   LINFO << "<Engine> Acquisition finished";
 }
 
-ListData Engine::getList(uint64_t timeout, boost::atomic<bool>& interruptor) {
+bool Engine::getList(uint64_t timeout, boost::atomic<bool>& interruptor,
+                     ListConsumer consumer, size_t max_spills) {
 
   boost::unique_lock<boost::mutex> lock(mutex_);
 
+  if (!consumer) {
+    WARN << "<Engine> No consumer for list mode data";
+    return false;
+  }
+
   if (!(aggregate_status_ & SourceStatus::can_run)) {
     WARN << "<Engine> No devices exist that can perform acquisition";
-    return ListData();
+    return false;
   }
 
   if (timeout > 0)
@@ -449,19 +499,19 @@ ListData Engine::getList(uint64_t timeout, boost::atomic<bool>& interruptor) {
   else
     LINFO << "<Engine> List mode acquisition indefinite run";
 
-  Spill* one_spill;
-  ListData result;
-
   CustomTimer *anouncement_timer = nullptr;
   double secs_between_anouncements = 5;
 
-  one_spill = new Spill;
-  get_all_settings();
+  SynchronizedQueue<Spill*> parsedQueue(max_spills);
+  boost::atomic<bool> refused(false);
+
+  boost::thread streamer(boost::bind(&Qpx::Engine::worker_list, this, &parsedQueue, consumer, &refused));
+
+  Spill* one_spill = new Spill;
+  refresh_settings();
   one_spill->state = pull_settings();
   one_spill->detectors = get_detectors();
-  result.push_back(SpillPtr(one_spill));
-
-  SynchronizedQueue<Spill*> parsedQueue;
+  parsedQueue.enqueue(one_spill);
 
   if (daq_start(&parsedQueue))
     DBG << "<Engine> Started device daq threads";
@@ -477,7 +527,7 @@ ListData Engine::getList(uint64_t timeout, boost::atomic<bool>& interruptor) {
       delete anouncement_timer;
       anouncement_timer = new CustomTimer(true);
     }
-    if (interruptor.load() || (timeout && total_timer.timeout())) {
+    if (interruptor.load() || refused.load() || (timeout && total_timer.timeout())) {
       if (daq_stop())
         DBG << "<Engine> Stopped device daq threads successfully";
       else
@@ -488,18 +538,45 @@ ListData Engine::getList(uint64_t timeout, boost::atomic<bool>& interruptor) {
   delete anouncement_timer;
 
   one_spill = new Spill;
-  get_all_settings();
+  refresh_settings();
   one_spill->state = pull_settings();
   parsedQueue.enqueue(one_spill);
-//  result.push_back(SpillPtr(one_spill));
-
-  wait_ms(500);
 
   while (parsedQueue.size() > 0)
-    result.push_back(SpillPtr(parsedQueue.dequeue()));
+    wait_ms(100);
+  parsedQueue.stop();
 
+  streamer.join();
+  return !refused.load();
+}
 
-  parsedQueue.stop();
+bool Engine::getList(uint64_t timeout, boost::atomic<bool>& interruptor, std::string file_name) {
+  //written by consumer thread itself, so a slow disk holds the run back
+  //through the queue rather than dropping chunks; stored uncompressed
+  //so zlib does not hold it back either
+  ListFileWriter writer(65536, 0);
+  if (!writer.open(file_name)) {
+    ERR << "<Engine> Could not open list mode file " << file_name;
+    return false;
+  }
+
+  bool success = getList(timeout, interruptor, [&writer](SpillPtr spill) {
+    for (auto &h : spill->hits)
+      writer.add_hit(h);
+    return writer.add_spill(*spill);
+  });
+
+  writer.close();
+  LINFO << "<Engine> List mode run of " << writer.hits() << " hits written to " << file_name;
+  return success;
+}
+
+ListData Engine::getList(uint64_t timeout, boost::atomic<bool>& interruptor) {
+  ListData result;
+  getList(timeout, interruptor, [&result](SpillPtr spill) {
+    result.push_back(spill);
+    return true;
+  });
   return result;
 }
 
@@ -517,12 +594,16 @@ void Engine::worker_MCA(SynchronizedQueue<Spill*>* data_queue,
 
   std::multiset<Spill*> current_spills;
 
+  //sources' own timestamps are trusted only once checked
+  TimeUnwrap time_check;
+
   DBG << "<Engine> Spectra builder thread initiated";
   Spill* in_spill  = nullptr;
   Spill* out_spill = nullptr;
   while (true) {
     in_spill = data_queue->dequeue();
     if (in_spill != nullptr) {
+      time_check.check(*in_spill);
       for (auto &q : in_spill->stats) {
         if (q.second.source_channel >= 0) {
           queue_status[q.second.source_channel] = (!in_spill->hits.empty() || (q.second.stats_type == StatsType::stop));
@@ -564,29 +645,45 @@ void Engine::worker_MCA(SynchronizedQueue<Spill*>* data_queue,
 
       presort_cycles++;
       presort_timer.start();
-      while (!empty) {
-        Hit oldest;
+      //spills are in order on their own, so the one with the oldest front
+      //gives up everything up to the next oldest front in one splice
+      while (!empty && !current_spills.empty()) {
+        Spill* oldest = nullptr;
+        Spill* next = nullptr;
+        bool next_first = false; //ties go to whichever spill is iterated first
         for (auto &q : current_spills) {
           if (q->hits.empty()) {
             empty = true;
             break;
-          } else if ((oldest == Hit()) || (q->hits.front().timestamp() < oldest.timestamp())) {
-            oldest = q->hits.front();
-            presort_compares++;
+          }
+          presort_compares++;
+          if (!oldest || (q->hits.front().timestamp() < oldest->hits.front().timestamp())) {
+            next_first = (oldest != nullptr);
+            next = oldest;
+            oldest = q;
+          } else if (!next || (q->hits.front().timestamp() < next->hits.front().timestamp())) {
+            next_first = false;
+            next = q;
           }
         }
-        if (!empty) {
-          presort_hits++;
-          out_spill->hits.push_back(oldest);
-          for (auto &q : current_spills)
-            if ((!q->hits.empty()) && (q->hits.front().timestamp() == oldest.timestamp())) {
-              q->hits.pop_front();
-              presort_compares++;
-              break;
-            }
+        if (empty)
+          break;
+
+        auto end = oldest->hits.begin();
+        if (!next)
+          end = oldest->hits.end();
+        else {
+          const TimeStamp &limit = next->hits.front().timestamp();
+          while ((end != oldest->hits.end()) &&
+                 (next_first ? (end->timestamp() < limit) : !(limit < end->timestamp()))) {
+            ++end;
+            presort_compares++;
+          }
         }
-        if (current_spills.empty())
-          empty = true;
+        size_t count = std::distance(oldest->hits.begin(), end);
+        presort_hits += count;
+        out_spill->hits.splice(out_spill->hits.end(), oldest->hits, oldest->hits.begin(), end);
+        empty = oldest->hits.empty();
       }
       presort_timer.stop();
 
@@ -626,10 +723,25 @@ void Engine::worker_MCA(SynchronizedQueue<Spill*>* data_queue,
       break;
   }
 
+  if (time_check.anomalies())
+    WARN << "<Engine> Hit times out of order: " << time_check.to_string();
+
   DBG << "<Engine> Spectra builder terminating";
 
   spectra->flush();
 }
 
+void Engine::worker_list(SynchronizedQueue<Spill*>* data_queue, ListConsumer consumer,
+                         boost::atomic<bool>* refused) {
+  Spill* spill;
+  while ((spill = data_queue->dequeue()) != NULL) {
+    SpillPtr one_spill(spill);
+    if (!refused->load() && !consumer(one_spill)) {
+      WARN << "<Engine> List mode consumer refused spill, stopping run";
+      refused->store(true);
+    }
+  }
+}
+
 
 }
@@ -28,9 +28,11 @@
 
 #include <boost/thread.hpp>
 #include <boost/atomic.hpp>
+#include <boost/function.hpp>
 
 #include "detector.h"
 #include "generic_setting.h"
+#include "setting_index.h"
 #include "daq_source.h"
 #include "synchronized_queue.h"
 #include "project.h"
@@ -54,6 +56,14 @@ public:
   bool die();
   SourceStatus status() {return aggregate_status_;}
 
+  //list mode spills go to consumer in order as they arrive; sources wait once
+  //max_spills are queued for it. Consumer returning false ends the run.
+  typedef boost::function<bool(SpillPtr)> ListConsumer;
+  bool getList(uint64_t timeout, boost::atomic<bool>& interruptor,
+               ListConsumer consumer, size_t max_spills = 16);
+  //list mode run written to file_name, for paging through with ListFileReader
+  bool getList(uint64_t timeout, boost::atomic<bool>& interruptor, std::string file_name);
+  //whole run in memory
   ListData getList(uint64_t timeout, boost::atomic<bool>& inturruptor);
   void getMca(uint64_t timeout, ProjectPtr spectra, boost::atomic<bool> &interruptor);
 
@@ -71,6 +81,7 @@ public:
   bool write_settings_bulk();
   bool read_settings_bulk(); 
   void get_all_settings();
+  void refresh_settings(); //full pull only if something was written since the last one
 
   std::vector<Hit> oscilloscope();
   
@@ -86,6 +97,8 @@ protected:
   std::map<std::string, SourcePtr> devices_;
 
   Qpx::Setting settings_tree_;
+  Qpx::SettingIndex settings_index_; //rebuilt after bulk read/write
+  bool settings_stale_;
   Qpx::SettingMeta total_det_num_, single_det_;
 
   std::vector<Qpx::Detector> detectors_;
@@ -93,9 +106,13 @@ protected:
   void save_det_settings(Qpx::Setting&, const Qpx::Setting&, Qpx::Match flags) const;
   void load_det_settings(Qpx::Setting, Qpx::Setting&, Qpx::Match flags);
   void rebuild_structure(Qpx::Setting &set);
+  void write_branch(Qpx::Setting &set);
+  void read_branch(Qpx::Setting &set);
 
   //threads
   void worker_MCA(SynchronizedQueue<Spill*>* data_queue, ProjectPtr spectra);
+  void worker_list(SynchronizedQueue<Spill*>* data_queue, ListConsumer consumer,
+                   boost::atomic<bool>* refused);
 
 private:
 
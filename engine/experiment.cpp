@@ -23,7 +23,9 @@
 
 #include "experiment.h"
 #include "custom_logger.h"
+#include "custom_timer.h"
 #include "UncertainDouble.h"
+#include <boost/thread.hpp>
 
 namespace Qpx {
 
@@ -261,6 +263,126 @@ void ExperimentProject::gather_results()
   }
 }
 
+int64_t ExperimentProject::add_data(ProjectPtr project)
+{
+  if (!project)
+    return -1;
+
+  int64_t idx = next_idx++;
+  data[idx] = project;
+
+  DataPoint dp;
+  dp.idx_proj = idx;
+  for (auto &s : project->get_sinks())
+    if (s.second) {
+      dp.idx_sink = s.first;
+      dp.spectrum_info = s.second->metadata();
+      results_.push_back(dp);
+    }
+
+  changed_ = true;
+  return idx;
+}
+
+size_t ExperimentProject::batch_fit(const FitSettings &settings, double target_energy,
+                                    boost::atomic<bool>& interruptor, unsigned int threads)
+{
+  std::vector<std::pair<int64_t, int64_t>> jobs;
+  for (auto &r : results_)
+    if (data.count(r.idx_proj) && data.at(r.idx_proj))
+      jobs.push_back(std::pair<int64_t, int64_t>(r.idx_proj, r.idx_sink));
+
+  if (jobs.empty())
+    return 0;
+
+  if (!threads)
+    threads = boost::thread::hardware_concurrency();
+  threads = std::max(1u, std::min(threads, static_cast<unsigned int>(jobs.size())));
+
+  LINFO << "<Experiment> Batch fitting " << jobs.size()
+        << " data points using " << threads << " threads";
+  CustomTimer timer(true);
+
+  boost::atomic<size_t> next(0);
+  boost::atomic<size_t> fitted(0);
+  boost::thread_group workers;
+  for (unsigned int i=0; i < threads; ++i)
+    workers.create_thread([&]() {
+      size_t j;
+      while (!interruptor.load() && ((j = next++) < jobs.size()))
+        if (fit_point(jobs[j].first, jobs[j].second,
+                      settings, target_energy, interruptor))
+          fitted++;
+    });
+  workers.join_all();
+
+  LINFO << "<Experiment> Batch fit completed " << fitted.load() << " of "
+        << jobs.size() << " data points in " << timer.s() << " s";
+
+  gather_results();
+  changed_ = true;
+  return fitted.load();
+}
+
+bool ExperimentProject::fit_point(int64_t idx_proj, int64_t idx_sink,
+                                  const FitSettings &settings, double target_energy,
+                                  boost::atomic<bool>& interruptor)
+{
+  ProjectPtr proj = data.at(idx_proj);
+  SinkPtr sink = proj->get_sink(idx_sink);
+  if (!sink || (sink->metadata().dimensions() != 1))
+    return false;
+
+  Fitter fitter;
+  double target = target_energy;
+  if (proj->has_fitter(idx_sink)) {
+    fitter = proj->get_fitter(idx_sink);
+    std::set<double> sel = fitter.get_selected_peaks();
+    if (std::isnan(target) && sel.size() && fitter.contains_peak(*sel.begin()))
+      target = fitter.peak(*sel.begin()).energy().value();
+  }
+
+  fitter.setData(sink);
+  fitter.apply_settings(settings);
+  fitter.find_regions();
+
+  const FitSettings &fs = fitter.settings();
+  std::set<double> regions;
+  if (std::isnan(target)) {
+    for (auto &r : fitter.regions())
+      regions.insert(r.first);
+  } else {
+    double bin = fs.cali_nrg_.inverse_transform(target, fs.bits_);
+    regions = fitter.relevant_regions(bin, bin);
+  }
+
+  if (regions.empty())
+    return false;
+
+  for (auto &r : regions)
+    if (!interruptor.load())
+      fitter.auto_fit(r, interruptor);
+
+  if (!fitter.peak_count())
+    return false;
+
+  //select peak nearest to target
+  if (!std::isnan(target)) {
+    double best = -1;
+    double diff = std::numeric_limits<double>::infinity();
+    for (auto &p : fitter.peaks())
+      if (std::abs(p.second.energy().value() - target) < diff) {
+        diff = std::abs(p.second.energy().value() - target);
+        best = p.first;
+      }
+    if (best >= 0)
+      fitter.set_selected_peaks(std::set<double>({best}));
+  }
+
+  proj->update_fitter(idx_sink, fitter);
+  return true;
+}
+
 bool ExperimentProject::empty() const
 {
   if (!data.empty())
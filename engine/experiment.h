@@ -79,6 +79,14 @@ public:
   void gather_results();
   std::vector<DataPoint> results() const {return results_;}
 
+  //data point not attached to the trajectory tree, e.g. loaded from file
+  int64_t add_data(ProjectPtr project);
+
+  //headless refit of all data points, in parallel;
+  //target_energy NaN means keep the peak previously selected in each point
+  size_t batch_fit(const FitSettings &settings, double target_energy,
+                   boost::atomic<bool>& interruptor, unsigned int threads = 0);
+
   std::string xml_element_name() const {return "QpxExperiment";}
   void to_xml(pugi::xml_node &node) const;
   void from_xml(const pugi::xml_node &node);
@@ -98,6 +106,9 @@ private:
   void gather_vars_recursive(DataPoint& dp, TrajectoryPtr node);
   void find_leafs(std::list<TrajectoryPtr> &list, TrajectoryPtr node);
   double tally_real_time(TrajectoryPtr node);
+  bool fit_point(int64_t idx_proj, int64_t idx_sink,
+                 const FitSettings &settings, double target_energy,
+                 boost::atomic<bool>& interruptor);
 };
 
 
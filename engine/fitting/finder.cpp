@@ -147,15 +147,19 @@ void Finder::calc_kon() {
   fw_theoretical_nrg.clear();
   fw_theoretical_bin.clear();
   if (settings_.cali_fwhm_.valid() && settings_.cali_nrg_.valid()) {
+    fw_theoretical_nrg = settings_.cali_nrg_.transform(x_, settings_.bits_);
+    std::vector<double> fw = settings_.cali_fwhm_.transform(fw_theoretical_nrg,
+                                                              settings_.cali_fwhm_.bits_);
+    std::vector<double> left(x_.size()), right(x_.size());
     for (size_t i=0; i < x_.size(); ++i) {
-      double nrg = settings_.cali_nrg_.transform(x_[i], settings_.bits_);
-      fw_theoretical_nrg.push_back(nrg);
-      double fw = settings_.cali_fwhm_.transform(nrg);
-      double L = settings_.cali_nrg_.inverse_transform(nrg - fw/2, settings_.bits_);
-      double R = settings_.cali_nrg_.inverse_transform(nrg + fw/2, settings_.bits_);
-      double wchan = R-L;
-      fw_theoretical_bin.push_back(wchan);
+      left[i] = fw_theoretical_nrg[i] - fw[i] / 2;
+      right[i] = fw_theoretical_nrg[i] + fw[i] / 2;
     }
+    left = settings_.cali_nrg_.inverse_transform(left, settings_.bits_);
+    right = settings_.cali_nrg_.inverse_transform(right, settings_.bits_);
+    fw_theoretical_bin.resize(x_.size());
+    for (size_t i=0; i < x_.size(); ++i)
+      fw_theoretical_bin[i] = right[i] - left[i];
   }
 
   uint16_t width = settings_.KON_width;
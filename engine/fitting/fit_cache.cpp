@@ -0,0 +1,173 @@
+/*******************************************************************************
+ *
+ * This software was developed at the National Institute of Standards and
+ * Technology (NIST) by employees of the Federal Government in the course
+ * of their official duties. Pursuant to title 17 Section 105 of the
+ * United States Code, this software is not subject to copyright protection
+ * and is in the public domain. NIST assumes no responsibility whatsoever for
+ * its use by other parties, and makes no guarantees, expressed or implied,
+ * about its quality, reliability, or any other characteristic.
+ *
+ * This software can be redistributed and/or modified freely provided that
+ * any derivative works bear some notice that they are derived from it, and
+ * any modified versions bear some notice that they have been modified.
+ *
+ * Author(s):
+ *      Martin Shetty (NIST)
+ *
+ * Description:
+ *      Qpx::FitCache - autofit results addressed by hash of region inputs
+ *
+ ******************************************************************************/
+
+#include "fit_cache.h"
+#include <sstream>
+#include <iomanip>
+#include "custom_logger.h"
+
+namespace Qpx {
+
+//64-bit FNV-1a, stable across platforms so keys survive in saved projects
+class ContentHash {
+public:
+  ContentHash() : h_(14695981039346656037ULL) {}
+
+  void add(const void *data, size_t size) {
+    const unsigned char *p = static_cast<const unsigned char*>(data);
+    for (size_t i=0; i < size; ++i) {
+      h_ ^= p[i];
+      h_ *= 1099511628211ULL;
+    }
+  }
+
+  void add(double v) { add(&v, sizeof(v)); }
+  void add(int64_t v) { add(&v, sizeof(v)); }
+  void add(const std::string &s) { add(s.data(), s.size()); add(int64_t(s.size())); }
+
+  void add(const std::vector<double> &v) {
+    add(int64_t(v.size()));
+    if (!v.empty())
+      add(v.data(), v.size() * sizeof(double));
+  }
+
+  void add(const Qpx::Calibration &cal) {
+    add(int64_t(cal.model_));
+    add(int64_t(cal.bits_));
+    add(cal.coefficients_);
+  }
+
+  std::string hex() const {
+    std::stringstream ss;
+    ss << std::hex << std::setw(16) << std::setfill('0') << h_;
+    return ss.str();
+  }
+
+private:
+  uint64_t h_;
+};
+
+std::string FitCache::key(const ROI &region)
+{
+  ContentHash hash;
+
+  hash.add(region.finder().x_);
+  hash.add(region.finder().y_);
+
+  hash.add(region.LB().left());
+  hash.add(region.LB().right());
+  hash.add(region.RB().left());
+  hash.add(region.RB().right());
+
+  //spectrum-specific settings are not part of the xml representation
+  FitSettings fs = region.fit_settings();
+  pugi::xml_document doc;
+  fs.to_xml(doc);
+  std::stringstream ss;
+  doc.save(ss, "", pugi::format_raw);
+  hash.add(ss.str());
+  hash.add(fs.cali_nrg_);
+  hash.add(fs.cali_fwhm_);
+  hash.add(int64_t(fs.bits_));
+  hash.add(int64_t(fs.live_time.total_microseconds()));
+  hash.add(int64_t(fs.real_time.total_microseconds()));
+
+  return hash.hex();
+}
+
+void FitCache::bind(const Finder &finder)
+{
+  ContentHash hash;
+  hash.add(finder.x_);
+  hash.add(finder.y_);
+  std::string data_key = hash.hex();
+  if (data_key != data_key_)
+    clear();
+  data_key_ = data_key;
+}
+
+bool FitCache::contains(const std::string &key) const
+{
+  return (entries_.count(key) > 0);
+}
+
+ROI FitCache::get(const std::string &key)
+{
+  if (!contains(key))
+    return ROI();
+  Entry &e = entries_.at(key);
+  e.last_used = ++tick_;
+  return e.region;
+}
+
+void FitCache::store(const std::string &key, const ROI &region)
+{
+  if (!region.width())
+    return;
+  entries_[key] = Entry{region, ++tick_};
+  evict();
+}
+
+void FitCache::clear()
+{
+  entries_.clear();
+}
+
+void FitCache::evict()
+{
+  while (entries_.size() > capacity_) {
+    auto oldest = entries_.begin();
+    for (auto it = entries_.begin(); it != entries_.end(); ++it)
+      if (it->second.last_used < oldest->second.last_used)
+        oldest = it;
+    entries_.erase(oldest);
+  }
+}
+
+void FitCache::to_xml(pugi::xml_node &root, const Finder &parent_finder,
+                      const std::set<double> &region_ids) const
+{
+  pugi::xml_node node = root.append_child(this->xml_element_name().c_str());
+  for (auto &e : entries_) {
+    if (!region_ids.count(e.second.region.ID()))
+      continue;
+    pugi::xml_node entry = node.append_child("Entry");
+    entry.append_attribute("key").set_value(e.first.c_str());
+    e.second.region.to_xml(entry, parent_finder);
+  }
+}
+
+void FitCache::from_xml(const pugi::xml_node &node, const Finder &parent_finder)
+{
+  clear();
+  for (auto &entry : node.children("Entry")) {
+    std::string key(entry.attribute("key").value());
+    ROI region;
+    if (key.empty() || !entry.child(region.xml_element_name().c_str()))
+      continue;
+    region.from_xml(entry.child(region.xml_element_name().c_str()), parent_finder);
+    store(key, region);
+  }
+  DBG << "<FitCache> restored " << entries_.size() << " cached region fits";
+}
+
+}
@@ -0,0 +1,70 @@
+/*******************************************************************************
+ *
+ * This software was developed at the National Institute of Standards and
+ * Technology (NIST) by employees of the Federal Government in the course
+ * of their official duties. Pursuant to title 17 Section 105 of the
+ * United States Code, this software is not subject to copyright protection
+ * and is in the public domain. NIST assumes no responsibility whatsoever for
+ * its use by other parties, and makes no guarantees, expressed or implied,
+ * about its quality, reliability, or any other characteristic.
+ *
+ * This software can be redistributed and/or modified freely provided that
+ * any derivative works bear some notice that they are derived from it, and
+ * any modified versions bear some notice that they have been modified.
+ *
+ * Author(s):
+ *      Martin Shetty (NIST)
+ *
+ * Description:
+ *      Qpx::FitCache - autofit results addressed by hash of region inputs
+ *
+ ******************************************************************************/
+
+#ifndef QPX_FIT_CACHE_H
+#define QPX_FIT_CACHE_H
+
+#include "roi.h"
+
+namespace Qpx {
+
+class FitCache {
+public:
+  //least recently used entries are evicted beyond capacity
+  FitCache(size_t capacity = 256) : capacity_(capacity), tick_(0) {}
+
+  //hash over x/y slice, background edges and fit settings of a region
+  static std::string key(const ROI &region);
+
+  //entries belong to the spectrum the finder holds, cleared when it changes
+  void bind(const Finder &finder);
+
+  bool contains(const std::string &key) const;
+  ROI get(const std::string &key);
+  void store(const std::string &key, const ROI &region);
+
+  size_t size() const { return entries_.size(); }
+  void clear();
+
+  //XMLable, saves only entries of the given regions
+  void to_xml(pugi::xml_node &node, const Finder &parent_finder,
+              const std::set<double> &region_ids) const;
+  void from_xml(const pugi::xml_node &node, const Finder &parent_finder);
+  std::string xml_element_name() const {return "FitCache";}
+
+private:
+  struct Entry {
+    ROI region;
+    uint64_t last_used;
+  };
+
+  size_t capacity_;
+  uint64_t tick_;
+  std::string data_key_;
+  std::map<std::string, Entry> entries_;
+
+  void evict();
+};
+
+}
+
+#endif
@@ -28,7 +28,7 @@
 
 namespace Qpx {
 
-void Fitter::setData(SinkPtr spectrum)
+void Fitter::setData(std::shared_ptr<const Sink> spectrum)
 {
 //  clear();
   if (spectrum) {
@@ -54,30 +54,23 @@ void Fitter::setData(SinkPtr spectrum)
     finder_.settings_.live_time = md.get_attribute("live_time").value_duration;
     finder_.settings_.real_time = md.get_attribute("real_time").value_duration;
 
-    std::shared_ptr<EntryList> spectrum_dump = std::move(spectrum->data_range({{0, pow(2,finder_.settings_.bits_)}}));
-    std::vector<double> x;
-    std::vector<double> y;
-
-    int i = 0, j = 0;
-    int x_bound = 0;
-    bool go = false;
-    for (auto it : *spectrum_dump) {
-      if (it.second > 0)
-        go = true;
-      if (go) {
-        x.push_back(static_cast<double>(i));
-        y.push_back(static_cast<double>(it.second));
-        if (it.second > 0)
-          x_bound = j+1;
-        j++;
-      }
-      i++;
-    }
+    std::vector<double> spectrum_dump;
+    spectrum->data_dense({{0, pow(2,finder_.settings_.bits_) - 1}}, spectrum_dump);
+
+    //trim empty channels at both ends
+    size_t first = 0, last = spectrum_dump.size();
+    while ((first < last) && !(spectrum_dump[first] > 0))
+      first++;
+    while ((last > first) && !(spectrum_dump[last-1] > 0))
+      last--;
 
-    x.resize(x_bound);
-    y.resize(x_bound);
+    std::vector<double> x(last - first);
+    std::vector<double> y(spectrum_dump.begin() + first, spectrum_dump.begin() + last);
+    for (size_t i = 0; i < x.size(); ++i)
+      x[i] = static_cast<double>(first + i);
 
     finder_ = Finder(x, y, finder_.settings_);
+    fit_cache_.bind(finder_);
     apply_settings(finder_.settings_);
   }
 }
@@ -87,11 +80,13 @@ void Fitter::clear() {
   metadata_ = Metadata();
   finder_.clear();
   regions_.clear();
+  fit_cache_.clear();
 }
 
 
 void Fitter::find_regions() {
   regions_.clear();
+  finder_.reset(); //residuals of discarded regions would skew the search
 //  DBG << "Fitter: looking for " << filtered.size()  << " peaks";
 
   finder_.find_peaks();
@@ -278,11 +273,24 @@ bool Fitter::auto_fit(double regionID,  boost::atomic<bool>& interruptor) {
   if (!regions_.count(regionID))
     return false;
 
-  regions_[regionID].auto_fit(interruptor);
+  cached_auto_fit(regions_[regionID], interruptor);
   render_all();
   return true;
 }
 
+void Fitter::cached_auto_fit(ROI &region, boost::atomic<bool>& interruptor)
+{
+  std::string key = FitCache::key(region);
+  if (fit_cache_.contains(key)) {
+    region = fit_cache_.get(key);
+    return;
+  }
+
+  region.auto_fit(interruptor);
+  if (!interruptor.load())
+    fit_cache_.store(key, region);
+}
+
 bool Fitter::refit_region(double regionID, boost::atomic<bool>& interruptor)
 {
   if (!contains_region(regionID))
@@ -351,7 +359,7 @@ bool Fitter::merge_regions(double left, double right, boost::atomic<bool>& inter
   ROI newROI(finder_, min, max);
 
   //add old peaks?
-  newROI.auto_fit(interruptor);
+  cached_auto_fit(newROI, interruptor);
   if (!newROI.width())
     return false;
 
@@ -409,7 +417,7 @@ bool Fitter::add_peak(double left, double right, boost::atomic<bool>& interrupto
 //  DBG << "<Fitter> making new ROI to add peak manually " << left << " " << right;
   ROI newROI(finder_, left, right);
 //  newROI.add_peak(finder_.x_, finder_.y_, left, right, interruptor);
-  newROI.auto_fit(interruptor);
+  cached_auto_fit(newROI, interruptor);
   if (!newROI.width())
     return false;
 
@@ -585,9 +593,16 @@ void Fitter::to_xml(pugi::xml_node &root) const
 
   for (auto &r : regions_)
     r.second.to_xml(node, finder_);
+
+  if (fit_cache_.size()) {
+    std::set<double> region_ids;
+    for (auto &r : regions_)
+      region_ids.insert(r.first);
+    fit_cache_.to_xml(node, finder_, region_ids);
+  }
 }
 
-void Fitter::from_xml(const pugi::xml_node &node, SinkPtr spectrum)
+void Fitter::from_xml(const pugi::xml_node &node, std::shared_ptr<const Sink> spectrum)
 {
   if (node.attribute("SelectedPeaks"))
   {
@@ -609,6 +624,9 @@ void Fitter::from_xml(const pugi::xml_node &node, SinkPtr spectrum)
 
   //clear automatically found rois?
 
+  if (node.child(fit_cache_.xml_element_name().c_str()))
+    fit_cache_.from_xml(node.child(fit_cache_.xml_element_name().c_str()), finder_);
+
   for (auto &r : node.children())
   {
     ROI region;
@@ -25,6 +25,7 @@
 
 #include "peak.h"
 #include "roi.h"
+#include "fit_cache.h"
 #include "daq_sink.h"
 #include "finder.h"
 
@@ -35,7 +36,7 @@ class Fitter {
 public:
   Fitter() : activity_scale_factor_(1.0) {}
 
-  Fitter(SinkPtr spectrum) : Fitter()
+  Fitter(std::shared_ptr<const Sink> spectrum) : Fitter()
   { setData(spectrum); }
 
   const FitSettings &settings() { return finder_.settings_; }
@@ -46,7 +47,7 @@ public:
 
 
   void clear();
-  void setData(SinkPtr spectrum);
+  void setData(std::shared_ptr<const Sink> spectrum);
   void find_regions();
 
   //access peaks
@@ -63,6 +64,9 @@ public:
   ROI parent_region(double peakID) const;
   std::set<double> relevant_regions(double left, double right);
 
+  //previously fitted regions, reused when inputs are identical
+  const FitCache &fit_cache() const { return fit_cache_; }
+
   //manupulation, may invoke optimizer
   bool auto_fit(double regionID, boost::atomic<bool>& interruptor);
   bool add_peak(double left, double right, boost::atomic<bool>& interruptor);
@@ -87,7 +91,7 @@ public:
 
   //XMLable
   void to_xml(pugi::xml_node &node) const;
-  void from_xml(const pugi::xml_node &node, SinkPtr spectrum);
+  void from_xml(const pugi::xml_node &node, std::shared_ptr<const Sink> spectrum);
   std::string xml_element_name() const {return "Fitter";}
 
 
@@ -106,8 +110,10 @@ private:
   std::map<double, ROI> regions_;
   std::set<double> selected_peaks_;
   Finder finder_;
+  FitCache fit_cache_;
 
   void render_all();
+  void cached_auto_fit(ROI &region, boost::atomic<bool>& interruptor);
   ROI *parent_of(double peakID);
 
   void filter_selection();
@@ -649,7 +649,7 @@ void ROI::render() {
   hr_x_nrg = finder_.settings_.cali_nrg_.transform(hr_x, finder_.settings_.bits_);
 
   std::vector<double> lowres_backsteps = sum4back.eval_array(finder_.x_);
-  std::vector<double> lowres_fullfit   = sum4back.eval_array(finder_.x_);
+  std::vector<double> lowres_fullfit   = lowres_backsteps;
 
   for (auto &p : peaks_)
     p.second.hr_fullfit_ = p.second.hr_peak_ = hr_fullfit;
@@ -658,28 +658,27 @@ void ROI::render() {
     hr_fullfit    = hr_background;
     hr_back_steps = hr_background;
     lowres_backsteps = background_.eval_array(finder_.x_);
-    lowres_fullfit = background_.eval_array(finder_.x_);
+    lowres_fullfit = lowres_backsteps;
     for (auto &p : peaks_) {
+      p.second.hr_peak_ = p.second.hypermet().peak(hr_x);
+      std::vector<double> steps = p.second.hypermet().step_tail(hr_x);
       for (int32_t j = 0; j < static_cast<int32_t>(hr_x.size()); ++j) {
-        double step = p.second.hypermet().eval_step_tail(hr_x[j]);
-        hr_back_steps[j] += step;
-        hr_fullfit[j]    += step + p.second.hypermet().eval_peak(hr_x[j]);
+        hr_back_steps[j] += steps[j];
+        hr_fullfit[j]    += steps[j] + p.second.hr_peak_[j];
       }
 
+      std::vector<double> lowres_peak = p.second.hypermet().peak(finder_.x_);
+      std::vector<double> lowres_steps = p.second.hypermet().step_tail(finder_.x_);
       for (int32_t j = 0; j < static_cast<int32_t>(finder_.x_.size()); ++j) {
-        double step = p.second.hypermet().eval_step_tail(finder_.x_[j]);
-        lowres_backsteps[j] += step;
-        lowres_fullfit[j]   += step + p.second.hypermet().eval_peak(finder_.x_[j]);
+        lowres_backsteps[j] += lowres_steps[j];
+        lowres_fullfit[j]   += lowres_steps[j] + lowres_peak[j];
       }
     }
 
     for (auto &p : peaks_) {
       p.second.hr_fullfit_ = hr_back_steps;
-      p.second.hr_peak_.resize(hr_back_steps.size());
-      for (int32_t j = 0; j < static_cast<int32_t>(hr_x.size()); ++j) {
-        p.second.hr_peak_[j]     = p.second.hypermet().eval_peak(hr_x[j]);
+      for (int32_t j = 0; j < static_cast<int32_t>(hr_x.size()); ++j)
         p.second.hr_fullfit_[j] += p.second.hr_peak_[j];
-      }
     }
   }
 
@@ -157,23 +157,14 @@ int SUM4::quality() const
 }
 
 
+SUM4Stream SUM4::stream() const
+{
+  return SUM4Stream(LB_.left(), LB_.right(), Lchan_, Rchan_, RB_.left(), RB_.right());
+}
+
 int SUM4::get_currie_quality_indicator(double peak_net_area, double background_variance)
 {
-  double currieLQ(0), currieLD(0), currieLC(0);
-  currieLQ = 50 * (1 + sqrt(1 + background_variance / 12.5));
-  currieLD = 2.71 + 4.65 * sqrt(background_variance);
-  currieLC = 2.33 * sqrt(background_variance);
-
-  if (peak_net_area > currieLQ)
-    return 1;
-  else if (peak_net_area > currieLD)
-    return 2;
-  else if (peak_net_area > currieLC)
-    return 3;
-  else if (peak_net_area > 0)
-    return 4;
-  else
-    return 5;
+  return SUM4Stream::currie_quality(peak_net_area, background_variance);
 }
 
 
@@ -27,6 +27,7 @@
 #include <cstdint>
 #include "polynomial.h"
 #include "UncertainDouble.h"
+#include "sum4_stream.h"
 
 namespace Qpx {
 
@@ -78,6 +79,9 @@ public:
   UncertainDouble centroid()        const {return centroid_;}
   UncertainDouble fwhm()            const {return fwhm_;}
 
+  //same bounds, for live monitoring of a sink
+  SUM4Stream stream() const;
+
   static int get_currie_quality_indicator(double peak_net_area, double background_variance);
 
 private:
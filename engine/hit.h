@@ -26,6 +26,7 @@
 
 #include <vector>
 #include <map>
+#include <algorithm>
 #include <fstream>
 
 #include "digitized_value.h"
@@ -94,9 +95,13 @@ public:
   }
   inline void set_trace(const std::vector<uint16_t> &trc)
   {
-    size_t len = std::min(trc.size(), trace_.size());
-    for (size_t i=0; i < len; ++i)
-      trace_[i] = trc.at(i);
+    set_trace(trc.data(), trc.size());
+  }
+  //straight from a device buffer, no intermediate vector
+  inline void set_trace(const uint16_t *trc, size_t length)
+  {
+    size_t len = std::min(length, trace_.size());
+    std::copy(trc, trc + len, trace_.begin());
   }
 
   //Comparators
@@ -0,0 +1,739 @@
+/*******************************************************************************
+ *
+ * This software was developed at the National Institute of Standards and
+ * Technology (NIST) by employees of the Federal Government in the course
+ * of their official duties. Pursuant to title 17 Section 105 of the
+ * United States Code, this software is not subject to copyright protection
+ * and is in the public domain. NIST assumes no responsibility whatsoever for
+ * its use by other parties, and makes no guarantees, expressed or implied,
+ * about its quality, reliability, or any other characteristic.
+ *
+ * Author(s):
+ *      Martin Shetty (NIST)
+ *
+ * Description:
+ *      Qpx::ListFileWriter, Qpx::ListFileReader - list mode container of
+ *      zlib-compressed, checksummed blocks
+ *
+ ******************************************************************************/
+
+#include "list_file.h"
+#include <sstream>
+#include <cstring>
+#include <algorithm>
+#include <limits>
+#include <zlib.h>
+#include "custom_logger.h"
+
+namespace Qpx {
+
+static const char list_magic[8] = {'Q','P','X','L','S','T','0','1'};
+
+enum ListBlock : uint32_t { hits_block = 1, spill_block = 2, lost_block = 3, index_block = 4 };
+enum ListFlags : uint32_t { deflated = 1 };
+
+struct BlockHeader {
+  uint32_t type;
+  uint32_t flags;
+  uint32_t items;
+  uint32_t raw_size;
+  uint32_t stored_size;
+  uint32_t crc;
+};
+
+typedef std::vector<std::pair<const char*, size_t>> Pieces;
+
+template<typename T>
+static void put(Pieces &out, const T &val) {
+  out.push_back(std::make_pair(reinterpret_cast<const char*>(&val), sizeof(T)));
+}
+
+template<typename T>
+static void put(Pieces &out, const std::vector<T> &vals) {
+  if (!vals.empty())
+    out.push_back(std::make_pair(reinterpret_cast<const char*>(vals.data()), sizeof(T) * vals.size()));
+}
+
+template<typename T>
+static bool get(const std::string &in, size_t &pos, T &val) {
+  if (pos + sizeof(T) > in.size())
+    return false;
+  memcpy(&val, in.data() + pos, sizeof(T));
+  pos += sizeof(T);
+  return true;
+}
+
+template<typename T>
+static bool get(const std::string &in, size_t &pos, std::vector<T> &vals, size_t count) {
+  if (pos + sizeof(T) * count > in.size())
+    return false;
+  vals.resize(count);
+  if (count)
+    memcpy(vals.data(), in.data() + pos, sizeof(T) * count);
+  pos += sizeof(T) * count;
+  return true;
+}
+
+
+size_t ListFileWriter::Chunk::bytes() const {
+  return channels.size() * (sizeof(int16_t) + sizeof(uint64_t) + sizeof(uint8_t) + sizeof(uint16_t))
+      + (values.size() + traces.size()) * sizeof(uint16_t);
+}
+
+void ListFileWriter::Chunk::clear() {
+  channels.clear();
+  times.clear();
+  value_counts.clear();
+  trace_lengths.clear();
+  values.clear();
+  traces.clear();
+  min_ns = std::numeric_limits<double>::infinity();
+  max_ns = -std::numeric_limits<double>::infinity();
+}
+
+
+ListFileWriter::ListFileWriter(size_t chunk_hits, int compression_level, size_t buffers)
+  : chunk_hits_(std::max(chunk_hits, size_t(1)))
+  , chunk_bytes_(1 << 20)
+  , compression_level_(compression_level)
+  , total_hits_(0), spill_first_hit_(0)
+  , bytes_(0)
+  , buffers_((buffers > 1) ? buffers : 0)
+  , stopping_(false)
+  , failed_(false)
+  , backlog_(0)
+  , dropped_chunks_(0), dropped_hits_(0)
+{}
+
+std::unique_ptr<ListFileWriter::Chunk> ListFileWriter::new_chunk() const {
+  std::unique_ptr<Chunk> chunk(new Chunk);
+  chunk->clear();
+  chunk->channels.reserve(chunk_hits_);
+  chunk->times.reserve(chunk_hits_);
+  chunk->value_counts.reserve(chunk_hits_);
+  chunk->trace_lengths.reserve(chunk_hits_);
+  chunk->traces.reserve(chunk_bytes_ / sizeof(uint16_t));
+  return chunk;
+}
+
+bool ListFileWriter::open(std::string file_name) {
+  close();
+  total_hits_ = spill_first_hit_ = 0;
+  failed_ = false;
+  backlog_ = 0;
+  dropped_chunks_ = dropped_hits_ = 0;
+  file_.open(file_name, std::ofstream::out | std::ofstream::trunc | std::ofstream::binary);
+  if (!file_.is_open() || !file_.good()) {
+    ERR << "<ListFile> Could not open " << file_name << " for writing";
+    file_.close();
+    return false;
+  }
+  file_.write(list_magic, sizeof(list_magic));
+  bytes_ = sizeof(list_magic);
+
+  if (!current_)
+    current_ = new_chunk();
+
+  if (buffers_) {
+    stopping_ = false;
+    io_thread_ = boost::thread(&ListFileWriter::worker_write, this);
+  }
+  return file_.good();
+}
+
+void ListFileWriter::close() {
+  if (!file_.is_open())
+    return;
+  seal_chunk(true);
+
+  if (io_thread_.joinable()) {
+    {
+      boost::unique_lock<boost::mutex> lock(io_mutex_);
+      stopping_ = true;
+    }
+    io_cond_.notify_all();
+    io_thread_.join();
+  }
+
+  if (dropped_hits_)
+    WARN << "<ListFile> Storage fell behind, " << dropped_hits_ << " hits in "
+         << dropped_chunks_ << " chunks were not written";
+  file_.close();
+}
+
+void ListFileWriter::add_hit(const Hit &hit) {
+  if (!file_.is_open() || failed_)
+    return;
+
+  Chunk &c = *current_;
+  c.channels.push_back(hit.source_channel());
+  c.times.push_back(hit.timestamp().native());
+  double ns = hit.timestamp().to_nanosec();
+  c.min_ns = std::min(c.min_ns, ns);
+  c.max_ns = std::max(c.max_ns, ns);
+
+  size_t count = std::min(hit.value_count(), size_t(255));
+  c.value_counts.push_back(count);
+  for (size_t i=0; i < count; ++i) {
+    DigitizedVal v = hit.value(i);
+    c.values.push_back(v.val(v.bits()));
+  }
+
+  const std::vector<uint16_t> &trace = hit.trace();
+  size_t length = std::min(trace.size(), size_t(65535));
+  c.trace_lengths.push_back(length);
+  c.traces.insert(c.traces.end(), trace.begin(), trace.begin() + length);
+
+  total_hits_++;
+  if ((c.channels.size() >= chunk_hits_) || (c.bytes() >= chunk_bytes_))
+    seal_chunk();
+}
+
+bool ListFileWriter::add_spill(const Spill &spill) {
+  if (!file_.is_open())
+    return false;
+
+  //close chunk so spill follows its hits in the file
+  if (!seal_chunk())
+    return false;
+
+  pugi::xml_document doc;
+  spill.to_xml(doc, true);
+  std::stringstream ss;
+  doc.save(ss, "", pugi::format_raw | pugi::format_no_declaration);
+  std::string xml = ss.str();
+
+  uint64_t first = spill_first_hit_;
+  uint64_t count = total_hits_ - spill_first_hit_;
+  spill_first_hit_ = total_hits_;
+
+  if (buffers_) {
+    Block block;
+    block.type = spill_block;
+    block.items = 1;
+    block.payload.reserve(sizeof(first) + sizeof(count) + xml.size());
+    block.payload.append(reinterpret_cast<const char*>(&first), sizeof(first));
+    block.payload.append(reinterpret_cast<const char*>(&count), sizeof(count));
+    block.payload.append(xml);
+    enqueue(std::move(block));
+    return !failed_;
+  }
+
+  Pieces pieces;
+  put(pieces, first);
+  put(pieces, count);
+  pieces.push_back(std::make_pair(xml.data(), xml.size()));
+  return write_block(spill_block, 1, pieces);
+}
+
+bool ListFileWriter::seal_chunk(bool wait) {
+  if (failed_)
+    current_->clear();
+  if (current_->channels.empty())
+    return !failed_;
+
+  if (!buffers_) {
+    bool ret = write_chunk(*current_);
+    current_->clear();
+    return ret;
+  }
+
+  uint32_t count = current_->channels.size();
+  Block block;
+  block.items = count;
+  {
+    boost::unique_lock<boost::mutex> lock(io_mutex_);
+    if (wait)
+      while ((backlog_ + 1 >= buffers_) && !failed_)
+        io_cond_.wait(lock);
+
+    if (backlog_ + 1 < buffers_) {
+      block.type = hits_block;
+      block.chunk = std::move(current_);
+      if (!spare_.empty()) {
+        current_ = std::move(spare_.front());
+        spare_.pop_front();
+      }
+      backlog_++;
+    } else {
+      block.type = lost_block;
+      dropped_chunks_++;
+      dropped_hits_ += count;
+    }
+  }
+
+  Block index;
+  index.type = index_block;
+  index.items = 1;
+  if (block.type == lost_block) {
+    if (dropped_chunks_ == 1)
+      WARN << "<ListFile> Storage cannot keep up, dropping hits";
+    //what was lost stays findable by time and channel
+    index.payload = index_payload(*current_);
+    current_->clear();
+  } else if (!current_)
+    current_ = new_chunk();
+
+  enqueue(std::move(block));
+  if (!index.payload.empty())
+    enqueue(std::move(index));
+  return !failed_;
+}
+
+void ListFileWriter::enqueue(Block &&block) {
+  {
+    boost::unique_lock<boost::mutex> lock(io_mutex_);
+    queue_.push_back(std::move(block));
+  }
+  io_cond_.notify_all();
+}
+
+void ListFileWriter::worker_write() {
+  boost::unique_lock<boost::mutex> lock(io_mutex_);
+  while (true) {
+    while (queue_.empty() && !stopping_)
+      io_cond_.wait(lock);
+    if (queue_.empty())
+      break;
+
+    Block block = std::move(queue_.front());
+    queue_.pop_front();
+    lock.unlock();
+
+    if (!failed_ && block.chunk)
+      write_chunk(*block.chunk);
+    else if (!failed_) {
+      Pieces pieces;
+      if (!block.payload.empty())
+        pieces.push_back(std::make_pair(block.payload.data(), block.payload.size()));
+      write_block(block.type, block.items, pieces);
+    }
+
+    lock.lock();
+    if (block.chunk) {
+      block.chunk->clear();
+      spare_.push_back(std::move(block.chunk));
+      backlog_--;
+    }
+    io_cond_.notify_all();
+  }
+}
+
+bool ListFileWriter::write_chunk(Chunk &chunk) {
+  uint32_t count = chunk.channels.size();
+  uint32_t value_total = chunk.values.size();
+  uint32_t trace_total = chunk.traces.size();
+
+  //successive differences, small for time-ordered hits and kind to deflate
+  uint64_t previous = 0;
+  for (auto &t : chunk.times) {
+    uint64_t current = t;
+    t = current - previous;
+    previous = current;
+  }
+
+  Pieces pieces;
+  put(pieces, count);
+  put(pieces, value_total);
+  put(pieces, trace_total);
+  put(pieces, chunk.channels);
+  put(pieces, chunk.times);
+  put(pieces, chunk.value_counts);
+  put(pieces, chunk.trace_lengths);
+  put(pieces, chunk.values);
+  put(pieces, chunk.traces);
+
+  return write_block(hits_block, count, pieces) && write_index(chunk);
+}
+
+bool ListFileWriter::write_index(const Chunk &chunk) {
+  std::string payload = index_payload(chunk);
+  Pieces pieces;
+  pieces.push_back(std::make_pair(payload.data(), payload.size()));
+  return write_block(index_block, 1, pieces);
+}
+
+std::string ListFileWriter::index_payload(const Chunk &chunk) {
+  std::map<int16_t, uint32_t> counts;
+  for (auto &c : chunk.channels)
+    counts[c]++;
+
+  std::string payload;
+  payload.append(reinterpret_cast<const char*>(&chunk.min_ns), sizeof(double));
+  payload.append(reinterpret_cast<const char*>(&chunk.max_ns), sizeof(double));
+  uint32_t size = counts.size();
+  payload.append(reinterpret_cast<const char*>(&size), sizeof(size));
+  for (auto &c : counts) {
+    payload.append(reinterpret_cast<const char*>(&c.first), sizeof(int16_t));
+    payload.append(reinterpret_cast<const char*>(&c.second), sizeof(uint32_t));
+  }
+  return payload;
+}
+
+bool ListFileWriter::write_block(uint32_t type, uint32_t items, const Pieces &pieces) {
+  BlockHeader header;
+  header.type = type;
+  header.flags = 0;
+  header.items = items;
+  header.raw_size = 0;
+  for (auto &p : pieces)
+    header.raw_size += p.second;
+
+  bool packed = false;
+  if (compression_level_ != 0) {
+    z_stream z;
+    memset(&z, 0, sizeof(z));
+    if (deflateInit(&z, compression_level_) == Z_OK) {
+      packed_.resize(deflateBound(&z, header.raw_size));
+      z.next_out = reinterpret_cast<Bytef*>(&packed_[0]);
+      z.avail_out = packed_.size();
+      int ret = Z_OK;
+      for (size_t i=0; (i < pieces.size()) && (ret == Z_OK); ++i) {
+        z.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(pieces[i].first));
+        z.avail_in = pieces[i].second;
+        ret = deflate(&z, (i + 1 == pieces.size()) ? Z_FINISH : Z_NO_FLUSH);
+      }
+      packed = (ret == Z_STREAM_END) && (z.total_out < header.raw_size);
+      packed_.resize(z.total_out);
+      deflateEnd(&z);
+    }
+  }
+
+  if (packed) {
+    header.flags |= deflated;
+    header.stored_size = packed_.size();
+    header.crc = crc32(0L, reinterpret_cast<const Bytef*>(packed_.data()), packed_.size());
+  } else {
+    header.stored_size = header.raw_size;
+    header.crc = crc32(0L, Z_NULL, 0);
+    for (auto &p : pieces)
+      header.crc = crc32(header.crc, reinterpret_cast<const Bytef*>(p.first), p.second);
+  }
+
+  file_.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  if (packed)
+    file_.write(packed_.data(), packed_.size());
+  else
+    for (auto &p : pieces)
+      file_.write(p.first, p.second);
+  bytes_ += sizeof(header) + header.stored_size;
+
+  if (!file_.good()) {
+    ERR << "<ListFile> Write failed after " << bytes_.load() << " bytes";
+    failed_ = true;
+    return false;
+  }
+  return true;
+}
+
+
+bool ListFileReader::is_list_file(std::string file_name) {
+  std::ifstream file(file_name, std::ifstream::in | std::ifstream::binary);
+  char magic[8];
+  file.read(magic, sizeof(magic));
+  return file.good() && !memcmp(magic, list_magic, sizeof(magic));
+}
+
+bool ListFileReader::open(std::string file_name) {
+  close();
+  file_.open(file_name, std::ifstream::in | std::ifstream::binary);
+  if (!file_.is_open())
+    return false;
+
+  char magic[8];
+  file_.read(magic, sizeof(magic));
+  if (!file_.good() || memcmp(magic, list_magic, sizeof(magic))) {
+    WARN << "<ListFile> " << file_name << " is not a qpx list mode file";
+    file_.close();
+    return false;
+  }
+
+  file_.seekg(0, std::ios::end);
+  uint64_t file_size = file_.tellg();
+
+  uint64_t pos = sizeof(list_magic);
+  uint64_t next_hit = 0;
+  std::string raw;
+  while (pos + sizeof(BlockHeader) <= file_size) {
+    BlockHeader header;
+    file_.clear();
+    file_.seekg(pos);
+    file_.read(reinterpret_cast<char*>(&header), sizeof(header));
+    uint64_t end = pos + sizeof(header) + header.stored_size;
+    if (!file_.good() || (end > file_size))
+      break;
+
+    if ((header.type == hits_block) || (header.type == lost_block)) {
+      ChunkEntry entry;
+      entry.offset = pos;
+      entry.first_hit = next_hit;
+      entry.hit_count = header.items;
+      entry.lost = (header.type == lost_block);
+      entry.indexed = false;
+      chunks_.push_back(entry);
+      next_hit += header.items;
+    } else if ((header.type == index_block) && !chunks_.empty() && !chunks_.back().indexed) {
+      ChunkEntry &entry = chunks_.back();
+      uint32_t type, items, size;
+      size_t at = 0;
+      if (read_block(pos, type, items, raw) &&
+          get(raw, at, entry.min_ns) && get(raw, at, entry.max_ns) && get(raw, at, size)) {
+        entry.channels.resize(size);
+        bool good = true;
+        for (auto &c : entry.channels)
+          good = good && get(raw, at, c.first) && get(raw, at, c.second);
+        entry.indexed = good;
+      }
+    } else if (header.type == spill_block) {
+      uint32_t type, items;
+      size_t at = 0;
+      SpillEntry entry;
+      if (!read_block(pos, type, items, raw) ||
+          !get(raw, at, entry.first_hit) || !get(raw, at, entry.hit_count))
+        break;
+      pugi::xml_document doc;
+      if (doc.load_buffer(raw.data() + at, raw.size() - at))
+        entry.spill.from_xml(doc.first_child());
+      for (auto &s : entry.spill.stats)
+        models_[s.second.source_channel] = s.second.model_hit;
+      spills_.push_back(entry);
+    }
+    pos = end;
+  }
+
+  if (pos < file_size)
+    WARN << "<ListFile> " << file_name << " ends in an incomplete block, run did not close";
+
+  index_reach();
+
+  DBG << "<ListFile> " << file_name << " holds " << spills_.size() << " spills, "
+      << next_hit << " hits in " << chunks_.size() << " chunks";
+  return true;
+}
+
+void ListFileReader::index_reach() {
+  const double inf = std::numeric_limits<double>::infinity();
+  size_t n = chunks_.size();
+  reach_max_ns_.assign(n, -inf);
+  reach_min_ns_.assign(n, inf);
+  for (size_t i = 0; i < n; ++i) {
+    double max_ns = chunks_[i].indexed ? chunks_[i].max_ns : inf;
+    reach_max_ns_[i] = i ? std::max(reach_max_ns_[i - 1], max_ns) : max_ns;
+  }
+  for (size_t i = n; i > 0; --i) {
+    double min_ns = chunks_[i - 1].indexed ? chunks_[i - 1].min_ns : -inf;
+    reach_min_ns_[i - 1] = (i < n) ? std::min(reach_min_ns_[i], min_ns) : min_ns;
+  }
+}
+
+void ListFileReader::close() {
+  spills_.clear();
+  chunks_.clear();
+  reach_max_ns_.clear();
+  reach_min_ns_.clear();
+  models_.clear();
+  cached_chunk_ = -1;
+  if (file_.is_open())
+    file_.close();
+}
+
+uint64_t ListFileReader::total_hits() const {
+  if (chunks_.empty())
+    return 0;
+  return chunks_.back().first_hit + chunks_.back().hit_count;
+}
+
+bool ListFileReader::read_block(uint64_t offset, uint32_t &type, uint32_t &items, std::string &raw) {
+  BlockHeader header;
+  file_.clear();
+  file_.seekg(offset);
+  file_.read(reinterpret_cast<char*>(&header), sizeof(header));
+
+  std::string stored(header.stored_size, '\0');
+  if (header.stored_size)
+    file_.read(&stored[0], header.stored_size);
+  if (!file_.good())
+    return false;
+
+  if (header.crc != crc32(0L, reinterpret_cast<const Bytef*>(stored.data()), stored.size())) {
+    ERR << "<ListFile> Checksum mismatch in block at " << offset;
+    return false;
+  }
+
+  type = header.type;
+  items = header.items;
+  if (header.flags & deflated) {
+    raw.resize(header.raw_size);
+    uLongf raw_size = header.raw_size;
+    if ((uncompress(reinterpret_cast<Bytef*>(&raw[0]), &raw_size,
+                    reinterpret_cast<const Bytef*>(stored.data()), stored.size()) != Z_OK)
+        || (raw_size != header.raw_size)) {
+      ERR << "<ListFile> Could not inflate block at " << offset;
+      return false;
+    }
+  } else
+    raw.swap(stored);
+  return true;
+}
+
+bool ListFileReader::decode_chunk(size_t chunk) {
+  if (cached_chunk_ == static_cast<int64_t>(chunk))
+    return true;
+  cached_chunk_ = -1;
+
+  uint32_t type, items;
+  std::string raw;
+  if (!read_block(chunks_[chunk].offset, type, items, raw) || (type != hits_block))
+    return false;
+
+  size_t at = 0;
+  uint32_t count, value_total, trace_total;
+  if (!get(raw, at, count) || !get(raw, at, value_total) || !get(raw, at, trace_total) ||
+      !get(raw, at, channels_, count) || !get(raw, at, times_, count) ||
+      !get(raw, at, value_counts_, count) || !get(raw, at, trace_lengths_, count) ||
+      !get(raw, at, values_, value_total) || !get(raw, at, traces_, trace_total))
+    return false;
+
+  uint64_t time = 0;
+  for (auto &t : times_) {
+    time += t;
+    t = time;
+  }
+
+  value_offsets_.resize(count);
+  trace_offsets_.resize(count);
+  uint64_t vo = 0, to = 0;
+  for (size_t i=0; i < count; ++i) {
+    value_offsets_[i] = vo;
+    trace_offsets_[i] = to;
+    vo += value_counts_[i];
+    to += trace_lengths_[i];
+  }
+  if ((vo != value_total) || (to != trace_total))
+    return false;
+
+  cached_chunk_ = chunk;
+  return true;
+}
+
+bool ListFileReader::read_hits(size_t index, const std::map<int16_t, HitModel> &models, std::list<Hit> &hits) {
+  if (index >= spills_.size())
+    return false;
+
+  uint64_t first = spills_[index].first_hit;
+  uint64_t last = first + spills_[index].hit_count;
+  uint64_t done = first;
+
+  auto it = std::upper_bound(chunks_.begin(), chunks_.end(), first,
+                             [](uint64_t hit, const ChunkEntry &c) { return hit < c.first_hit; });
+  size_t chunk = (it == chunks_.begin()) ? 0 : (it - chunks_.begin() - 1);
+
+  std::map<int16_t, HitModel> inferred;
+  bool lost = false;
+  for (; (chunk < chunks_.size()) && (done < last); ++chunk) {
+    const ChunkEntry &c = chunks_[chunk];
+    if (c.first_hit + c.hit_count <= done)
+      continue;
+    if (c.lost) {
+      lost = true;
+      done = std::min(last, c.first_hit + c.hit_count);
+      continue;
+    }
+    if (!decode_chunk(chunk)) {
+      ERR << "<ListFile> Could not decode hits " << c.first_hit << "-" << c.first_hit + c.hit_count;
+      return false;
+    }
+
+    size_t end = std::min(last - c.first_hit, uint64_t(c.hit_count));
+    for (size_t i = done - c.first_hit; i < end; ++i)
+      emit_hit(i, models, inferred, hits);
+    done = c.first_hit + end;
+  }
+
+  return (done == last) && !lost;
+}
+
+Hit& ListFileReader::emit_hit(size_t i, const std::map<int16_t, HitModel> &models,
+                              std::map<int16_t, HitModel> &inferred, std::list<Hit> &hits) {
+  int16_t chan = channels_[i];
+  auto m = models.find(chan);
+  if (m == models.end()) {
+    HitModel &model = inferred[chan];
+    model.values.resize(value_counts_[i], DigitizedVal(0, 16));
+    model.tracelength = trace_lengths_[i];
+    m = inferred.find(chan);
+  }
+
+  hits.emplace_back(chan, m->second);
+  Hit &hit = hits.back();
+  hit.set_timestamp_native(times_[i]);
+  for (size_t v=0; v < value_counts_[i]; ++v)
+    hit.set_value(v, values_[value_offsets_[i] + v]);
+  if (trace_lengths_[i])
+    hit.set_trace(traces_.data() + trace_offsets_[i], trace_lengths_[i]);
+  return hit;
+}
+
+bool ListFileReader::ChunkEntry::overlaps(double from_ns, double to_ns,
+                                          const std::set<int16_t> &chans) const {
+  if (!indexed)
+    return true;
+  if ((max_ns < from_ns) || (min_ns >= to_ns))
+    return false;
+  if (chans.empty())
+    return true;
+  for (auto &c : channels)
+    if (chans.count(c.first))
+      return true;
+  return false;
+}
+
+bool ListFileReader::time_range(double &from_ns, double &to_ns) const {
+  bool found = false;
+  for (auto &c : chunks_) {
+    if (!c.indexed)
+      continue;
+    from_ns = found ? std::min(from_ns, c.min_ns) : c.min_ns;
+    to_ns = found ? std::max(to_ns, c.max_ns) : c.max_ns;
+    found = true;
+  }
+  return found;
+}
+
+bool ListFileReader::read_slice(double from_ns, double to_ns, const std::set<int16_t> &channels,
+                                const std::map<int16_t, HitModel> &models, std::list<Hit> &hits) {
+  std::map<int16_t, HitModel> inferred;
+  bool complete = true;
+
+  //before first: all chunks end ahead of slice; from last on: all start after it
+  size_t first = std::lower_bound(reach_max_ns_.begin(), reach_max_ns_.end(), from_ns)
+      - reach_max_ns_.begin();
+  size_t last = std::lower_bound(reach_min_ns_.begin(), reach_min_ns_.end(), to_ns)
+      - reach_min_ns_.begin();
+
+  for (size_t chunk = first; chunk < last; ++chunk) {
+    const ChunkEntry &c = chunks_[chunk];
+    if (!c.overlaps(from_ns, to_ns, channels))
+      continue;
+    if (c.lost) {
+      complete = false;
+      continue;
+    }
+    if (!decode_chunk(chunk)) {
+      ERR << "<ListFile> Could not decode hits " << c.first_hit << "-" << c.first_hit + c.hit_count;
+      complete = false;
+      continue;
+    }
+
+    for (size_t i = 0; i < c.hit_count; ++i) {
+      if (!channels.empty() && !channels.count(channels_[i]))
+        continue;
+      double ns = emit_hit(i, models, inferred, hits).timestamp().to_nanosec();
+      if ((ns < from_ns) || (ns >= to_ns))
+        hits.pop_back();
+    }
+  }
+  return complete;
+}
+
+}
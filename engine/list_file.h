@@ -0,0 +1,206 @@
+/*******************************************************************************
+ *
+ * This software was developed at the National Institute of Standards and
+ * Technology (NIST) by employees of the Federal Government in the course
+ * of their official duties. Pursuant to title 17 Section 105 of the
+ * United States Code, this software is not subject to copyright protection
+ * and is in the public domain. NIST assumes no responsibility whatsoever for
+ * its use by other parties, and makes no guarantees, expressed or implied,
+ * about its quality, reliability, or any other characteristic.
+ *
+ * Author(s):
+ *      Martin Shetty (NIST)
+ *
+ * Description:
+ *      Qpx::ListFileWriter, Qpx::ListFileReader - list mode container of
+ *      zlib-compressed, checksummed blocks
+ *
+ *      File layout:
+ *        "QPXLST01", then blocks appended as acquisition goes:
+ *        header {uint32 type, flags, items, raw bytes, stored bytes, crc32}
+ *        hits block:  up to chunk_hits hits or about 1 MiB in columns
+ *                     (channel, time delta, value count, trace length,
+ *                     values, traces)
+ *        spill block: uint64 first hit, uint64 hit count, spill xml
+ *        lost block:  no payload, items counts hits dropped by the writer
+ *        index block: follows each hits or lost block, double min and max
+ *                     time in ns, uint32 channel count, then per channel
+ *                     int16 channel and uint32 hits
+ *      Block headers are the index; a reader scans them and stops at the
+ *      first incomplete block, so a crashed run loses only unsealed hits.
+ *      Index blocks let a time slice or a few channels be read by decoding
+ *      only the chunks that hold them.
+ *
+ ******************************************************************************/
+
+#ifndef QPX_LIST_FILE_H
+#define QPX_LIST_FILE_H
+
+#include <fstream>
+#include <memory>
+#include <set>
+#include <boost/thread.hpp>
+#include <boost/atomic.hpp>
+#include "spill.h"
+
+namespace Qpx {
+
+class ListFileWriter {
+public:
+  //buffers > 1 hands sealed chunks to an I/O thread, at most buffers - 1 in
+  //flight while another fills; a chunk finding none free is dropped and only
+  //a lost block marks its place, so acquisition never waits on storage
+  ListFileWriter(size_t chunk_hits = 65536, int compression_level = 1, size_t buffers = 0);
+  ~ListFileWriter() { close(); }
+
+  bool open(std::string file_name);
+  bool is_open() const { return file_.is_open(); }
+  void close();
+
+  void add_hit(const Hit &hit);
+  //hits added since previous spill belong to this one, spill's own hits are not written
+  bool add_spill(const Spill &spill);
+
+  uint64_t hits() const { return total_hits_; }
+  uint64_t bytes() const { return bytes_; }
+
+  //sealed chunks not yet on disk, and hits lost because storage fell behind
+  size_t   backlog() const { return backlog_; }
+  uint64_t dropped_chunks() const { return dropped_chunks_; }
+  uint64_t dropped_hits() const { return dropped_hits_; }
+
+private:
+  struct Chunk {
+    std::vector<int16_t>  channels;
+    std::vector<uint64_t> times;
+    std::vector<uint8_t>  value_counts;
+    std::vector<uint16_t> trace_lengths;
+    std::vector<uint16_t> values;
+    std::vector<uint16_t> traces;
+    double min_ns, max_ns;
+
+    size_t bytes() const;
+    void clear();
+  };
+
+  struct Block {
+    uint32_t type;
+    uint32_t items;
+    std::unique_ptr<Chunk> chunk; //hits block
+    std::string payload;          //any other block
+  };
+
+  std::ofstream file_;
+  size_t   chunk_hits_, chunk_bytes_;
+  int      compression_level_;
+  uint64_t total_hits_, spill_first_hit_;
+  boost::atomic<uint64_t> bytes_;
+
+  std::unique_ptr<Chunk> current_;
+  std::string packed_;
+
+  //I/O thread
+  size_t buffers_;
+  boost::thread io_thread_;
+  boost::mutex io_mutex_;
+  boost::condition_variable io_cond_;
+  std::list<Block> queue_;
+  std::list<std::unique_ptr<Chunk>> spare_;
+  bool stopping_;
+  boost::atomic<bool> failed_;
+  boost::atomic<size_t> backlog_;
+  boost::atomic<uint64_t> dropped_chunks_, dropped_hits_;
+
+  std::unique_ptr<Chunk> new_chunk() const;
+  bool seal_chunk(bool wait = false);
+  void enqueue(Block &&block);
+  void worker_write();
+  bool write_chunk(Chunk &chunk);
+  bool write_index(const Chunk &chunk);
+  static std::string index_payload(const Chunk &chunk);
+  bool write_block(uint32_t type, uint32_t items,
+                   const std::vector<std::pair<const char*, size_t>> &pieces);
+};
+
+class ListFileReader {
+public:
+  ListFileReader() : cached_chunk_(-1) {}
+
+  static bool is_list_file(std::string file_name);
+
+  bool open(std::string file_name);
+  bool is_open() const { return file_.is_open(); }
+  void close();
+
+  size_t size() const { return spills_.size(); }
+  size_t chunk_count() const { return chunks_.size(); }
+  uint64_t total_hits() const;
+
+  //spill metadata without hits
+  const Spill& spill(size_t index) const { return spills_.at(index).spill; }
+  uint64_t hit_count(size_t index) const { return spills_.at(index).hit_count; }
+
+  //models as announced in stats of preceding spills; channels without one
+  //get a model inferred from the stored value count and trace length
+  bool read_hits(size_t index, const std::map<int16_t, HitModel> &models, std::list<Hit> &hits);
+
+  //last model announced for each channel in spill stats
+  const std::map<int16_t, HitModel>& models() const { return models_; }
+
+  //span of indexed chunks in ns, false if file has no index
+  bool time_range(double &from_ns, double &to_ns) const;
+
+  //hits from_ns <= t < to_ns of given channels (all if empty), in file order;
+  //chunks outside slice by their index are not read, unindexed ones always are
+  bool read_slice(double from_ns, double to_ns, const std::set<int16_t> &channels,
+                  const std::map<int16_t, HitModel> &models, std::list<Hit> &hits);
+
+private:
+  struct SpillEntry {
+    Spill    spill;
+    uint64_t first_hit;
+    uint64_t hit_count;
+  };
+
+  struct ChunkEntry {
+    uint64_t offset;
+    uint64_t first_hit;
+    uint32_t hit_count;
+    bool     lost;
+    bool     indexed;
+    double   min_ns, max_ns;
+    std::vector<std::pair<int16_t, uint32_t>> channels;
+
+    bool overlaps(double from_ns, double to_ns, const std::set<int16_t> &chans) const;
+  };
+
+  std::ifstream file_;
+  std::vector<SpillEntry> spills_;
+  std::vector<ChunkEntry> chunks_;
+  std::map<int16_t, HitModel> models_;
+
+  //running max of max_ns from the front and min of min_ns from the back,
+  //both nondecreasing, so read_slice finds its chunk span by binary search;
+  //unindexed chunks count as spanning all time
+  std::vector<double> reach_max_ns_, reach_min_ns_;
+  void index_reach();
+
+  //last decoded chunk, consecutive spills mostly share one
+  int64_t cached_chunk_;
+  std::vector<int16_t>  channels_;
+  std::vector<uint64_t> times_;
+  std::vector<uint8_t>  value_counts_;
+  std::vector<uint16_t> trace_lengths_;
+  std::vector<uint64_t> value_offsets_, trace_offsets_;
+  std::vector<uint16_t> values_;
+  std::vector<uint16_t> traces_;
+
+  bool read_block(uint64_t offset, uint32_t &type, uint32_t &items, std::string &raw);
+  bool decode_chunk(size_t chunk);
+  Hit& emit_hit(size_t i, const std::map<int16_t, HitModel> &models,
+                std::map<int16_t, HitModel> &inferred, std::list<Hit> &hits);
+};
+
+}
+
+#endif
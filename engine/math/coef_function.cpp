@@ -25,16 +25,14 @@
 #include <sstream>
 #include <iomanip>
 #include <numeric>
+#include <algorithm>
+#include <cmath>
 #include <boost/algorithm/string.hpp>
 #include <boost/lexical_cast.hpp>
 #include "fityk.h"
 #include "custom_logger.h"
 #include "qpx_util.h"
 
-#ifdef FITTER_CERES_ENABLED
-#include "glog/logging.h"
-#endif
-
 CoefFunction::CoefFunction() :
   xoffset_("xoffset", 0),
   rsq_(0)
@@ -62,13 +60,35 @@ void CoefFunction::add_coeff(int degree, double lbound, double ubound, double in
                              initial, lbound, ubound);
 }
 
+void CoefFunction::eval_span(const double *x, double *y, size_t n) {
+  for (size_t i=0; i < n; ++i)
+    y[i] = this->eval(x[i]);
+}
+
 std::vector<double> CoefFunction::eval_array(const std::vector<double> &x) {
-  std::vector<double> y;
-  for (auto &q : x)
-    y.push_back(this->eval(q));
+  std::vector<double> y(x.size());
+  if (!x.empty())
+    this->eval_span(x.data(), y.data(), x.size());
   return y;
 }
 
+void CoefFunction::horner_span(const std::vector<double> &coeffs,
+                               const double *x, double *y, size_t n)
+{
+  if (coeffs.empty()) {
+    std::fill(y, y + n, 0.0);
+    return;
+  }
+
+  //loop over points innermost so that the compiler can vectorize each pass
+  std::fill(y, y + n, coeffs.back());
+  for (int k = static_cast<int>(coeffs.size()) - 2; k >= 0; --k) {
+    const double c = coeffs[k];
+    for (size_t i=0; i < n; ++i)
+      y[i] = y[i] * x[i] + c;
+  }
+}
+
 double CoefFunction::eval_inverse(double y, double e) {
   int i=0;
   double x0 = xoffset_.value.value();
@@ -92,6 +112,77 @@ double CoefFunction::eval_inverse(double y, double e) {
   }
 }
 
+std::vector<double> CoefFunction::eval_inverse_array(const std::vector<double> &y,
+                                                   double xmin, double xmax,
+                                                   double e)
+{
+  std::vector<double> ret(y.size(), nan(""));
+  if (y.empty() || !(xmax > xmin) || !(e > 0))
+    return ret;
+
+  //tabulate on a unit grid (capped) and bracket each target by binary search,
+  //function is assumed to be monotone over [xmin, xmax]
+  size_t nodes = std::min(static_cast<size_t>(std::ceil(xmax - xmin)) + 1,
+                          static_cast<size_t>(65537));
+  nodes = std::max(nodes, static_cast<size_t>(2));
+  double step = (xmax - xmin) / (nodes - 1);
+
+  std::vector<double> gx(nodes), gy(nodes);
+  for (size_t i=0; i < nodes; ++i)
+    gx[i] = xmin + i * step;
+  gx.back() = xmax;
+  this->eval_span(gx.data(), gy.data(), nodes);
+
+  bool ascending = (gy.back() >= gy.front());
+  double lo_y = ascending ? gy.front() : gy.back();
+  double hi_y = ascending ? gy.back() : gy.front();
+
+  for (size_t j=0; j < y.size(); ++j) {
+    double target = y[j];
+    if (!(target >= lo_y) || !(target <= hi_y))
+      continue;
+
+    size_t a = 0, b = nodes - 1;
+    while (b - a > 1) {
+      size_t m = (a + b) / 2;
+      if ((gy[m] < target) == ascending)
+        a = m;
+      else
+        b = m;
+    }
+
+    //Illinois-modified regula falsi within the bracket
+    double x0 = gx[a], x1 = gx[b];
+    double f0 = gy[a] - target, f1 = gy[b] - target;
+    int side = 0;
+    for (int i=0; (i <= 100) && (std::abs(x1 - x0) > e); ++i) {
+      if (f0 == f1)
+        break;
+      double xm = (x0 * f1 - x1 * f0) / (f1 - f0);
+      double fm = this->eval(xm) - target;
+      if (fm == 0) {
+        x0 = x1 = xm;
+        break;
+      }
+      if ((fm < 0) == (f0 < 0)) {
+        x0 = xm; f0 = fm;
+        if (side == -1)
+          f1 /= 2;
+        side = -1;
+      } else {
+        x1 = xm; f1 = fm;
+        if (side == 1)
+          f0 /= 2;
+        side = 1;
+      }
+    }
+
+    ret[j] = (std::abs(f0) < std::abs(f1)) ? x0 : x1;
+  }
+
+  return ret;
+}
+
 std::vector<double> CoefFunction::coeffs() {
   std::vector<double> ret;
   int top = 0;
@@ -198,44 +289,3 @@ void CoefFunction::fit_fityk(const std::vector<double> &x,
 
   DBG << "Solved (Fityk) as " << this->to_string();
 }
-
-#ifdef FITTER_CERES_ENABLED
-void CoefFunction::fit_ceres(const std::vector<double> &x,
-                             const std::vector<double> &y,
-                             const std::vector<double> &y_sigma)
-{
-  if ((x.size() != y.size()) || (y.size() != y_sigma.size()))
-    return;
-
-  size_t max = 0;
-  for (auto &c : coeffs_)
-    if (c.first > max)
-      max = c.first;
-  std::vector<double> coefs_ceres(max + 1, 0.0);
-  for (auto &c : coeffs_)
-    coefs_ceres[c.first] = c.second.value.value();
-
-//  google::InitGoogleLogging("qpx_coef_function");
-
-  ceres::Problem problem;
-  this->add_residual_blocks(problem, x, y, coefs_ceres);
-
-  ceres::Solver::Options options;
-  options.max_num_iterations = 100;
-  options.linear_solver_type = ceres::DENSE_QR;
-  options.minimizer_progress_to_stdout = true;
-
-
-  ceres::Solver::Summary summary;
-  ceres::Solve(options, &problem, &summary);
-  DBG << summary.BriefReport() << "\n";
-  coeffs_.clear();
-  for (size_t i=0; i < coefs_ceres.size(); ++i)
-  {
-    DBG << i << " " << coefs_ceres[i];
-    coeffs_.at(i).value.setValue(coefs_ceres[i]);
-  }
-
-  DBG << "Solved (Ceres) as " << this->to_string();
-}
-#endif
@@ -27,10 +27,6 @@
 #include <map>
 #include "fit_param.h"
 
-#ifdef FITTER_CERES_ENABLED
-#include "ceres/ceres.h"
-#endif
-
 class CoefFunction {
 public:
   CoefFunction();
@@ -50,8 +46,18 @@ public:
 
   std::vector<double> coeffs();
 
+  //batch evaluation over contiguous arrays, override for vectorized kernels
+  virtual void eval_span(const double *x, double *y, size_t n);
+
   std::vector<double> eval_array(const std::vector<double> &x);
   double eval_inverse(double y, double e = 0.2);
+  std::vector<double> eval_inverse_array(const std::vector<double> &y,
+                                         double xmin, double xmax,
+                                         double e = 0.2);
+
+  //Horner's scheme for dense coefficients, x and y must not overlap
+  static void horner_span(const std::vector<double> &coeffs,
+                          const double *x, double *y, size_t n);
 
   std::map<int, FitParam> coeffs_;
   FitParam xoffset_;
@@ -65,18 +71,6 @@ public:
                  const std::vector<double> &y,
                  const std::vector<double> &y_sigma);
 
-#ifdef FITTER_CERES_ENABLED
-// Ceres implementation
-  void fit_ceres(const std::vector<double> &x,
-                 const std::vector<double> &y,
-                 const std::vector<double> &y_sigma);
-
-  virtual void add_residual_blocks(ceres::Problem &problem,
-                                   const std::vector<double> &x,
-                                   const std::vector<double> &y,
-                                   std::vector<double> &c) {}
-#endif
-
 };
 
 #endif
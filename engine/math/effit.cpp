@@ -172,10 +172,20 @@ double Effit::inverse_evaluate(double y, double e) {
 */
 
 
-std::vector<double> Effit::evaluate_array(std::vector<double> x) {
-  std::vector<double> y;
-  for (auto &q : x)
-    y.push_back(evaluate(q));
+void Effit::evaluate_span(const double *x, double *y, size_t n) const {
+  //log(x/1000) = log(x/100) - log(10), so only one log per point
+  const double ln10 = log(10.0);
+  for (size_t i=0; i < n; ++i) {
+    double xa = log((x[i] - xoffset_)/100);
+    double xb = xa - ln10;
+    y[i] = exp(pow(pow(A + (B + C*xa)*xa, -G) + pow(D + (E + F*xb)*xb, -G), -1.0/G));
+  }
+}
+
+std::vector<double> Effit::evaluate_array(const std::vector<double> &x) const {
+  std::vector<double> y(x.size());
+  if (!x.empty())
+    evaluate_span(x.data(), y.data(), x.size());
   return y;
 }
 
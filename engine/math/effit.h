@@ -49,7 +49,8 @@ public:
 
   double evaluate(double x);
 //  double inverse_evaluate(double y, double e = 0.2);
-  std::vector<double> evaluate_array(std::vector<double> x);
+  void evaluate_span(const double *x, double *y, size_t n) const;
+  std::vector<double> evaluate_array(const std::vector<double> &x) const;
   
   double xoffset_;
   double rsq;
@@ -93,9 +93,6 @@ private:
                  std::string funcname);
 
 
-// Ceres implementation
-
-
 };
 
 #endif
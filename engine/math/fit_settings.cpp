@@ -66,6 +66,7 @@ FitSettings::FitSettings()
   , Rskew_slope ("rskew_s", 0.5, 0.3, 2)
 
   , fitter_max_iter (3000)
+  , optimizer (OptimizerType::fityk)
 {
   step_amplitude.enabled = true;
   tail_amplitude.enabled = true;
@@ -125,6 +126,8 @@ void FitSettings::to_xml(pugi::xml_node &root) const {
   Lskew_slope.to_xml(hyp_node);
   Rskew_amplitude.to_xml(hyp_node);
   Rskew_slope.to_xml(hyp_node);
+
+  node.append_child("Optimizer").append_attribute("type").set_value(optimizer_to_string(optimizer).c_str());
 }
 
 void FitSettings::from_xml(const pugi::xml_node &node) {
@@ -190,6 +193,9 @@ void FitSettings::from_xml(const pugi::xml_node &node) {
     }
   }
 
+  if (node.child("Optimizer"))
+    optimizer = optimizer_from_string(std::string(node.child("Optimizer").attribute("type").value()));
+
 }
 
 void FitSettings::clear()
@@ -26,6 +26,7 @@
 #include "fit_param.h"
 #include "calibration.h"
 #include "xmlable.h"
+#include "optimizer.h"
 
 class FitSettings : public XMLable {
 public:
@@ -69,6 +70,7 @@ public:
   FitParam Rskew_amplitude;
   FitParam Rskew_slope;
   uint16_t fitter_max_iter;
+  OptimizerType optimizer;
 
   //specific to spectrum
   Qpx::Calibration cali_nrg_, cali_fwhm_;
@@ -28,6 +28,7 @@
 #include <boost/lexical_cast.hpp>
 
 #include "fityk_util.h"
+#include "optimizer.h"
 #include "custom_logger.h"
 #include "qpx_util.h"
 
@@ -307,6 +308,68 @@ std::vector<Hypermet> Hypermet::fit_multi(const std::vector<double> &x,
                                           std::vector<Hypermet> old,
                                           PolyBounded &background,
                                           FitSettings settings)
+{
+  return Optimizer::make(settings.optimizer)->fit_multi(x, y, old, background, settings);
+}
+
+bool Hypermet::constrain_multi(std::vector<Hypermet> &old,
+                               const FitSettings &settings,
+                               FitParam &w_common)
+{
+  bool use_w_common = (settings.width_common && settings.cali_fwhm_.valid() && settings.cali_nrg_.valid());
+
+  if (use_w_common) {
+    w_common = settings.width_common_bounds;
+    UncertainDouble centers_avg;
+    for (auto &p : old)
+      centers_avg += p.center_.value;
+    centers_avg /= old.size();
+
+    double nrg = settings.cali_nrg_.transform(centers_avg.value());
+    double fwhm_expected = settings.cali_fwhm_.transform(nrg);
+    double L = settings.cali_nrg_.inverse_transform(nrg - fwhm_expected/2);
+    double R = settings.cali_nrg_.inverse_transform(nrg + fwhm_expected/2);
+    w_common.value.setValue((R - L) / (2* sqrt(log(2))));
+
+    w_common.lbound = w_common.value.value() * w_common.lbound;
+    w_common.ubound = w_common.value.value() * w_common.ubound;
+  }
+
+  for (auto &o : old) {
+    if (!use_w_common) {
+      double width_expected = o.width_.value.value();
+
+      if (settings.cali_fwhm_.valid() && settings.cali_nrg_.valid()) {
+        double fwhm_expected = settings.cali_fwhm_.transform(settings.cali_nrg_.transform(o.center_.value.value()));
+        double L = settings.cali_nrg_.inverse_transform(settings.cali_nrg_.transform(o.center_.value.value()) - fwhm_expected/2);
+        double R = settings.cali_nrg_.inverse_transform(settings.cali_nrg_.transform(o.center_.value.value()) + fwhm_expected/2);
+        width_expected = (R - L) / (2* sqrt(log(2)));
+      }
+
+      o.width_.lbound = width_expected * settings.width_common_bounds.lbound;
+      o.width_.ubound = width_expected * settings.width_common_bounds.ubound;
+
+      if ((o.width_.value.value() > o.width_.lbound) && (o.width_.value.value() < o.width_.ubound))
+        width_expected = o.width_.value.value();
+      o.width_.value.setValue(width_expected);
+    }
+
+    o.height_.lbound = o.height_.value.value() * 1e-5;
+    o.height_.ubound = o.height_.value.value() * 1e5;
+
+    double lateral_slack = settings.lateral_slack * o.width_.value.value() * 2 * sqrt(log(2));
+    o.center_.lbound = o.center_.value.value() - lateral_slack;
+    o.center_.ubound = o.center_.value.value() + lateral_slack;
+  }
+
+  return use_w_common;
+}
+
+std::vector<Hypermet> Hypermet::fit_multi_fityk(const std::vector<double> &x,
+                                                const std::vector<double> &y,
+                                                std::vector<Hypermet> old,
+                                                PolyBounded &background,
+                                                FitSettings settings)
 {
   if (old.empty())
     return old;
@@ -339,25 +402,10 @@ std::vector<Hypermet> Hypermet::fit_multi(const std::vector<double> &x,
     DBG << "Hypermet multifit failed to define";
   }
 
-
-  bool use_w_common = (settings.width_common && settings.cali_fwhm_.valid() && settings.cali_nrg_.valid());
+  FitParam w_common;
+  bool use_w_common = constrain_multi(old, settings, w_common);
 
   if (use_w_common) {
-    FitParam w_common = settings.width_common_bounds;
-    UncertainDouble centers_avg;
-    for (auto &p : old)
-      centers_avg += p.center_.value;
-    centers_avg /= old.size();
-
-    double nrg = settings.cali_nrg_.transform(centers_avg.value());
-    double fwhm_expected = settings.cali_fwhm_.transform(nrg);
-    double L = settings.cali_nrg_.inverse_transform(nrg - fwhm_expected/2);
-    double R = settings.cali_nrg_.inverse_transform(nrg + fwhm_expected/2);
-    w_common.value.setValue((R - L) / (2* sqrt(log(2))));
-
-    w_common.lbound = w_common.value.value() * w_common.lbound;
-    w_common.ubound = w_common.value.value() * w_common.ubound;
-
     try {
       f->execute(w_common.def_var());
     } catch ( ... ) {
@@ -378,32 +426,6 @@ std::vector<Hypermet> Hypermet::fit_multi(const std::vector<double> &x,
 
   int i=0;
   for (auto &o : old) {
-
-    if (!use_w_common) {
-      double width_expected = o.width_.value.value();
-
-      if (settings.cali_fwhm_.valid() && settings.cali_nrg_.valid()) {
-        double fwhm_expected = settings.cali_fwhm_.transform(settings.cali_nrg_.transform(o.center_.value.value()));
-        double L = settings.cali_nrg_.inverse_transform(settings.cali_nrg_.transform(o.center_.value.value()) - fwhm_expected/2);
-        double R = settings.cali_nrg_.inverse_transform(settings.cali_nrg_.transform(o.center_.value.value()) + fwhm_expected/2);
-        width_expected = (R - L) / (2* sqrt(log(2)));
-      }
-
-      o.width_.lbound = width_expected * settings.width_common_bounds.lbound;
-      o.width_.ubound = width_expected * settings.width_common_bounds.ubound;
-
-      if ((o.width_.value.value() > o.width_.lbound) && (o.width_.value.value() < o.width_.ubound))
-        width_expected = o.width_.value.value();
-      o.width_.value.setValue(width_expected);
-    }
-
-    o.height_.lbound = o.height_.value.value() * 1e-5;
-    o.height_.ubound = o.height_.value.value() * 1e5;
-
-    double lateral_slack = settings.lateral_slack * o.width_.value.value() * 2 * sqrt(log(2));
-    o.center_.lbound = o.center_.value.value() - lateral_slack;
-    o.center_.ubound = o.center_.value.value() + lateral_slack;
-
     std::string initial = "F += Hypermet(" +
         o.center_.fityk_name(i) + "," +
         o.height_.fityk_name(i) + "," +
@@ -540,17 +562,77 @@ double Hypermet::eval_step_tail(double x) const {
   return height_.value.value() * 0.5 * (step + tail);
 }
 
-std::vector<double> Hypermet::peak(std::vector<double> x) const {
-  std::vector<double> y;
-  for (auto &q : x)
-    y.push_back(eval_peak(q));
+std::vector<double> Hypermet::peak(const std::vector<double> &x) const {
+  std::vector<double> y(x.size(), 0.0);
+  const double w = width_.value.value();
+  if (w == 0)
+    return y;
+
+  //parameters are hoisted out of the loop, per-point work is only exp/erfc
+  const double c = center_.value.value();
+  const double h = height_.value.value();
+  const bool left = Lskew_amplitude_.enabled && (Lskew_slope_.value.value() != 0);
+  const double lamp = Lskew_amplitude_.value.value();
+  const double lslope = Lskew_slope_.value.value();
+  const double lterm = pow(0.5*w/lslope, 2);
+  const bool right = Rskew_amplitude_.enabled && (Rskew_slope_.value.value() != 0);
+  const double ramp = Rskew_amplitude_.value.value();
+  const double rslope = Rskew_slope_.value.value();
+  const double rterm = pow(0.5*w/rslope, 2);
+
+  for (size_t i=0; i < x.size(); ++i) {
+    double xc = x[i] - c;
+    double xw = xc / w;
+    double ret = exp(-xw*xw);
+
+    if (left) {
+      double lexp = exp(lterm + xc/lslope);
+      if (!std::isinf(lexp))
+        ret += 0.5 * lamp * lexp * erfc(0.5*w/lslope + xw);
+    }
+
+    if (right) {
+      double rexp = exp(rterm - xc/rslope);
+      if (!std::isinf(rexp))
+        ret += 0.5 * ramp * rexp * erfc(0.5*w/rslope - xw);
+    }
+
+    y[i] = h * ret;
+  }
   return y;
 }
 
-std::vector<double> Hypermet::step_tail(std::vector<double> x) const {
-  std::vector<double> y;
-  for (auto &q : x)
-    y.push_back(eval_step_tail(q));
+std::vector<double> Hypermet::step_tail(const std::vector<double> &x) const {
+  std::vector<double> y(x.size(), 0.0);
+  const double w = width_.value.value();
+  if (w == 0)
+    return y;
+
+  const double c = center_.value.value();
+  const double h = height_.value.value();
+  const bool step = step_amplitude_.enabled;
+  const double samp = step_amplitude_.value.value();
+  const bool tail = tail_amplitude_.enabled && (tail_slope_.value.value() != 0);
+  const double tamp = tail_amplitude_.value.value();
+  const double tslope = tail_slope_.value.value();
+  const double tterm = pow(0.5*w/tslope, 2);
+
+  for (size_t i=0; i < x.size(); ++i) {
+    double xc = x[i] - c;
+    double xw = xc / w;
+    double ret = 0;
+
+    if (step)
+      ret += samp * erfc(xw);
+
+    if (tail) {
+      double lexp = exp(tterm + xc/tslope);
+      if (!std::isinf(lexp))
+        ret += tamp * lexp * erfc(0.5*w/tslope + xw);
+    }
+
+    y[i] = h * 0.5 * ret;
+  }
   return y;
 }
 
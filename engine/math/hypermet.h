@@ -53,6 +53,18 @@ public:
                                          FitSettings settings
                                          );
 
+  static std::vector<Hypermet> fit_multi_fityk(const std::vector<double> &x,
+                                               const std::vector<double> &y,
+                                               std::vector<Hypermet> old,
+                                               PolyBounded &background,
+                                               FitSettings settings
+                                               );
+
+  //initial values and bounds for multiplet fit, shared by optimizers
+  static bool constrain_multi(std::vector<Hypermet> &old,
+                              const FitSettings &settings,
+                              FitParam &w_common);
+
   const FitParam& center() const {return center_;}
   const FitParam& height() const {return height_;}
   const FitParam& width() const {return width_;}
@@ -81,8 +93,8 @@ public:
   std::string to_string() const;
   double eval_peak(double) const;
   double eval_step_tail(double) const;
-  std::vector<double> peak(std::vector<double> x) const;
-  std::vector<double> step_tail(std::vector<double> x) const;
+  std::vector<double> peak(const std::vector<double> &x) const;
+  std::vector<double> step_tail(const std::vector<double> &x) const;
   UncertainDouble area() const;
   bool gaussian_only() const;
   Gaussian gaussian() const;
@@ -105,6 +117,8 @@ private:
 
   double rsq_;
   bool user_modified_;
+
+  friend class OptimizerLM;
 };
 
 #endif
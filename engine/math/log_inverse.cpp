@@ -148,6 +148,18 @@ double LogInverse::eval(double x) {
   return exp(result);
 }
 
+void LogInverse::eval_span(const double *x, double *y, size_t n) {
+  double offset = xoffset_.value.value();
+  std::vector<double> x_adjusted(n);
+  for (size_t i=0; i < n; ++i) {
+    double xx = x[i] - offset;
+    x_adjusted[i] = (xx != 0) ? 1.0/xx : std::numeric_limits<double>::max();
+  }
+  horner_span(coeffs(), x_adjusted.data(), y, n);
+  for (size_t i=0; i < n; ++i)
+    y[i] = exp(y[i]);
+}
+
 double LogInverse::derivative(double x) {
   return x;
 }
@@ -0,0 +1,54 @@
+/*******************************************************************************
+ *
+ * This software was developed at the National Institute of Standards and
+ * Technology (NIST) by employees of the Federal Government in the course
+ * of their official duties. Pursuant to title 17 Section 105 of the
+ * United States Code, this software is not subject to copyright protection
+ * and is in the public domain. NIST assumes no responsibility whatsoever for
+ * its use by other parties, and makes no guarantees, expressed or implied,
+ * about its quality, reliability, or any other characteristic.
+ *
+ * This software can be redistributed and/or modified freely provided that
+ * any derivative works bear some notice that they are derived from it, and
+ * any modified versions bear some notice that they have been modified.
+ *
+ * Author(s):
+ *      Martin Shetty (NIST)
+ *
+ * Description:
+ *      Optimizer - interface for pluggable fitting backends
+ *
+ ******************************************************************************/
+
+#include "optimizer.h"
+#include "optimizer_fityk.h"
+#include "optimizer_lm.h"
+
+std::string optimizer_to_string(OptimizerType type)
+{
+  if (type == OptimizerType::lm)
+    return "lm";
+  else
+    return "fityk";
+}
+
+OptimizerType optimizer_from_string(std::string str)
+{
+  if (str == "lm")
+    return OptimizerType::lm;
+  else
+    return OptimizerType::fityk;
+}
+
+std::vector<OptimizerType> optimizer_types()
+{
+  return {OptimizerType::fityk, OptimizerType::lm};
+}
+
+OptimizerPtr Optimizer::make(OptimizerType type)
+{
+  if (type == OptimizerType::lm)
+    return OptimizerPtr(new OptimizerLM());
+  else
+    return OptimizerPtr(new OptimizerFityk());
+}
@@ -0,0 +1,63 @@
+/*******************************************************************************
+ *
+ * This software was developed at the National Institute of Standards and
+ * Technology (NIST) by employees of the Federal Government in the course
+ * of their official duties. Pursuant to title 17 Section 105 of the
+ * United States Code, this software is not subject to copyright protection
+ * and is in the public domain. NIST assumes no responsibility whatsoever for
+ * its use by other parties, and makes no guarantees, expressed or implied,
+ * about its quality, reliability, or any other characteristic.
+ *
+ * This software can be redistributed and/or modified freely provided that
+ * any derivative works bear some notice that they are derived from it, and
+ * any modified versions bear some notice that they have been modified.
+ *
+ * Author(s):
+ *      Martin Shetty (NIST)
+ *
+ * Description:
+ *      Optimizer - interface for pluggable fitting backends
+ *
+ ******************************************************************************/
+
+#ifndef QPX_OPTIMIZER_H
+#define QPX_OPTIMIZER_H
+
+#include <vector>
+#include <string>
+#include <memory>
+
+class CoefFunction;
+class PolyBounded;
+class Hypermet;
+class FitSettings;
+
+enum class OptimizerType : int {fityk = 0, lm = 1};
+
+std::string optimizer_to_string(OptimizerType type);
+OptimizerType optimizer_from_string(std::string str);
+std::vector<OptimizerType> optimizer_types();
+
+class Optimizer {
+public:
+  virtual ~Optimizer() {}
+
+  virtual OptimizerType type() const = 0;
+
+  virtual void fit(CoefFunction &func,
+                   const std::vector<double> &x,
+                   const std::vector<double> &y,
+                   const std::vector<double> &y_sigma) = 0;
+
+  virtual std::vector<Hypermet> fit_multi(const std::vector<double> &x,
+                                          const std::vector<double> &y,
+                                          std::vector<Hypermet> old,
+                                          PolyBounded &background,
+                                          FitSettings settings) = 0;
+
+  static std::shared_ptr<Optimizer> make(OptimizerType type);
+};
+
+typedef std::shared_ptr<Optimizer> OptimizerPtr;
+
+#endif
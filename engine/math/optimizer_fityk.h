@@ -0,0 +1,44 @@
+/*******************************************************************************
+ *
+ * This software was developed at the National Institute of Standards and
+ * Technology (NIST) by employees of the Federal Government in the course
+ * of their official duties. Pursuant to title 17 Section 105 of the
+ * United States Code, this software is not subject to copyright protection
+ * and is in the public domain. NIST assumes no responsibility whatsoever for
+ * its use by other parties, and makes no guarantees, expressed or implied,
+ * about its quality, reliability, or any other characteristic.
+ *
+ * This software can be redistributed and/or modified freely provided that
+ * any derivative works bear some notice that they are derived from it, and
+ * any modified versions bear some notice that they have been modified.
+ *
+ * Author(s):
+ *      Martin Shetty (NIST)
+ *
+ * Description:
+ *      OptimizerFityk - fitting backend delegating to libfityk
+ *
+ ******************************************************************************/
+
+#ifndef QPX_OPTIMIZER_FITYK_H
+#define QPX_OPTIMIZER_FITYK_H
+
+#include "optimizer.h"
+
+class OptimizerFityk : public Optimizer {
+public:
+  OptimizerType type() const override {return OptimizerType::fityk;}
+
+  void fit(CoefFunction &func,
+           const std::vector<double> &x,
+           const std::vector<double> &y,
+           const std::vector<double> &y_sigma) override;
+
+  std::vector<Hypermet> fit_multi(const std::vector<double> &x,
+                                  const std::vector<double> &y,
+                                  std::vector<Hypermet> old,
+                                  PolyBounded &background,
+                                  FitSettings settings) override;
+};
+
+#endif
@@ -0,0 +1,302 @@
+/*******************************************************************************
+ *
+ * This software was developed at the National Institute of Standards and
+ * Technology (NIST) by employees of the Federal Government in the course
+ * of their official duties. Pursuant to title 17 Section 105 of the
+ * United States Code, this software is not subject to copyright protection
+ * and is in the public domain. NIST assumes no responsibility whatsoever for
+ * its use by other parties, and makes no guarantees, expressed or implied,
+ * about its quality, reliability, or any other characteristic.
+ *
+ * This software can be redistributed and/or modified freely provided that
+ * any derivative works bear some notice that they are derived from it, and
+ * any modified versions bear some notice that they have been modified.
+ *
+ * Author(s):
+ *      Martin Shetty (NIST)
+ *
+ * Description:
+ *      OptimizerLM - compiled Levenberg-Marquardt backend with box bounds
+ *
+ ******************************************************************************/
+
+#include "optimizer_lm.h"
+
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include <Eigen/Dense>
+#include "coef_function.h"
+#include "hypermet.h"
+#include "custom_logger.h"
+
+OptimizerLM::Solution OptimizerLM::solve(ModelFunction model,
+                                         const std::vector<double> &y,
+                                         const std::vector<double> &y_sigma,
+                                         std::vector<double> params,
+                                         const std::vector<double> &lower,
+                                         const std::vector<double> &upper) const
+{
+  Solution ret;
+
+  size_t n = y.size();
+  size_t m = params.size();
+  if (!n || !m || (y_sigma.size() != n) ||
+      (lower.size() != m) || (upper.size() != m))
+    return ret;
+
+  auto clamp = [&](std::vector<double> &p) {
+    for (size_t j=0; j < m; ++j)
+      p[j] = std::max(lower[j], std::min(upper[j], p[j]));
+  };
+
+  Eigen::VectorXd w(n), yy(n);
+  for (size_t i=0; i < n; ++i) {
+    yy(i) = y[i];
+    double s = y_sigma[i];
+    w(i) = (std::isfinite(s) && (s > 0)) ? 1.0 / (s * s) : 1.0;
+  }
+
+  auto to_eigen = [&](const std::vector<double> &v) {
+    return Eigen::Map<const Eigen::VectorXd>(v.data(), v.size());
+  };
+
+  auto chi_squared = [&](const std::vector<double> &f) {
+    return (w.array() * (yy - to_eigen(f)).array().square()).sum();
+  };
+
+  clamp(params);
+  std::vector<double> f(n), ftrial(n);
+  model(params, f);
+  double chi2 = chi_squared(f);
+  if (!std::isfinite(chi2))
+    return ret;
+
+  Eigen::MatrixXd J(n, m);
+  Eigen::MatrixXd A(m, m);
+  Eigen::VectorXd g(m);
+
+  //forward-difference Jacobian, stepping inward at upper bounds
+  auto jacobian = [&](const std::vector<double> &p, const std::vector<double> &fp) {
+    std::vector<double> pj = p;
+    for (size_t j=0; j < m; ++j) {
+      double h = 1.0e-7 * std::max(std::abs(p[j]), 1.0e-3);
+      if (p[j] + h > upper[j])
+        h = -h;
+      pj[j] = p[j] + h;
+      model(pj, ftrial);
+      J.col(j) = (to_eigen(ftrial) - to_eigen(fp)) / h;
+      pj[j] = p[j];
+    }
+    A = J.transpose() * w.asDiagonal() * J;
+  };
+
+  double lambda = 1.0e-3;
+  int small_changes = 0;
+  std::vector<double> ptrial(m);
+
+  for (ret.iterations = 0; ret.iterations < max_iterations_; ++ret.iterations) {
+    jacobian(params, f);
+    g = J.transpose() * (w.array() * (yy - to_eigen(f)).array()).matrix();
+
+    //parameters pinned at a bound and pushed outward are held for this step
+    std::vector<bool> pinned(m, false);
+    for (size_t j=0; j < m; ++j)
+      pinned[j] = ((params[j] <= lower[j]) && (g(j) < 0)) ||
+                  ((params[j] >= upper[j]) && (g(j) > 0));
+
+    bool improved = false;
+    double rel_change = 0;
+    while (lambda < 1.0e12) {
+      Eigen::MatrixXd M = A;
+      Eigen::VectorXd b = g;
+      for (size_t j=0; j < m; ++j) {
+        if (pinned[j]) {
+          M.row(j).setZero();
+          M.col(j).setZero();
+          M(j,j) = 1;
+          b(j) = 0;
+        } else
+          M(j,j) += lambda * std::max(A(j,j), 1.0e-12);
+      }
+      Eigen::VectorXd delta = M.ldlt().solve(b);
+
+      for (size_t j=0; j < m; ++j)
+        ptrial[j] = params[j] + delta(j);
+      clamp(ptrial);
+
+      model(ptrial, ftrial);
+      double chi2_trial = chi_squared(ftrial);
+      if (std::isfinite(chi2_trial) && (chi2_trial < chi2)) {
+        rel_change = (chi2 - chi2_trial) / chi2;
+        params = ptrial;
+        f = ftrial;
+        chi2 = chi2_trial;
+        lambda = std::max(lambda * 0.1, 1.0e-12);
+        improved = true;
+        break;
+      }
+      lambda *= 10;
+    }
+
+    //stop on negligible change of chi-squared twice in a row, as fityk does
+    if (improved && (rel_change < 1.0e-7))
+      small_changes++;
+    else
+      small_changes = 0;
+
+    if (!improved || (small_changes >= 2) || (chi2 == 0)) {
+      ret.converged = true;
+      break;
+    }
+  }
+
+  //uncertainties from covariance at solution, scaled by reduced chi-squared
+  jacobian(params, f);
+  Eigen::MatrixXd cov = A.completeOrthogonalDecomposition().pseudoInverse();
+  double red_chi2 = (n > m) ? chi2 / (n - m) : 1.0;
+
+  ret.params = params;
+  ret.errors.resize(m);
+  for (size_t j=0; j < m; ++j)
+    ret.errors[j] = sqrt(std::abs(cov(j,j)) * red_chi2);
+  ret.chi2 = chi2;
+
+  double ymean = yy.mean();
+  double ss_tot = (yy.array() - ymean).square().sum();
+  double ss_res = (yy - to_eigen(f)).squaredNorm();
+  ret.rsq = (ss_tot > 0) ? 1.0 - ss_res / ss_tot : 0;
+
+  return ret;
+}
+
+void OptimizerLM::fit(CoefFunction &func,
+                      const std::vector<double> &x,
+                      const std::vector<double> &y,
+                      const std::vector<double> &y_sigma)
+{
+  if (x.empty() || (x.size() != y.size()) || (y.size() != y_sigma.size()))
+    return;
+
+  std::vector<double> params, lower, upper;
+  for (auto &c : func.coeffs_) {
+    params.push_back(c.second.value.value());
+    lower.push_back(c.second.lbound);
+    upper.push_back(c.second.ubound);
+  }
+
+  ModelFunction model = [&](const std::vector<double> &p, std::vector<double> &out) {
+    size_t j = 0;
+    for (auto &c : func.coeffs_)
+      c.second.value.setValue(p[j++]);
+    out.resize(x.size());
+    func.eval_span(x.data(), out.data(), x.size());
+  };
+
+  Solution sol = solve(model, y, y_sigma, params, lower, upper);
+  if (sol.params.size() != params.size()) {
+    DBG << "<" << func.type() << "> LM fit failed";
+    return;
+  }
+
+  size_t j = 0;
+  for (auto &c : func.coeffs_) {
+    c.second.value = UncertainDouble::from_double(sol.params[j], sol.errors[j]);
+    j++;
+  }
+  func.rsq_ = sol.rsq;
+
+  DBG << "Solved (LM) as " << func.to_string();
+}
+
+std::vector<Hypermet> OptimizerLM::fit_multi(const std::vector<double> &x,
+                                             const std::vector<double> &y,
+                                             std::vector<Hypermet> old,
+                                             PolyBounded &background,
+                                             FitSettings settings)
+{
+  if (old.empty() || x.empty() || (x.size() != y.size()))
+    return old;
+
+  FitParam w_common;
+  bool use_w_common = Hypermet::constrain_multi(old, settings, w_common);
+
+  //collect free parameters; disabled components do not contribute to model
+  std::vector<FitParam*> free;
+  std::vector<double> params, lower, upper;
+  auto add = [&](FitParam &p, const FitParam &bounds) {
+    free.push_back(&p);
+    params.push_back(p.value.value());
+    lower.push_back(bounds.lbound);
+    upper.push_back(bounds.ubound);
+  };
+
+  for (auto &c : background.coeffs_)
+    add(c.second, c.second);
+  if (use_w_common)
+    add(w_common, w_common);
+  for (auto &o : old) {
+    add(o.center_, o.center_);
+    add(o.height_, o.height_);
+    if (!use_w_common)
+      add(o.width_, o.width_);
+    if (o.Lskew_amplitude_.enabled) {
+      add(o.Lskew_amplitude_, o.Lskew_amplitude_.enforce_policy());
+      add(o.Lskew_slope_, o.Lskew_slope_);
+    }
+    if (o.Rskew_amplitude_.enabled) {
+      add(o.Rskew_amplitude_, o.Rskew_amplitude_.enforce_policy());
+      add(o.Rskew_slope_, o.Rskew_slope_);
+    }
+    if (o.tail_amplitude_.enabled) {
+      add(o.tail_amplitude_, o.tail_amplitude_.enforce_policy());
+      add(o.tail_slope_, o.tail_slope_);
+    }
+    if (o.step_amplitude_.enabled)
+      add(o.step_amplitude_, o.step_amplitude_.enforce_policy());
+  }
+
+  auto apply = [&](const std::vector<double> &p) {
+    for (size_t j=0; j < free.size(); ++j)
+      free[j]->value.setValue(p[j]);
+    if (use_w_common)
+      for (auto &o : old)
+        o.width_.value = w_common.value;
+  };
+
+  ModelFunction model = [&](const std::vector<double> &p, std::vector<double> &out) {
+    apply(p);
+    out = background.eval_array(x);
+    for (auto &o : old) {
+      std::vector<double> pk = o.peak(x);
+      std::vector<double> st = o.step_tail(x);
+      for (size_t i=0; i < out.size(); ++i)
+        out[i] += pk[i] + st[i];
+    }
+  };
+
+  std::vector<double> sigma(y.size());
+  for (size_t i=0; i < y.size(); ++i)
+    sigma[i] = sqrt(y[i]);
+
+  OptimizerLM solver;
+  solver.max_iterations_ = settings.fitter_max_iter;
+  Solution sol = solver.solve(model, y, sigma, params, lower, upper);
+  if (sol.params.size() != params.size()) {
+    DBG << "Hypermet multifit (LM) failed";
+    old.clear();
+    return old;
+  }
+
+  DBG << "Hypermet multifit (LM) chi2=" << sol.chi2 << " after " << sol.iterations << " iterations";
+
+  for (size_t j=0; j < free.size(); ++j)
+    free[j]->value = UncertainDouble::from_double(sol.params[j], sol.errors[j]);
+  for (auto &o : old) {
+    if (use_w_common)
+      o.width_.value = w_common.value;
+    o.rsq_ = sol.rsq;
+  }
+
+  return old;
+}
@@ -0,0 +1,71 @@
+/*******************************************************************************
+ *
+ * This software was developed at the National Institute of Standards and
+ * Technology (NIST) by employees of the Federal Government in the course
+ * of their official duties. Pursuant to title 17 Section 105 of the
+ * United States Code, this software is not subject to copyright protection
+ * and is in the public domain. NIST assumes no responsibility whatsoever for
+ * its use by other parties, and makes no guarantees, expressed or implied,
+ * about its quality, reliability, or any other characteristic.
+ *
+ * This software can be redistributed and/or modified freely provided that
+ * any derivative works bear some notice that they are derived from it, and
+ * any modified versions bear some notice that they have been modified.
+ *
+ * Author(s):
+ *      Martin Shetty (NIST)
+ *
+ * Description:
+ *      OptimizerLM - compiled Levenberg-Marquardt backend with box bounds
+ *
+ ******************************************************************************/
+
+#ifndef QPX_OPTIMIZER_LM_H
+#define QPX_OPTIMIZER_LM_H
+
+#include "optimizer.h"
+#include <functional>
+
+class OptimizerLM : public Optimizer {
+public:
+  OptimizerLM() : max_iterations_(200) {}
+
+  OptimizerType type() const override {return OptimizerType::lm;}
+
+  void fit(CoefFunction &func,
+           const std::vector<double> &x,
+           const std::vector<double> &y,
+           const std::vector<double> &y_sigma) override;
+
+  std::vector<Hypermet> fit_multi(const std::vector<double> &x,
+                                  const std::vector<double> &y,
+                                  std::vector<Hypermet> old,
+                                  PolyBounded &background,
+                                  FitSettings settings) override;
+
+  //evaluates model at all data points for given parameters
+  typedef std::function<void(const std::vector<double> &params,
+                             std::vector<double> &model)> ModelFunction;
+
+  struct Solution {
+    Solution() : chi2(0), rsq(0), iterations(0), converged(false) {}
+
+    std::vector<double> params;
+    std::vector<double> errors;
+    double chi2;
+    double rsq;
+    int iterations;
+    bool converged;
+  };
+
+  Solution solve(ModelFunction model,
+                 const std::vector<double> &y,
+                 const std::vector<double> &y_sigma,
+                 std::vector<double> params,
+                 const std::vector<double> &lower,
+                 const std::vector<double> &upper) const;
+
+  int max_iterations_;
+};
+
+#endif
@@ -143,6 +143,16 @@ double PolyLog::eval(double x) {
   return exp(result);
 }
 
+void PolyLog::eval_span(const double *x, double *y, size_t n) {
+  double offset = xoffset_.value.value();
+  std::vector<double> x_adjusted(n);
+  for (size_t i=0; i < n; ++i)
+    x_adjusted[i] = log(x[i] - offset);
+  horner_span(coeffs(), x_adjusted.data(), y, n);
+  for (size_t i=0; i < n; ++i)
+    y[i] = exp(y[i]);
+}
+
 double PolyLog::derivative(double x) {
   return x;
 }
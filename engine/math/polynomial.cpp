@@ -117,6 +117,14 @@ double PolyBounded::eval(double x) {
   return result;
 }
 
+void PolyBounded::eval_span(const double *x, double *y, size_t n) {
+  double offset = xoffset_.value.value();
+  std::vector<double> x_adjusted(n);
+  for (size_t i=0; i < n; ++i)
+    x_adjusted[i] = x[i] - offset;
+  horner_span(coeffs(), x_adjusted.data(), y, n);
+}
+
 
 double PolyBounded::derivative(double x) {
   PolyBounded new_poly;  // derivative not true if offset != 0
@@ -193,60 +201,3 @@ std::string PolyBounded::fityk_definition() {
 
   return declaration + definition;
 }
-
-#ifdef FITTER_CERES_ENABLED
-
-//Ceres
-
-
-struct PolyResidual {
-  PolyResidual(double x, double y, std::vector<double> p)
-      : x_(x), y_(y), p_(p) {}
-
-  template <typename T> bool operator()(const T* const c,
-                                        T* residual) const {
-    T val(0);
-    for (int i=0; i < p_.size(); ++i)
-    {
-      val += T(y_) - P_ * pow(T(x_), T(c));
-    }
-    residual[0] = val;
-
-    return true;
-  }
-
- private:
-  const double x_;
-  const double y_;
-  const std::vector<double> p_;
-};
-
-
-void PolyBounded::add_residual_blocks(ceres::Problem &problem,
-                                      const std::vector<double> &x,
-                                      const std::vector<double> &y,
-                                      std::vector<double> &c
-                                      )
-{
-  if (x.size() != y.size())
-    return;
-
-  for (int i=0; i < x.size(); ++i) {
-    double xx = x.at(i) - xoffset_.value.value();
-
-    problem.AddResidualBlock(
-        new ceres::AutoDiffCostFunction<PolyResidual, 1, 1>(
-            new PolyResidual(xx, y.at(i), c)),
-        NULL,
-        c.data());
-//    for (auto &c : cc) {
-//      problem.AddResidualBlock(
-//          new ceres::AutoDiffCostFunction<PolyResidual, 1, 1>(
-//              new PolyResidual(xx, y.at(i), c.first)),
-//          NULL,
-//          &c.second);
-//    }
-  }
-}
-#endif
-
@@ -37,6 +37,7 @@ public:
   std::string to_UTF8(int precision = -1, bool with_rsq = false) override;
   std::string to_markup(int precision = -1, bool with_rsq = false) override;
   double eval(double x)  override;
+  void eval_span(const double *x, double *y, size_t n) override;
   double derivative(double x) override;
 
   void to_xml(pugi::xml_node &node) const override;
@@ -45,17 +46,6 @@ public:
 
   //Fityk
   std::string fityk_definition() override;
-
-#ifdef FITTER_CERES_ENABLED
-
-  //Ceres
-  void add_residual_blocks(ceres::Problem &problem,
-                           const std::vector<double> &x,
-                           const std::vector<double> &y,
-                           std::vector<double> &c
-                           ) override;
-#endif
-
 };
 
 #endif
@@ -141,6 +141,16 @@ double SqrtPoly::eval(double x) {
   return sqrt(result);
 }
 
+void SqrtPoly::eval_span(const double *x, double *y, size_t n) {
+  double offset = xoffset_.value.value();
+  std::vector<double> x_adjusted(n);
+  for (size_t i=0; i < n; ++i)
+    x_adjusted[i] = x[i] - offset;
+  horner_span(coeffs(), x_adjusted.data(), y, n);
+  for (size_t i=0; i < n; ++i)
+    y[i] = sqrt(y[i]);
+}
+
 double SqrtPoly::derivative(double x) {
   return x;
 }
@@ -38,6 +38,7 @@ public:
   std::string to_UTF8(int precision = -1, bool with_rsq = false) override;
   std::string to_markup(int precision = -1, bool with_rsq = false) override;
   double eval(double x)  override;
+  void eval_span(const double *x, double *y, size_t n) override;
   double derivative(double x) override;
 
 };
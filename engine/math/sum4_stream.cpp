@@ -0,0 +1,157 @@
+/*******************************************************************************
+ *
+ * This software was developed at the National Institute of Standards and
+ * Technology (NIST) by employees of the Federal Government in the course
+ * of their official duties. Pursuant to title 17 Section 105 of the
+ * United States Code, this software is not subject to copyright protection
+ * and is in the public domain. NIST assumes no responsibility whatsoever for
+ * its use by other parties, and makes no guarantees, expressed or implied,
+ * about its quality, reliability, or any other characteristic.
+ *
+ * This software can be redistributed and/or modified freely provided that
+ * any derivative works bear some notice that they are derived from it, and
+ * any modified versions bear some notice that they have been modified.
+ *
+ * Author(s):
+ *      Martin Shetty (NIST)
+ *
+ * Description:
+ *      SUM4Stream - SUM4 integrals kept as running sums, updated per count
+ *
+ ******************************************************************************/
+
+#include "sum4_stream.h"
+#include <cmath>
+#include <limits>
+
+namespace Qpx {
+
+SUM4Stream::SUM4Stream()
+{}
+
+SUM4Stream::SUM4Stream(double LB_left, double LB_right,
+                       double left, double right,
+                       double RB_left, double RB_right)
+  : LB_(LB_left, LB_right)
+  , peak_(left, right)
+  , RB_(RB_left, RB_right)
+{}
+
+bool SUM4Stream::valid() const
+{
+  return (LB_.width() > 0) && (peak_.width() > 0) && (RB_.width() > 0)
+      && (LB_.R < peak_.L) && (peak_.R < RB_.L);
+}
+
+void SUM4Stream::reset()
+{
+  LB_ = Range(LB_.L, LB_.R);
+  peak_ = Range(peak_.L, peak_.R);
+  RB_ = Range(RB_.L, RB_.R);
+}
+
+//linear background through edge averages, as in ROI::sum4_background
+double SUM4Stream::background(double chan) const
+{
+  double LBavg = LB_.sum / LB_.width();
+  double RBavg = RB_.sum / RB_.width();
+  double slope = (RBavg - LBavg) / (RB_.L - LB_.R);
+  return LBavg + slope * (chan - LB_.R);
+}
+
+double SUM4Stream::background_variance() const
+{
+  //variance of edge averages for Poisson counts
+  double LBvar = LB_.sum / pow(LB_.width(), 2);
+  double RBvar = RB_.sum / pow(RB_.width(), 2);
+  return pow((peak_.width() / 2.0), 2) * (LBvar + RBvar);
+}
+
+UncertainDouble SUM4Stream::gross_area() const
+{
+  if (!valid())
+    return UncertainDouble();
+  return UncertainDouble::from_double(peak_.sum, sqrt(peak_.sum), 0);
+}
+
+UncertainDouble SUM4Stream::background_area() const
+{
+  if (!valid())
+    return UncertainDouble();
+  return UncertainDouble::from_double(
+        peak_.width() * (background(peak_.R) + background(peak_.L)) / 2.0,
+        sqrt(background_variance()), 0);
+}
+
+UncertainDouble SUM4Stream::peak_area() const
+{
+  if (!valid())
+    return UncertainDouble();
+  UncertainDouble ret = gross_area() - background_area();
+  ret.autoSigs(1);
+  return ret;
+}
+
+void SUM4Stream::net_moments(double &centroid, double &variance) const
+{
+  double sumB(0), CsumB(0), C2sumB(0);
+  for (double x = peak_.L; x <= peak_.R; x += 1) {
+    double b = background(x);
+    sumB += b;
+    CsumB += x * b;
+    C2sumB += x * x * b;
+  }
+
+  double sumYnet = peak_.sum - sumB;
+  centroid = (peak_.sum_x - CsumB) / sumYnet;
+  variance = ((peak_.sum_x2 - C2sumB) / sumYnet) - pow(centroid, 2);
+}
+
+UncertainDouble SUM4Stream::centroid() const
+{
+  if (!valid())
+    return UncertainDouble();
+
+  double centroidval, centroid_variance;
+  net_moments(centroidval, centroid_variance);
+  return UncertainDouble::from_double(centroidval, centroid_variance);
+}
+
+UncertainDouble SUM4Stream::fwhm() const
+{
+  if (!valid())
+    return UncertainDouble();
+
+  double centroidval, centroid_variance;
+  net_moments(centroidval, centroid_variance);
+  double fwhm_val = 2.0 * sqrt(centroid_variance * log(4));
+  return UncertainDouble::from_double(fwhm_val, std::numeric_limits<double>::quiet_NaN());
+}
+
+int SUM4Stream::quality() const
+{
+  if (!valid())
+    return 5;
+  return currie_quality(peak_area().value(), background_variance());
+}
+
+int SUM4Stream::currie_quality(double peak_net_area, double background_variance)
+{
+  double currieLQ(0), currieLD(0), currieLC(0);
+  currieLQ = 50 * (1 + sqrt(1 + background_variance / 12.5));
+  currieLD = 2.71 + 4.65 * sqrt(background_variance);
+  currieLC = 2.33 * sqrt(background_variance);
+
+  if (peak_net_area > currieLQ)
+    return 1;
+  else if (peak_net_area > currieLD)
+    return 2;
+  else if (peak_net_area > currieLC)
+    return 3;
+  else if (peak_net_area > 0)
+    return 4;
+  else
+    return 5;
+}
+
+}
@@ -0,0 +1,97 @@
+/*******************************************************************************
+ *
+ * This software was developed at the National Institute of Standards and
+ * Technology (NIST) by employees of the Federal Government in the course
+ * of their official duties. Pursuant to title 17 Section 105 of the
+ * United States Code, this software is not subject to copyright protection
+ * and is in the public domain. NIST assumes no responsibility whatsoever for
+ * its use by other parties, and makes no guarantees, expressed or implied,
+ * about its quality, reliability, or any other characteristic.
+ *
+ * This software can be redistributed and/or modified freely provided that
+ * any derivative works bear some notice that they are derived from it, and
+ * any modified versions bear some notice that they have been modified.
+ *
+ * Author(s):
+ *      Martin Shetty (NIST)
+ *
+ * Description:
+ *      SUM4Stream - SUM4 integrals kept as running sums, updated per count
+ *
+ ******************************************************************************/
+
+#ifndef SUM4_STREAM_H
+#define SUM4_STREAM_H
+
+#include <cstddef>
+#include "UncertainDouble.h"
+
+namespace Qpx {
+
+class SUM4Stream {
+public:
+  SUM4Stream();
+  SUM4Stream(double LB_left, double LB_right,
+             double left, double right,
+             double RB_left, double RB_right);
+
+  bool valid() const;
+  void reset();
+
+  //hot path, called for every binned count
+  inline void add(double chan, double count)
+  {
+    if ((chan < LB_.L) || (chan > RB_.R))
+      return;
+    LB_.add(chan, count);
+    peak_.add(chan, count);
+    RB_.add(chan, count);
+  }
+
+  double LB_left()  const {return LB_.L;}
+  double LB_right() const {return LB_.R;}
+  double left()     const {return peak_.L;}
+  double right()    const {return peak_.R;}
+  double RB_left()  const {return RB_.L;}
+  double RB_right() const {return RB_.R;}
+  double peak_width() const {return peak_.width();}
+
+  UncertainDouble gross_area()      const;
+  UncertainDouble background_area() const;
+  UncertainDouble peak_area()       const;
+  UncertainDouble centroid()        const;
+  UncertainDouble fwhm()            const;
+  int quality() const;
+
+  static int currie_quality(double peak_net_area, double background_variance);
+
+private:
+  struct Range {
+    Range() : L(0), R(-1), sum(0), sum_x(0), sum_x2(0) {}
+    Range(double l, double r) : L(l), R(r), sum(0), sum_x(0), sum_x2(0) {}
+
+    inline void add(double chan, double count)
+    {
+      if ((chan < L) || (chan > R))
+        return;
+      sum    += count;
+      sum_x  += count * chan;
+      sum_x2 += count * chan * chan;
+    }
+
+    double width() const { return (R < L) ? 0 : (R - L + 1); }
+
+    double L, R;
+    double sum, sum_x, sum_x2;
+  };
+
+  Range LB_, peak_, RB_;
+
+  double background(double chan) const;
+  double background_variance() const;
+  void net_moments(double &centroid, double &variance) const;
+};
+
+}
+
+#endif
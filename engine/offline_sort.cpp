@@ -0,0 +1,174 @@
+/*******************************************************************************
+ *
+ * This software was developed at the National Institute of Standards and
+ * Technology (NIST) by employees of the Federal Government in the course
+ * of their official duties. Pursuant to title 17 Section 105 of the
+ * United States Code, this software is not subject to copyright protection
+ * and is in the public domain. NIST assumes no responsibility whatsoever for
+ * its use by other parties, and makes no guarantees, expressed or implied,
+ * about its quality, reliability, or any other characteristic.
+ *
+ * Author(s):
+ *      Martin Shetty (NIST)
+ *
+ * Description:
+ *      Qpx::OfflineSorter - re-sorts a list mode file into a project,
+ *      one time slice per thread, each into private copies of the sinks
+ *
+ ******************************************************************************/
+
+#include "offline_sort.h"
+#include <limits>
+#include <cmath>
+#include <boost/bind.hpp>
+#include "daq_sink_factory.h"
+#include "custom_timer.h"
+#include "custom_logger.h"
+
+namespace Qpx {
+
+bool OfflineSorter::sort(std::string file_name, ProjectPtr project,
+                         boost::atomic<bool>& interruptor, unsigned int threads)
+{
+  ListFileReader reader;
+  if (!project || !reader.open(file_name)) {
+    ERR << "<OfflineSorter> Could not open list mode file " << file_name;
+    return false;
+  }
+
+  if (!threads)
+    threads = boost::thread::hardware_concurrency();
+  threads = std::max(1u, threads);
+
+  file_name_ = file_name;
+  if (!reader.time_range(first_ns_, last_ns_)) {
+    WARN << "<OfflineSorter> " << file_name << " has no time index, sorting in one slice";
+    first_ns_ = -std::numeric_limits<double>::infinity();
+    last_ns_ = std::numeric_limits<double>::infinity();
+    threads = 1;
+  }
+
+  //each slice gets fresh sinks from the project's prototypes
+  std::vector<Slice> slices(threads);
+  std::map<int64_t, SinkPtr> targets = project->get_sinks();
+  std::set<int64_t> sliced;
+  margin_ns_ = 0;
+  for (auto &t : targets) {
+    Metadata prototype = t.second->metadata();
+    std::vector<SinkPtr> copies;
+    for (size_t i=0; i < slices.size(); ++i) {
+      SinkPtr copy = SinkFactory::getInstance().create_from_prototype(prototype);
+      if (!copy || !copy->set_sort_window(0, 0))
+        break;
+      copies.push_back(copy);
+    }
+    if (copies.size() != slices.size()) {
+      DBG << "<OfflineSorter> " << prototype.get_attribute("name").value_text
+          << " cannot be sorted in slices, will get whole run in order";
+      continue;
+    }
+    for (size_t i=0; i < slices.size(); ++i)
+      slices[i].sinks[t.first] = copies[i];
+    sliced.insert(t.first);
+    margin_ns_ = std::max(margin_ns_, copies.front()->sort_margin());
+  }
+
+  //first and last slices reach to infinity, nothing at the edges is lost
+  double width = (last_ns_ - first_ns_) / slices.size();
+  for (size_t i=0; i < slices.size(); ++i) {
+    slices[i].from_ns = (i == 0) ? -std::numeric_limits<double>::infinity()
+                                 : first_ns_ + i * width;
+    slices[i].to_ns = (i + 1 == slices.size()) ? std::numeric_limits<double>::infinity()
+                                               : first_ns_ + (i + 1) * width;
+    slices[i].hits = 0;
+    for (auto &s : slices[i].sinks)
+      s.second->set_sort_window(slices[i].from_ns, slices[i].to_ns);
+  }
+
+  //read about 16 chunks at a time
+  step_ns_ = std::numeric_limits<double>::infinity();
+  if (reader.chunk_count() > 16)
+    step_ns_ = (last_ns_ - first_ns_) * 16 / reader.chunk_count();
+
+  LINFO << "<OfflineSorter> Sorting " << file_name << " into " << sliced.size()
+        << " of " << targets.size() << " sinks in " << slices.size()
+        << " slices, overlap " << margin_ns_ << " ns";
+  CustomTimer timer(true);
+
+  boost::thread_group workers;
+  if (!sliced.empty())
+    for (auto &s : slices)
+      workers.create_thread(boost::bind(&OfflineSorter::sort_slice, this, boost::ref(s),
+                                        boost::ref(interruptor)));
+
+  //spills in order give the project its stats and record, and carry hits
+  //to sinks that were not sliced
+  bool whole_run = (sliced.size() < targets.size());
+  for (size_t i=0; (i < reader.size()) && !interruptor.load(); ++i) {
+    Spill spill = reader.spill(i);
+    if (whole_run && !reader.read_hits(i, reader.models(), spill.hits))
+      WARN << "<OfflineSorter> Only " << spill.hits.size() << " of "
+           << reader.hit_count(i) << " hits readable in spill " << i;
+    project->add_spill(&spill, sliced);
+  }
+
+  workers.join_all();
+
+  //reduce slices into project's sinks
+  uint64_t hits = 0;
+  for (auto &s : slices) {
+    hits += s.hits;
+    for (auto &sink : s.sinks)
+      if (!targets.at(sink.first)->merge(*sink.second, true))
+        WARN << "<OfflineSorter> Could not merge slice into "
+             << sink.second->metadata().get_attribute("name").value_text;
+  }
+  project->flush();
+
+  LINFO << "<OfflineSorter> Sorted " << hits << " hits from " << reader.size()
+        << " spills in " << timer.s() << " s";
+  return !interruptor.load();
+}
+
+void OfflineSorter::sort_slice(Slice &slice, boost::atomic<bool>& interruptor)
+{
+  ListFileReader reader;
+  if (!reader.open(file_name_))
+    return;
+
+  //stats first, sinks learn their channels' models from them
+  for (size_t i=0; i < reader.size(); ++i) {
+    Spill spill = reader.spill(i);
+    for (auto &s : slice.sinks)
+      s.second->push_spill(spill);
+  }
+
+  double from = std::max(slice.from_ns - margin_ns_, first_ns_);
+  double to = std::min(slice.to_ns + margin_ns_, last_ns_);
+  bool to_end = (to >= last_ns_);
+
+  double t = from;
+  bool done = false;
+  while (!done && !interruptor.load()) {
+    double end = std::isfinite(t) ? std::min(t + step_ns_, to) : to;
+    done = (end >= to);
+    Spill spill;
+    //last hit of run is at last_ns_, final window closes past it
+    reader.read_slice(t, (done && to_end) ? std::numeric_limits<double>::infinity() : end,
+                      std::set<int16_t>(), reader.models(), spill.hits);
+    t = end;
+    if (spill.hits.empty())
+      continue;
+    slice.hits += spill.hits.size();
+    for (auto &s : slice.sinks)
+      s.second->push_spill(spill);
+  }
+
+  for (auto &s : slice.sinks)
+    s.second->flush();
+
+  DBG << "<OfflineSorter> Slice " << slice.from_ns << " - " << slice.to_ns
+      << " ns sorted " << slice.hits << " hits";
+}
+
+}
@@ -0,0 +1,52 @@
+/*******************************************************************************
+ *
+ * This software was developed at the National Institute of Standards and
+ * Technology (NIST) by employees of the Federal Government in the course
+ * of their official duties. Pursuant to title 17 Section 105 of the
+ * United States Code, this software is not subject to copyright protection
+ * and is in the public domain. NIST assumes no responsibility whatsoever for
+ * its use by other parties, and makes no guarantees, expressed or implied,
+ * about its quality, reliability, or any other characteristic.
+ *
+ * Author(s):
+ *      Martin Shetty (NIST)
+ *
+ * Description:
+ *      Qpx::OfflineSorter - re-sorts a list mode file into a project,
+ *      one time slice per thread, each into private copies of the sinks
+ *
+ ******************************************************************************/
+
+#ifndef QPX_OFFLINE_SORT_H
+#define QPX_OFFLINE_SORT_H
+
+#include "project.h"
+#include "list_file.h"
+
+namespace Qpx {
+
+class OfflineSorter {
+public:
+  //sinks of project serve as prototypes and receive the results;
+  //slices overlap by the longest coincidence span of the sinks, each event
+  //counted only in the slice where it starts; sinks that cannot be summed
+  //from slices get the whole run in order, alongside the slices
+  bool sort(std::string file_name, ProjectPtr project,
+            boost::atomic<bool>& interruptor, unsigned int threads = 0);
+
+private:
+  struct Slice {
+    double from_ns, to_ns;
+    std::map<int64_t, SinkPtr> sinks;
+    uint64_t hits;
+  };
+
+  std::string file_name_;
+  double first_ns_, last_ns_, margin_ns_, step_ns_;
+
+  void sort_slice(Slice &slice, boost::atomic<bool>& interruptor);
+};
+
+}
+
+#endif
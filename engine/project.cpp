@@ -26,6 +26,7 @@
 #include "daq_sink_factory.h"
 #include "custom_logger.h"
 #include "qpx_util.h"
+#include "custom_timer.h"
 
 
 #include <fstream>
@@ -49,6 +50,13 @@ Project::Project(const Qpx::Project& other)
   DBG << "<Qpx::Project> deep copy performed";
 }
 
+Project::~Project()
+{
+  wait_saved();
+  if (save_thread_.joinable())
+    save_thread_.join();
+}
+
 
 std::string Project::identity() const
 {
@@ -78,6 +86,7 @@ void Project::clear_helper() {
 }
 
 void Project::flush() {
+  boost::unique_lock<boost::mutex> spill_lock(spill_mutex_);
   boost::unique_lock<boost::mutex> lock(mutex_);
   if (!sinks_.empty())
     for (auto &q: sinks_) {
@@ -264,10 +273,28 @@ void Project::set_prototypes(const XMLableDB<Metadata>& prototypes) {
 }
 
 void Project::add_spill(Spill* one_spill) {
-  boost::unique_lock<boost::mutex> lock(mutex_);
+  add_spill(one_spill, std::set<int64_t>());
+}
 
-  for (auto &q: sinks_)
-    q.second->push_spill(*one_spill);
+void Project::add_spill(Spill* one_spill, const std::set<int64_t> &without_hits) {
+  //sinks lock themselves; project stays available to readers while they sort
+  boost::unique_lock<boost::mutex> spill_lock(spill_mutex_);
+  std::map<int64_t, SinkPtr> sinks;
+  {
+    boost::unique_lock<boost::mutex> lock(mutex_);
+    sinks = sinks_;
+  }
+
+  Spill no_hits;
+  if (!without_hits.empty()) {
+    no_hits = *one_spill;
+    no_hits.hits.clear();
+  }
+
+  for (auto &q: sinks)
+    q.second->push_spill(without_hits.count(q.first) ? no_hits : *one_spill);
+
+  boost::unique_lock<boost::mutex> lock(mutex_);
 
   if (!one_spill->detectors.empty()
       || !one_spill->state.branches.empty())
@@ -288,66 +315,162 @@ void Project::add_spill(Spill* one_spill) {
 
 
 void Project::save() {
-  boost::unique_lock<boost::mutex> lock(mutex_);
-  if (/*changed_ && */(identity_ != "New project"))
-    write_xml(identity_);
+  std::string file_name = identity();
+  if (/*changed_ && */(file_name == "New project"))
+    return;
+  while (!start_save(file_name))
+    wait_saved();
+  wait_saved();
 }
 
 
 void Project::save_as(std::string file_name) {
-  boost::unique_lock<boost::mutex> lock(mutex_);
-  write_xml(file_name);
+  while (!start_save(file_name))
+    wait_saved();
+  wait_saved();
 }
 
-void Project::write_xml(std::string file_name) {
-  pugi::xml_document doc;
-  pugi::xml_node root = doc.append_child();
+bool Project::save_in_background(std::string file_name) {
+  if (file_name.empty())
+    file_name = identity();
+  if (file_name == "New project")
+    return false;
+  return start_save(file_name);
+}
 
-  to_xml(root);
+bool Project::saving() const {
+  boost::unique_lock<boost::mutex> lock(save_mutex_);
+  return saving_;
+}
 
-  doc.save_file(file_name.c_str());
+std::string Project::save_error() const {
+  boost::unique_lock<boost::mutex> lock(save_mutex_);
+  return save_error_;
+}
 
-  for (auto &q : sinks_)
-    q.second->reset_changed();
+void Project::wait_saved() {
+  boost::unique_lock<boost::mutex> lock(save_mutex_);
+  while (saving_)
+    save_cond_.wait(lock);
+}
 
-  identity_ = file_name;
-  cond_.notify_all();
+bool Project::start_save(std::string file_name) {
+  {
+    boost::unique_lock<boost::mutex> lock(save_mutex_);
+    if (saving_)
+      return false;
+    saving_ = true;
+  }
+
+  //previous writer has already reported, only its exit remains
+  if (save_thread_.joinable())
+    save_thread_.join();
+
+  SaveJob job;
+  job.file_name = file_name;
+  {
+    //between spills; sorting waits only for the sinks to be cloned
+    boost::unique_lock<boost::mutex> spill_lock(spill_mutex_);
+    boost::unique_lock<boost::mutex> lock(mutex_);
+    job.spills = spills_;
+    job.fitters = fitters_1d_;
+    for (auto &q : sinks_) {
+      job.sinks[q.first] = q.second->snapshot();
+      q.second->reset_changed();
+    }
+    changed_ = false;
+  }
+
+  save_thread_ = boost::thread(&Project::write_xml, this, job);
+  return true;
+}
+
+void Project::write_xml(SaveJob job) {
+  CustomTimer timer(true);
+  std::string temp_name = job.file_name + ".tmp";
+  std::string error;
+
+  try {
+    pugi::xml_document doc;
+    pugi::xml_node root = doc.append_child();
+    job_to_xml(root, job);
+
+    //readers of file_name see either the old or the complete new project
+    if (!doc.save_file(temp_name.c_str()))
+      error = "could not write " + temp_name;
+    else
+      boost::filesystem::rename(temp_name, job.file_name);
+  } catch (std::exception &e) {
+    error = e.what();
+  }
+
+  if (!error.empty()) {
+    boost::system::error_code ec;
+    boost::filesystem::remove(temp_name, ec);
+    ERR << "<Qpx::Project> failed to save " << job.file_name << ": " << error;
+  } else
+    LINFO << "<Qpx::Project> saved " << job.file_name << " in " << timer.ms() << " ms";
+
+  {
+    boost::unique_lock<boost::mutex> lock(mutex_);
+    if (error.empty())
+      identity_ = job.file_name;
+    else
+      changed_ = true;
+    ready_ = true;
+    cond_.notify_all();
+  }
+
+  boost::unique_lock<boost::mutex> lock(save_mutex_);
+  saving_ = false;
+  save_error_ = error;
+  save_cond_.notify_all();
 }
 
 void Project::to_xml(pugi::xml_node &root) const {
-  root.set_name(this->xml_element_name().c_str());
+  SaveJob job;
+  job.spills = spills_;
+  job.fitters = fitters_1d_;
+  for (auto &q : sinks_)
+    job.sinks[q.first] = q.second->snapshot();
+
+  job_to_xml(root, job);
+
+  changed_ = false;
+  ready_ = true;
+  newdata_ = true;
+}
+
+void Project::job_to_xml(pugi::xml_node &root, const SaveJob &job) {
+  root.set_name("QpxProject");
   root.append_attribute("git_version").set_value(std::string(GIT_VERSION).c_str());
 
-  if (!spills_.empty())
+  if (!job.spills.empty())
   {
     pugi::xml_node spillsnode = root.append_child("Spills");
-    for (auto &s :spills_)
+    for (auto &s : job.spills)
       s.to_xml(spillsnode, true);
   }
 
-  if (!sinks_.empty()) {
+  if (!job.sinks.empty()) {
 
     pugi::xml_node sinks_node = root.append_child("Sinks");
-    for (auto &q : sinks_) {
+    for (auto &q : job.sinks) {
       q.second->save(sinks_node);
       sinks_node.last_child().append_attribute("idx").set_value(std::to_string(q.first).c_str());
     }
   }
 
-  if (fitters_1d_.size())
+  if (!job.fitters.empty())
   {
     //    DBG << "Will save fitters";
     pugi::xml_node fits_node = root.append_child("Fits1D");
-    for (auto &q : fitters_1d_) {
+    for (auto &q : job.fitters) {
       //      DBG << "saving fit " << q.first;
       q.second.to_xml(fits_node);
       fits_node.last_child().append_attribute("idx").set_value(std::to_string(q.first).c_str());
     }
   }
-
-  changed_ = false;
-  ready_ = true;
-  newdata_ = true;
 }
 
 void Project::read_xml(std::string file_name, bool with_sinks, bool with_full_sinks) {
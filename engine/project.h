@@ -47,13 +47,31 @@ private:
   std::string   identity_;
   mutable bool  changed_;
 
+  //background save; spill_mutex_ spans a whole add_spill so that
+  //snapshots of all sinks fall on the same spill boundary
+  boost::mutex  spill_mutex_;
+  mutable boost::mutex save_mutex_;
+  boost::condition_variable save_cond_;
+  boost::thread save_thread_;
+  bool          saving_;
+  std::string   save_error_;
+
+  struct SaveJob {
+    std::string file_name;
+    std::set<Spill> spills;
+    std::map<int64_t, std::shared_ptr<const Sink>> sinks;
+    std::map<int64_t, Fitter> fitters;
+  };
+
 public:
   Project()
     : ready_(false), newdata_(false), changed_(false)
     , identity_("New project")
     , current_index_(0)
+    , saving_(false)
   {}
   Project(const Qpx::Project&);
+  ~Project();
 
   ////control//////
   void clear();
@@ -69,12 +87,21 @@ public:
   void save();
   void save_as(std::string file_name);
 
+  //returns immediately, acquisition continues while file is written;
+  //false if another save is still in progress
+  bool save_in_background(std::string file_name = std::string());
+  bool saving() const;
+  std::string save_error() const; //empty if last save succeeded
+  void wait_saved();
+
   void read_xml(std::string file_name, bool with_sinks = true, bool with_full_sinks = true);
 
   void delete_sink(int64_t idx);
 
   //acquisition feeds events to all sinks
   void add_spill(Spill* one_spill);
+  //sinks listed get spill without hits, for sorters that deliver those separately
+  void add_spill(Spill* one_spill, const std::set<int64_t> &without_hits);
   void flush();
 
   //status inquiry
@@ -109,7 +136,9 @@ public:
 private:
   //helpers
   void clear_helper();
-  void write_xml(std::string file_name);
+  bool start_save(std::string file_name);
+  void write_xml(SaveJob job);
+  static void job_to_xml(pugi::xml_node &root, const SaveJob &job);
 
 };
 
@@ -0,0 +1,76 @@
+/*******************************************************************************
+ *
+ * This software was developed at the National Institute of Standards and
+ * Technology (NIST) by employees of the Federal Government in the course
+ * of their official duties. Pursuant to title 17 Section 105 of the
+ * United States Code, this software is not subject to copyright protection
+ * and is in the public domain. NIST assumes no responsibility whatsoever for
+ * its use by other parties, and makes no guarantees, expressed or implied,
+ * about its quality, reliability, or any other characteristic.
+ *
+ * Author(s):
+ *      Martin Shetty (NIST)
+ *
+ * Description:
+ *      Qpx::Pyramid2D - 2D counts rebinned by successive powers of 2,
+ *                       kept current as bins are incremented
+ *
+ ******************************************************************************/
+
+#include "pyramid.h"
+#include <algorithm>
+
+namespace Qpx {
+
+void Pyramid2D::resize(uint16_t bits, uint16_t max_bits, uint16_t min_bits)
+{
+  levels_.clear();
+  uint16_t first = std::max(1, bits - max_bits);
+  for (int shift = first; (bits - shift) >= min_bits; ++shift) {
+    Level l;
+    l.shift = shift;
+    l.width = size_t(1) << (bits - shift);
+    levels_.push_back(l);
+  }
+}
+
+void Pyramid2D::clear()
+{
+  for (auto &l : levels_)
+    l.cells.clear();
+}
+
+bool Pyramid2D::has_level(uint16_t level) const
+{
+  return !levels_.empty()
+      && (level >= levels_.front().shift)
+      && (level <= levels_.back().shift);
+}
+
+uint16_t Pyramid2D::min_level() const
+{
+  return levels_.empty() ? 0 : levels_.front().shift;
+}
+
+uint16_t Pyramid2D::max_level() const
+{
+  return levels_.empty() ? 0 : levels_.back().shift;
+}
+
+void Pyramid2D::get(uint16_t level, size_t min0, size_t max0, size_t min1, size_t max1,
+                    std::vector<double> &values) const
+{
+  if (!has_level(level) || (max0 < min0) || (max1 < min1))
+    return;
+
+  const Level &l = levels_.at(level - levels_.front().shift);
+  size_t width = max0 - min0 + 1;
+  size_t rows = l.cells.size() / l.width;
+  for (size_t r = min0; (r <= max0) && (r < rows); ++r) {
+    const double *row = l.cells.data() + r * l.width;
+    for (size_t c = min1; (c <= max1) && (c < l.width); ++c)
+      values[(c - min1) * width + (r - min0)] = row[c];
+  }
+}
+
+}
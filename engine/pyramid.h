@@ -0,0 +1,78 @@
+/*******************************************************************************
+ *
+ * This software was developed at the National Institute of Standards and
+ * Technology (NIST) by employees of the Federal Government in the course
+ * of their official duties. Pursuant to title 17 Section 105 of the
+ * United States Code, this software is not subject to copyright protection
+ * and is in the public domain. NIST assumes no responsibility whatsoever for
+ * its use by other parties, and makes no guarantees, expressed or implied,
+ * about its quality, reliability, or any other characteristic.
+ *
+ * Author(s):
+ *      Martin Shetty (NIST)
+ *
+ * Description:
+ *      Qpx::Pyramid2D - 2D counts rebinned by successive powers of 2,
+ *                       kept current as bins are incremented
+ *
+ ******************************************************************************/
+
+#ifndef QPX_PYRAMID_H
+#define QPX_PYRAMID_H
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+namespace Qpx {
+
+class Pyramid2D {
+public:
+  Pyramid2D() {}
+
+  //levels for a dimension of 2^bits bins, coarsest 2^min_bits wide,
+  //finest no more than 2^max_bits wide (full resolution is not duplicated)
+  //dimension 0 may grow without bound (e.g. time)
+  void resize(uint16_t bits, uint16_t max_bits = 10, uint16_t min_bits = 4);
+  void clear();
+
+  //hot path
+  inline void add(size_t c0, size_t c1, double count)
+  {
+    for (auto &l : levels_)
+      l.add(c0, c1, count);
+  }
+
+  bool has_level(uint16_t level) const;
+  uint16_t min_level() const;
+  uint16_t max_level() const;
+
+  //inclusive ranges in rebinned coordinates, dimension 0 varies fastest
+  void get(uint16_t level, size_t min0, size_t max0, size_t min1, size_t max1,
+           std::vector<double> &values) const;
+
+private:
+  struct Level {
+    uint16_t shift {0};
+    size_t width {0};
+    std::vector<double> cells; //rows along dimension 0, appended as needed
+
+    inline void add(size_t c0, size_t c1, double count)
+    {
+      size_t r = c0 >> shift;
+      size_t c = c1 >> shift;
+      if (c >= width)
+        return;
+      size_t idx = r * width + c;
+      if (idx >= cells.size())
+        cells.resize((r + 1) * width, 0);
+      cells[idx] += count;
+    }
+  };
+
+  std::vector<Level> levels_;
+};
+
+}
+
+#endif
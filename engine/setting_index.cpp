@@ -0,0 +1,148 @@
+/*******************************************************************************
+ *
+ * This software was developed at the National Institute of Standards and
+ * Technology (NIST) by employees of the Federal Government in the course
+ * of their official duties. Pursuant to title 17 Section 105 of the
+ * United States Code, this software is not subject to copyright protection
+ * and is in the public domain. NIST assumes no responsibility whatsoever for
+ * its use by other parties, and makes no guarantees, expressed or implied,
+ * about its quality, reliability, or any other characteristic.
+ *
+ * Author(s):
+ *      Martin Shetty (NIST)
+ *
+ * Description:
+ *      Qpx::SettingIndex - hashed id/index lookup into a Setting tree,
+ *                          same results as the recursive Setting searches
+ *
+ ******************************************************************************/
+
+#include "setting_index.h"
+#include <algorithm>
+
+namespace Qpx {
+
+void SettingIndex::clear()
+{
+  nodes_.clear();
+  by_id_.clear();
+  by_index_.clear();
+  no_indices_.clear();
+  position_.clear();
+}
+
+void SettingIndex::rebuild(Setting &root)
+{
+  clear();
+  add(root, &root, true, true);
+}
+
+void SettingIndex::add(Setting &node, Setting *branch, bool searched, bool under_stems)
+{
+  bool stem = (node.metadata.setting_type == SettingType::stem);
+  bool listed = under_stems && !stem
+      && (node.metadata.setting_type != SettingType::detector);
+
+  if (searched || listed) {
+    size_t pos = nodes_.size();
+    nodes_.push_back(Node({&node, branch, searched, listed}));
+    position_[&node] = pos;
+    by_id_[node.id_].push_back(pos);
+    if (node.indices.empty())
+      no_indices_.push_back(pos);
+    for (auto &i : node.indices)
+      by_index_[i].push_back(pos);
+  }
+
+  bool search_below = searched &&
+      (stem || (node.metadata.setting_type == SettingType::indicator));
+  bool stems_below = under_stems && stem;
+  if (!search_below && !stems_below)
+    return;
+
+  bool top = nodes_.size() && (nodes_.front().setting == &node);
+  for (auto &q : node.branches.my_data_)
+    add(q, top ? &q : branch, search_below, stems_below);
+}
+
+std::vector<size_t> SettingIndex::candidates(const Setting &address, Match flags) const
+{
+  if (flags & Match::id) {
+    auto it = by_id_.find(address.id_);
+    if (it == by_id_.end())
+      return std::vector<size_t>();
+    return it->second;
+  }
+
+  if (flags & Match::indices) {
+    if (address.indices.empty())
+      return no_indices_;
+    std::vector<size_t> ret;
+    for (auto &i : address.indices) {
+      auto it = by_index_.find(i);
+      if (it != by_index_.end())
+        ret.insert(ret.end(), it->second.begin(), it->second.end());
+    }
+    if (address.indices.size() > 1) {
+      std::sort(ret.begin(), ret.end());
+      ret.erase(std::unique(ret.begin(), ret.end()), ret.end());
+    }
+    return ret;
+  }
+
+  //name or address only, no hash for those
+  std::vector<size_t> ret(nodes_.size());
+  for (size_t i=0; i < ret.size(); ++i)
+    ret[i] = i;
+  return ret;
+}
+
+Setting* SettingIndex::find(const Setting &address, Match flags) const
+{
+  for (auto &i : candidates(address, flags)) {
+    const Node &n = nodes_[i];
+    if (n.searched && n.setting->compare(address, flags))
+      return n.setting;
+  }
+  return nullptr;
+}
+
+Setting* SettingIndex::branch_of(const Setting *node) const
+{
+  auto it = position_.find(node);
+  if (it == position_.end())
+    return nullptr;
+  return nodes_[it->second].branch;
+}
+
+bool SettingIndex::set_setting(const Setting &setting, Match flags)
+{
+  Setting *node = find(setting, flags);
+  if (!node)
+    return false;
+  node->set_value(setting);
+  return true;
+}
+
+std::list<Setting*> SettingIndex::find_all(const Setting &address, Match flags) const
+{
+  std::list<Setting*> result;
+  for (auto &i : candidates(address, flags)) {
+    const Node &n = nodes_[i];
+    if (n.listed && n.setting->compare(address, flags))
+      result.push_back(n.setting);
+  }
+  return result;
+}
+
+void SettingIndex::set_all(const std::list<Setting> &settings, Match flags)
+{
+  for (auto &q : settings)
+    for (auto &i : candidates(q, flags)) {
+      const Node &n = nodes_[i];
+      if (n.listed && n.setting->compare(q, flags))
+        n.setting->set_value(q);
+    }
+}
+
+}
@@ -0,0 +1,70 @@
+/*******************************************************************************
+ *
+ * This software was developed at the National Institute of Standards and
+ * Technology (NIST) by employees of the Federal Government in the course
+ * of their official duties. Pursuant to title 17 Section 105 of the
+ * United States Code, this software is not subject to copyright protection
+ * and is in the public domain. NIST assumes no responsibility whatsoever for
+ * its use by other parties, and makes no guarantees, expressed or implied,
+ * about its quality, reliability, or any other characteristic.
+ *
+ * Author(s):
+ *      Martin Shetty (NIST)
+ *
+ * Description:
+ *      Qpx::SettingIndex - hashed id/index lookup into a Setting tree,
+ *                          same results as the recursive Setting searches
+ *
+ ******************************************************************************/
+
+#ifndef QPX_SETTING_INDEX_H
+#define QPX_SETTING_INDEX_H
+
+#include <unordered_map>
+#include "generic_setting.h"
+
+namespace Qpx {
+
+class SettingIndex {
+public:
+  SettingIndex() {}
+
+  //holds pointers into tree; rebuild whenever branches are added or removed,
+  //changing values through the index or directly needs no rebuild
+  void rebuild(Setting &root);
+  void clear();
+  bool empty() const { return nodes_.empty(); }
+  size_t size() const { return nodes_.size(); }
+
+  //as Setting::get_setting, nullptr if nothing matches
+  Setting* find(const Setting &address, Match flags) const;
+
+  //top-level branch of root containing node, root itself for root
+  Setting* branch_of(const Setting *node) const;
+
+  //as Setting::set_setting_r, find_all and set_all
+  bool set_setting(const Setting &setting, Match flags);
+  std::list<Setting*> find_all(const Setting &address, Match flags) const;
+  void set_all(const std::list<Setting> &settings, Match flags);
+
+private:
+  struct Node {
+    Setting *setting;
+    Setting *branch;
+    bool searched; //reached by get_setting (through stems and indicators)
+    bool listed;   //reached by find_all (leaf under stems only)
+  };
+
+  std::vector<Node> nodes_; //in depth-first order of recursive searches
+  std::unordered_map<std::string, std::vector<size_t>> by_id_;
+  std::unordered_map<int32_t, std::vector<size_t>> by_index_;
+  std::vector<size_t> no_indices_;
+  std::unordered_map<const Setting*, size_t> position_;
+
+  void add(Setting &node, Setting *branch, bool searched, bool under_stems);
+  std::vector<size_t> candidates(const Setting &address, Match flags) const;
+};
+
+}
+
+#endif
@@ -0,0 +1,189 @@
+/*******************************************************************************
+ *
+ * This software was developed at the National Institute of Standards and
+ * Technology (NIST) by employees of the Federal Government in the course
+ * of their official duties. Pursuant to title 17 Section 105 of the
+ * United States Code, this software is not subject to copyright protection
+ * and is in the public domain. NIST assumes no responsibility whatsoever for
+ * its use by other parties, and makes no guarantees, expressed or implied,
+ * about its quality, reliability, or any other characteristic.
+ *
+ * Author(s):
+ *      Martin Shetty (NIST)
+ *
+ * Description:
+ *      Qpx::SpillCaptureWriter, Qpx::SpillCaptureReader - unparsed device
+ *      words and metadata of spills, indexed for replay
+ *
+ ******************************************************************************/
+
+#include "spill_capture.h"
+#include <sstream>
+#include <cstring>
+#include "custom_logger.h"
+
+namespace Qpx {
+
+static const char capture_magic[8] = {'Q','P','X','C','A','P','0','1'};
+static const char index_magic[8]   = {'Q','P','X','C','A','P','I','X'};
+
+bool SpillCaptureWriter::open(std::string file_name) {
+  close();
+  offsets_.clear();
+  file_.open(file_name, std::ofstream::out | std::ofstream::trunc | std::ofstream::binary);
+  if (!file_.is_open() || !file_.good()) {
+    ERR << "<SpillCapture> Could not open " << file_name << " for writing";
+    file_.close();
+    return false;
+  }
+  file_.write(capture_magic, sizeof(capture_magic));
+  return file_.good();
+}
+
+bool SpillCaptureWriter::write(const Spill &spill) {
+  if (!file_.is_open())
+    return false;
+
+  pugi::xml_document doc;
+  spill.to_xml(doc, true);
+  std::stringstream ss;
+  doc.save(ss, "", pugi::format_raw | pugi::format_no_declaration);
+  std::string xml = ss.str();
+
+  uint32_t xml_size = xml.size();
+  uint64_t words = spill.data.size();
+
+  offsets_.push_back(file_.tellp());
+  file_.write((char*)&xml_size, sizeof(xml_size));
+  file_.write(xml.data(), xml_size);
+  file_.write((char*)&words, sizeof(words));
+  if (words)
+    file_.write((char*)spill.data.data(), sizeof(uint32_t) * words);
+
+  if (!file_.good()) {
+    ERR << "<SpillCapture> Write failed after " << offsets_.size() - 1 << " spills";
+    file_.close();
+    return false;
+  }
+  return true;
+}
+
+void SpillCaptureWriter::close() {
+  if (!file_.is_open())
+    return;
+  uint64_t count = offsets_.size();
+  if (count)
+    file_.write((char*)offsets_.data(), sizeof(uint64_t) * count);
+  file_.write((char*)&count, sizeof(count));
+  file_.write(index_magic, sizeof(index_magic));
+  file_.close();
+}
+
+
+bool SpillCaptureReader::open(std::string file_name) {
+  close();
+  file_.open(file_name, std::ifstream::in | std::ifstream::binary);
+  if (!file_.is_open())
+    return false;
+
+  char magic[8];
+  file_.read(magic, sizeof(magic));
+  if (!file_.good() || memcmp(magic, capture_magic, sizeof(magic))) {
+    WARN << "<SpillCapture> " << file_name << " is not a raw capture file";
+    file_.close();
+    return false;
+  }
+
+  file_.seekg(0, std::ios::end);
+  uint64_t file_size = file_.tellg();
+
+  if (!read_index(file_size)) {
+    WARN << "<SpillCapture> " << file_name << " has no index (run did not close), scanning";
+    scan(file_size);
+  }
+
+  DBG << "<SpillCapture> " << file_name << " holds " << offsets_.size() << " spills";
+  return true;
+}
+
+void SpillCaptureReader::close() {
+  offsets_.clear();
+  if (file_.is_open())
+    file_.close();
+}
+
+bool SpillCaptureReader::read_index(uint64_t file_size) {
+  uint64_t tail = sizeof(uint64_t) + sizeof(index_magic);
+  if (file_size < sizeof(capture_magic) + tail)
+    return false;
+
+  char magic[8];
+  uint64_t count = 0;
+  file_.clear();
+  file_.seekg(file_size - tail);
+  file_.read((char*)&count, sizeof(count));
+  file_.read(magic, sizeof(magic));
+  if (!file_.good() || memcmp(magic, index_magic, sizeof(magic)))
+    return false;
+
+  if ((count * sizeof(uint64_t)) > (file_size - sizeof(capture_magic) - tail))
+    return false;
+
+  offsets_.resize(count);
+  file_.seekg(file_size - tail - count * sizeof(uint64_t));
+  if (count)
+    file_.read((char*)offsets_.data(), sizeof(uint64_t) * count);
+  if (!file_.good()) {
+    offsets_.clear();
+    return false;
+  }
+  return true;
+}
+
+void SpillCaptureReader::scan(uint64_t file_size) {
+  offsets_.clear();
+  uint64_t pos = sizeof(capture_magic);
+  while (true) {
+    uint32_t xml_size = 0;
+    uint64_t words = 0;
+    file_.clear();
+    file_.seekg(pos);
+    file_.read((char*)&xml_size, sizeof(xml_size));
+    file_.seekg(xml_size, std::ios::cur);
+    file_.read((char*)&words, sizeof(words));
+    uint64_t end = pos + sizeof(xml_size) + xml_size + sizeof(words) + words * sizeof(uint32_t);
+    if (!file_.good() || (end > file_size))
+      break; //truncated record
+    offsets_.push_back(pos);
+    pos = end;
+  }
+  file_.clear();
+}
+
+bool SpillCaptureReader::read(size_t index, Spill &spill) {
+  if (!file_.is_open() || (index >= offsets_.size()))
+    return false;
+
+  file_.clear();
+  file_.seekg(offsets_[index]);
+
+  uint32_t xml_size = 0;
+  file_.read((char*)&xml_size, sizeof(xml_size));
+  std::string xml(xml_size, '\0');
+  file_.read(&xml[0], xml_size);
+
+  pugi::xml_document doc;
+  if (!file_.good() || !doc.load_buffer(xml.data(), xml.size()))
+    return false;
+  spill.from_xml(doc.first_child());
+
+  uint64_t words = 0;
+  file_.read((char*)&words, sizeof(words));
+  spill.data.resize(words);
+  if (words)
+    file_.read((char*)spill.data.data(), sizeof(uint32_t) * words);
+
+  return file_.good();
+}
+
+}
@@ -0,0 +1,72 @@
+/*******************************************************************************
+ *
+ * This software was developed at the National Institute of Standards and
+ * Technology (NIST) by employees of the Federal Government in the course
+ * of their official duties. Pursuant to title 17 Section 105 of the
+ * United States Code, this software is not subject to copyright protection
+ * and is in the public domain. NIST assumes no responsibility whatsoever for
+ * its use by other parties, and makes no guarantees, expressed or implied,
+ * about its quality, reliability, or any other characteristic.
+ *
+ * Author(s):
+ *      Martin Shetty (NIST)
+ *
+ * Description:
+ *      Qpx::SpillCaptureWriter, Qpx::SpillCaptureReader - unparsed device
+ *      words and metadata of spills, indexed for replay
+ *
+ *      File layout:
+ *        "QPXCAP01"
+ *        per spill: uint32 xml bytes, spill xml, uint64 word count, words
+ *        on close:  uint64 offset per spill, uint64 spill count, "QPXCAPIX"
+ *      A file without the closing index (crashed run) is indexed by scanning.
+ *
+ ******************************************************************************/
+
+#ifndef QPX_SPILL_CAPTURE_H
+#define QPX_SPILL_CAPTURE_H
+
+#include <fstream>
+#include "spill.h"
+
+namespace Qpx {
+
+class SpillCaptureWriter {
+public:
+  SpillCaptureWriter() {}
+  ~SpillCaptureWriter() { close(); }
+
+  bool open(std::string file_name);
+  bool is_open() const { return file_.is_open(); }
+  void close();
+
+  //hits are not stored, replay goes through the parser again
+  bool write(const Spill &spill);
+
+  size_t spills() const { return offsets_.size(); }
+
+private:
+  std::ofstream file_;
+  std::vector<uint64_t> offsets_;
+};
+
+class SpillCaptureReader {
+public:
+  bool open(std::string file_name);
+  bool is_open() const { return file_.is_open(); }
+  void close();
+
+  size_t size() const { return offsets_.size(); }
+  bool read(size_t index, Spill &spill);
+
+private:
+  std::ifstream file_;
+  std::vector<uint64_t> offsets_;
+
+  bool read_index(uint64_t file_size);
+  void scan(uint64_t file_size);
+};
+
+}
+
+#endif
@@ -26,12 +26,17 @@ template <typename T>
 class SynchronizedQueue
 {
 public:
-  inline SynchronizedQueue() : end_queue_(false) {}
+  //capacity > 0 makes enqueue wait for room, so a slow consumer holds
+  //producers back instead of letting the queue grow
+  inline SynchronizedQueue(size_t capacity = 0) : end_queue_(false), capacity_(capacity) {}
   
   inline void enqueue(const T& data)
   {
     boost::unique_lock<boost::mutex> lock(mutex_);
     
+    while (capacity_ && (queue_.size() >= capacity_) && !end_queue_)
+      space_.wait(lock);
+
     queue_.push(data);
     
     cond_.notify_one();
@@ -49,6 +54,7 @@ public:
     
     T result = queue_.front();
     queue_.pop();
+    space_.notify_one();
     
     return result;
   }
@@ -57,6 +63,7 @@ public:
   {
     end_queue_ = true;
     cond_.notify_all();        
+    space_.notify_all();
   }
 
   inline uint32_t size()
@@ -67,9 +74,11 @@ public:
   
 private:
   bool end_queue_;
+  size_t capacity_;
   std::queue<T> queue_;
   boost::mutex mutex_;
   boost::condition_variable cond_;
+  boost::condition_variable space_;
 };
 
 #endif
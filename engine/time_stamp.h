@@ -66,6 +66,9 @@ public:
   inline double timebase_divider() const
   { return timebase_divider_; }
 
+  inline uint64_t native() const
+  { return time_native_; }
+
   static inline TimeStamp common_timebase(const TimeStamp& a, const TimeStamp& b)
   {
     if (a.timebase_divider_ == b.timebase_divider_)
@@ -0,0 +1,107 @@
+/*******************************************************************************
+ *
+ * This software was developed at the National Institute of Standards and
+ * Technology (NIST) by employees of the Federal Government in the course
+ * of their official duties. Pursuant to title 17 Section 105 of the
+ * United States Code, this software is not subject to copyright protection
+ * and is in the public domain. NIST assumes no responsibility whatsoever for
+ * its use by other parties, and makes no guarantees, expressed or implied,
+ * about its quality, reliability, or any other characteristic.
+ *
+ * Author(s):
+ *      Martin Shetty (NIST)
+ *
+ * Description:
+ *      Qpx::TimeUnwrap - per-channel extension of wrapping hardware clocks
+ *
+ ******************************************************************************/
+
+#include "time_unwrap.h"
+#include <sstream>
+#include <algorithm>
+
+namespace Qpx {
+
+TimeUnwrap::TimeUnwrap(uint16_t bits, uint64_t max_jump, uint64_t max_backstep)
+  : bits_((bits && (bits < 64)) ? bits : 64)
+  , mask_((bits_ < 64) ? ((uint64_t(1) << bits_) - 1) : ~uint64_t(0))
+  , max_jump_(max_jump ? max_jump : ~uint64_t(0))
+  , max_backstep_(max_backstep ? std::min(max_backstep, mask_ >> 1) : (mask_ >> 10))
+{
+  reset();
+}
+
+void TimeUnwrap::reset()
+{
+  channels_.clear();
+  rollovers_ = backsteps_ = jumps_ = reordered_ = 0;
+}
+
+uint64_t TimeUnwrap::unwrap(int16_t c, uint64_t raw)
+{
+  if (c < 0)
+    return raw;
+
+  Channel &ch = channel(c);
+
+  //step modulo counter width, forward unless just short of a full period
+  uint64_t step = (raw - ch.last) & mask_;
+  uint64_t back = (ch.last - raw) & mask_;
+  bool backward = (back != 0) && (back <= max_backstep_);
+
+  //first value on a channel is taken as is
+  uint64_t time = !ch.seen ? (raw & mask_)
+                           : (backward ? (ch.last - back) : (ch.last + step));
+
+  rollovers_ += ch.seen & ((time & ~mask_) != (ch.last & ~mask_));
+  backsteps_ += ch.seen & backward;
+  jumps_     += ch.seen & !backward & (step > max_jump_);
+
+  ch.last = time;
+  ch.seen = 1;
+  return time;
+}
+
+uint64_t TimeUnwrap::last(int16_t c) const
+{
+  if ((c < 0) || (static_cast<size_t>(c) >= channels_.size()))
+    return 0;
+  return channels_[c].last;
+}
+
+bool TimeUnwrap::check(Spill &spill)
+{
+  bool ordered = true;
+  const Hit* previous = nullptr;
+  for (auto &h : spill.hits) {
+    ordered &= !previous || !(h.timestamp() < previous->timestamp());
+    previous = &h;
+
+    int16_t c = h.source_channel();
+    if (c < 0)
+      continue;
+    Channel &ch = channel(c);
+    uint64_t time = h.timestamp().native();
+    backsteps_ += ch.seen & (time < ch.last);
+    ch.last = time;
+    ch.seen = 1;
+  }
+
+  if (!ordered) {
+    spill.hits.sort([](const Hit &a, const Hit &b) { return a.timestamp() < b.timestamp(); });
+    reordered_++;
+  }
+  return ordered;
+}
+
+std::string TimeUnwrap::to_string() const
+{
+  std::stringstream ss;
+  ss << rollovers_ << " rollovers, "
+     << backsteps_ << " steps back, "
+     << jumps_ << " jumps, "
+     << reordered_ << " spills reordered";
+  return ss.str();
+}
+
+}
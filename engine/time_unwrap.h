@@ -0,0 +1,86 @@
+/*******************************************************************************
+ *
+ * This software was developed at the National Institute of Standards and
+ * Technology (NIST) by employees of the Federal Government in the course
+ * of their official duties. Pursuant to title 17 Section 105 of the
+ * United States Code, this software is not subject to copyright protection
+ * and is in the public domain. NIST assumes no responsibility whatsoever for
+ * its use by other parties, and makes no guarantees, expressed or implied,
+ * about its quality, reliability, or any other characteristic.
+ *
+ * Author(s):
+ *      Martin Shetty (NIST)
+ *
+ * Description:
+ *      Qpx::TimeUnwrap - per-channel extension of wrapping hardware clocks
+ *      to 64 bits, and monotonicity checks on hit streams
+ *
+ *      Each step is taken modulo the counter width and read as forward,
+ *      so a rollover needs no special case, unless it is within a small
+ *      tolerance of a full period: then it is a step back, not a rollover.
+ *
+ ******************************************************************************/
+
+#ifndef QPX_TIME_UNWRAP_H
+#define QPX_TIME_UNWRAP_H
+
+#include <vector>
+#include <string>
+#include "spill.h"
+
+namespace Qpx {
+
+class TimeUnwrap {
+public:
+  //counter of given width; forward steps over max_jump ticks are counted
+  //as jumps, 0 for no limit; steps back of up to max_backstep ticks are
+  //taken as such, 0 for 1/1024 of the period, anything further back is
+  //a rollover
+  TimeUnwrap(uint16_t bits = 64, uint64_t max_jump = 0, uint64_t max_backstep = 0);
+
+  //raw counter value to native time on channel's continuing clock;
+  //negative channels are passed through
+  uint64_t unwrap(int16_t channel, uint64_t raw);
+
+  //last native time of channel, 0 if not seen
+  uint64_t last(int16_t channel) const;
+
+  //counts per-channel steps back among already extended hits; spill is
+  //sorted if out of order, so merging can take it as one ordered stream.
+  //True if spill was in order.
+  bool check(Spill &spill);
+
+  void reset();
+
+  uint64_t rollovers() const { return rollovers_; }
+  uint64_t backsteps() const { return backsteps_; }
+  uint64_t jumps() const { return jumps_; }
+  uint64_t reordered() const { return reordered_; }
+  bool anomalies() const { return (backsteps_ || jumps_ || reordered_); }
+
+  std::string to_string() const;
+
+private:
+  struct Channel {
+    uint64_t last;
+    uint64_t seen;
+  };
+
+  uint16_t bits_;
+  uint64_t mask_;
+  uint64_t max_jump_;
+  uint64_t max_backstep_;
+  std::vector<Channel> channels_;
+
+  uint64_t rollovers_, backsteps_, jumps_, reordered_;
+
+  inline Channel& channel(int16_t c) {
+    if (static_cast<size_t>(c) >= channels_.size())
+      channels_.resize(c + 1, Channel{0, 0});
+    return channels_[c];
+  }
+};
+
+}
+
+#endif
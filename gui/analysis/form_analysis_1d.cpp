@@ -166,12 +166,12 @@ void FormAnalysis1D::setSpectrum(Project *newset, int64_t idx) {
 
   if (spectrum) {
     fit_data_.clear();
-    fit_data_.setData(spectrum);
+    fit_data_.setData(spectrum->snapshot());
 
     if (spectra_->has_fitter(idx))
       fit_data_ = spectra_->get_fitter(idx);
     else
-      fit_data_.setData(spectrum);
+      fit_data_.setData(spectrum->snapshot());
 
     form_energy_calibration_->newSpectrum();
     form_fwhm_calibration_->newSpectrum();
@@ -191,7 +191,7 @@ void FormAnalysis1D::update_spectrum() {
   if (this->isVisible()) {
     SinkPtr spectrum = spectra_->get_sink(current_spectrum_);
     if (spectrum)
-      fit_data_.setData(spectrum);
+      fit_data_.setData(spectrum->snapshot());
     ui->plotSpectrum->update_spectrum();
   }
 }
@@ -34,6 +34,7 @@
 #include "polylog.h"
 #include "log_inverse.h"
 #include "effit.h"
+#include "optimizer.h"
 
 using namespace Qpx;
 
@@ -180,7 +181,7 @@ void FormEfficiencyCalibration::setSpectrum(int64_t idx) {
       }
 
       fit_data_.clear();
-      fit_data_.setData(spectrum);
+      fit_data_.setData(spectrum->snapshot());
       peak_sets_[idx] = fit_data_;
     }
     ui->doubleScaleFactor->setValue(fit_data_.activity_scale_factor_);
@@ -557,7 +558,7 @@ void FormEfficiencyCalibration::on_pushFit_clicked()
       p.add_coeff(i, -50, 50, 0);
   }
 
-  p.fit_fityk(xx,yy,sigmas);
+  Optimizer::make(fit_data_.settings().optimizer)->fit(p, xx, yy, sigmas);
 
   if (p.coeffs_.size()) {
     new_calibration_.type_ = "Efficiency";
@@ -663,7 +664,7 @@ void FormEfficiencyCalibration::on_pushFit_2_clicked()
       p.add_coeff(i, -50, 50, 0);
   }
 
-  p.fit_fityk(xx,yy,sigmas);
+  Optimizer::make(fit_data_.settings().optimizer)->fit(p, xx, yy, sigmas);
 
   if (p.coeffs_.size()) {
     new_calibration_.type_ = "Efficiency";
@@ -25,6 +25,7 @@
 #include "ui_form_energy_calibration.h"
 #include "fitter.h"
 #include "qt_util.h"
+#include "optimizer.h"
 #include <QSettings>
 
 
@@ -305,16 +306,7 @@ void FormEnergyCalibration::on_pushFit_clicked()
       p.add_coeff(i, -5, 5, 0);
   }
 
-
-  PolyBounded p2 = p;
-
-  p.fit_fityk(x,y,sigmas);
-
-  #ifdef FITTER_CERES_ENABLED
-  p2.fit_ceres(x,y,sigmas);
-  p2 = p;
-  p2.fit_ceres(x,y,sigmas);
-  #endif
+  Optimizer::make(fit_data_.settings().optimizer)->fit(p, x, y, sigmas);
 
   if (p.coeffs_.size()) {
     new_calibration_.type_ = "Energy";
@@ -26,6 +26,7 @@
 #include "fitter.h"
 #include "qt_util.h"
 #include "sqrt_poly.h"
+#include "optimizer.h"
 
 FormFwhmCalibration::FormFwhmCalibration(XMLableDB<Qpx::Detector>& dets, Qpx::Fitter& fit, QWidget *parent) :
   QWidget(parent),
@@ -330,7 +331,7 @@ void FormFwhmCalibration::fit_calibration()
   for (int i=0; i <= ui->spinTerms->value(); ++i)
     p.add_coeff(i, -30, 30, 1);
 
-  p.fit_fityk(xx, yy, yy_sigma);
+  Optimizer::make(fit_data_.settings().optimizer)->fit(p, xx, yy, yy_sigma);
 
   if (p.coeffs_.size()) {
     new_calibration_.type_ = "FWHM";
@@ -25,6 +25,7 @@
 #include "ui_form_gain_calibration.h"
 #include "fitter.h"
 #include "qt_util.h"
+#include "optimizer.h"
 #include <QSettings>
 
 
@@ -214,7 +215,7 @@ void FormGainCalibration::on_pushCalibGain_clicked()
   for (int i=1; i <= ui->spinPolyOrder->value(); ++i)
     p.add_coeff(i, -5, 5, 1);
 
-  p.fit_fityk(x,y,sigmas);
+  Optimizer::make(fit_data2_.settings().optimizer)->fit(p, x, y, sigmas);
 
   if (p.coeffs_.size()) {
     gain_match_cali_.coefficients_ = p.coeffs();
@@ -204,8 +204,8 @@ void FormGatesPlot2D::update_plot() {
   {
     //      DBG << "really really updating 2d total count = " << some_spectrum->total_count();
 
-    std::shared_ptr<EntryList> spectrum_data =
-        std::move(some_spectrum->data_range({{0, adjrange}, {0, adjrange}}));
+    SparseData spectrum_data;
+    some_spectrum->data_sparse({{0, adjrange}, {0, adjrange}}, spectrum_data);
     ui->coincPlot->update_plot(adjrange, adjrange, spectrum_data);
 
     if (bits != newbits)
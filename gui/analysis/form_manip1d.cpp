@@ -308,8 +308,8 @@ void FormManip1D::update_plot() {
       QVector<double> x(pow(2,bits));
       QVector<double> y(pow(2,bits));
 
-      std::shared_ptr<EntryList> spectrum_data =
-          std::move(q.second->data_range({{0, y.size()}}));
+      std::vector<double> spectrum_data;
+      q.second->data_dense({{0, y.size() - 1}}, spectrum_data);
 
       Detector detector = Detector();
       if (!md.detectors.empty())
@@ -319,19 +319,17 @@ void FormManip1D::update_plot() {
       if (temp_calib.bits_ > calib_.bits_)
         calib_ = temp_calib;
 
-      int i = 0;
-      for (auto it : *spectrum_data) {
+      for (size_t i = 0; i < spectrum_data.size(); ++i) {
         double xx = temp_calib.transform(i, bits);
-        double yy = to_double( it.second ) * rescale;
+        double yy = spectrum_data[i] * rescale;
 //        if (ui->pushPerLive->isChecked() && (livetime > 0))
 //          yy = yy / livetime;
-        x[it.first[0]] = xx;
-        y[it.first[0]] = yy;
+        x[i] = xx;
+        y[i] = yy;
         if (!minima.count(xx) || (minima[xx] > yy))
           minima[xx] = yy;
         if (!maxima.count(xx) || (maxima[xx] < yy))
           maxima[xx] = yy;
-        ++i;
       }
 
       AppearanceProfile profile;
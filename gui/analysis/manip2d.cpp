@@ -66,9 +66,16 @@ SinkPtr slice_rectangular(SinkPtr source, std::initializer_list<Pair> bounds, bo
 
   ret->set_detectors(md.detectors);
 
-  std::shared_ptr<EntryList> spectrum_data = std::move(source->data_range(bounds));
-  for (auto it : *spectrum_data)
-    ret->append(it);
+  SparseData spectrum_data;
+  source->data_sparse(bounds, spectrum_data);
+  Entry entry;
+  entry.first.resize(2, 0);
+  for (size_t i = 0; i < spectrum_data.size(); ++i) {
+    entry.first[0] = spectrum_data.coords[2*i];
+    entry.first[1] = spectrum_data.coords[2*i + 1];
+    entry.second = spectrum_data.values[i];
+    ret->append(entry);
+  }
 
   if (ret->metadata().get_attribute("total_events").value_precise > 0)
     return ret;
@@ -221,13 +228,16 @@ SinkPtr make_symmetrized(SinkPtr source)
   boost::random::uniform_real_distribution<> dist(-0.5, 0.5);
 
   size_t e2 = 0;
-  std::unique_ptr<std::list<Entry>> spectrum_data = std::move(source->data_range({{0, adjrange}, {0, adjrange}}));
-  for (auto it : *spectrum_data) {
-    PreciseFloat count = it.second;
-
-    //DBG << "adding " << it.first[0] << "+" << it.first[1] << "  x" << it.second;
-    double xformed = gain_match_cali.transform(it.first[1]);
-    double e1 = it.first[0];
+  SparseData spectrum_data;
+  source->data_sparse({{0, adjrange}, {0, adjrange}}, spectrum_data);
+  Entry it;
+  it.first.resize(2, 0);
+  for (size_t j = 0; j < spectrum_data.size(); ++j) {
+    PreciseFloat count = spectrum_data.values[j];
+
+    //DBG << "adding " << spectrum_data.coords[2*j] << "+" << spectrum_data.coords[2*j+1] << "  x" << count;
+    double xformed = gain_match_cali.transform(spectrum_data.coords[2*j + 1]);
+    double e1 = spectrum_data.coords[2*j];
 
     it.second = 1;
     for (int i=0; i < count; ++i) {
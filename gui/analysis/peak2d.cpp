@@ -41,9 +41,10 @@ void MarkerBox2D::integrate(Qpx::SinkPtr spectrum)
 
   chan_area = (xmax - xmin + 1) * (ymax - ymin + 1);
 
-  std::shared_ptr<Qpx::EntryList> spectrum_data = std::move(spectrum->data_range({{xmin, xmax}, {ymin, ymax}}));
-  for (auto &entry : *spectrum_data)
-    integral += to_double( entry.second );
+  Qpx::SparseData spectrum_data;
+  spectrum->data_sparse({{xmin, xmax}, {ymin, ymax}}, spectrum_data);
+  for (auto &val : spectrum_data.values)
+    integral += val;
 
   variance = integral / pow(chan_area, 2);
 }
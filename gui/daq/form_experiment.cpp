@@ -52,6 +52,7 @@ FormExperiment::FormExperiment(ThreadRunner& runner, QWidget *parent) :
   connect(ui->spectrumSelector, SIGNAL(itemDoubleclicked(SelectorItem)), this, SLOT(spectrumDoubleclicked(SelectorItem)));
 
   connect(&runner_thread_, SIGNAL(runComplete()), this, SLOT(run_completed()));
+  connect(&runner_thread_, SIGNAL(batchFitComplete()), this, SLOT(batch_fit_completed()));
 
   connect(&exp_plot_thread_, SIGNAL(plot_ready()), this, SLOT(new_daq_data()));
 
@@ -99,6 +100,7 @@ void FormExperiment::closeEvent(QCloseEvent *event) {
                                      QMessageBox::Yes|QMessageBox::Cancel);
     if (reply == QMessageBox::Yes) {
       continue_ = false;
+      interruptor_.store(true);
       runner_thread_.terminate();
       runner_thread_.wait();
     } else {
@@ -383,6 +385,7 @@ void FormExperiment::toggle_push(bool enable, Qpx::SourceStatus status) {
   ui->pushNewExperiment->setEnabled(enable && !my_run_ && !empty);
   ui->pushSaveExperiment->setEnabled(enable && !my_run_ && !empty);
   ui->pushLoadExperiment->setEnabled(enable && !my_run_);
+  ui->pushBatchFit->setEnabled(enable && !my_run_ && exp_project_.has_results());
 
   form_experiment_setup_->toggle_push(enable && !my_run_);
   update_name();
@@ -432,6 +435,7 @@ void FormExperiment::fitter_status(bool busy)
   ui->widgetFileOps->setEnabled(!busy);
   form_experiment_setup_->setEnabled(!busy);
   ui->spectrumSelector->setEnabled(!busy);
+  ui->pushBatchFit->setEnabled(!busy && !my_run_);
 }
 
 void FormExperiment::selectProject(int64_t idx)
@@ -690,3 +694,35 @@ void FormExperiment::on_pushExportProject_clicked()
 
   emit extract_project(newproj);
 }
+
+void FormExperiment::on_pushBatchFit_clicked()
+{
+  if (ui->plotSpectrum->busy() || runner_thread_.running())
+    return;
+
+  //refit around currently selected peak, or each point's own selection
+  double energy = std::numeric_limits<double>::quiet_NaN();
+  std::set<double> sel = selected_fitter_.get_selected_peaks();
+  if (sel.size() && selected_fitter_.contains_peak(*sel.begin()))
+    energy = selected_fitter_.peak(*sel.begin()).energy().value();
+
+  ui->pushStop->setEnabled(true);
+  my_run_ = true;
+  continue_ = false;
+  emit toggleIO(false);
+  this->setCursor(Qt::WaitCursor);
+
+  runner_thread_.do_batch_fit(exp_project_, selected_fitter_.settings(), energy, interruptor_);
+}
+
+void FormExperiment::batch_fit_completed()
+{
+  this->setCursor(Qt::ArrowCursor);
+  ui->pushStop->setEnabled(false);
+  my_run_ = false;
+
+  form_experiment_1d_->update_exp_project();
+  form_experiment_2d_->update_exp_project();
+  new_daq_data();
+  emit toggleIO(true);
+}
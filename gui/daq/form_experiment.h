@@ -58,6 +58,7 @@ private slots:
 
   void new_daq_data();
   void run_completed();
+  void batch_fit_completed();
 
   void fitter_status(bool);
   void update_fits();
@@ -82,6 +83,8 @@ private slots:
 
   void on_pushExportProject_clicked();
 
+  void on_pushBatchFit_clicked();
+
 protected:
   void closeEvent(QCloseEvent*);
 
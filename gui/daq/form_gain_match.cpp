@@ -29,6 +29,7 @@
 
 #include "UncertainDouble.h"
 #include "qt_util.h"
+#include "optimizer.h"
 #include "dialog_spectrum.h"
 
 
@@ -433,7 +434,7 @@ void FormGainMatch::do_post_processing() {
   response_function_.add_coeff(1, -50, 50, 1);
   if (gains.size() > 2)
     response_function_.add_coeff(2, -50, 50, 1);
-  response_function_.fit_fityk(gains, positions, position_sigmas);
+  Optimizer::make(fitter_opt_.settings().optimizer)->fit(response_function_, gains, positions, position_sigmas);
   predicted = response_function_.eval_inverse(peak_ref_.center().value() /*, ui->doubleThreshold->value() / 4.0*/);
 
   DBG << "<FormGainMatch> Prediction " << predicted;
@@ -25,6 +25,8 @@
 #include "custom_logger.h"
 #include "qt_util.h"
 #include <QSettings>
+#include <QDir>
+#include <QDateTime>
 
 
 FormListDaq::FormListDaq(ThreadRunner &thread, QWidget *parent) :
@@ -42,7 +44,7 @@ FormListDaq::FormListDaq(ThreadRunner &thread, QWidget *parent) :
 
   loadSettings();
 
-  connect(&runner_thread_, SIGNAL(listComplete(Qpx::ListData)), this, SLOT(list_completed(Qpx::ListData)));
+  connect(&runner_thread_, SIGNAL(listComplete(QString, bool)), this, SLOT(list_completed(QString, bool)));
 
   connect(ui->listSpills, SIGNAL(currentRowChanged(int)), this, SLOT(spillSelectionChanged(int)));
 
@@ -102,6 +104,10 @@ void FormListDaq::loadSettings() {
   settings_.beginGroup("ListDaq");
   ui->timeDuration->set_total_seconds(settings_.value("run_secs", 60).toULongLong());
   settings_.endGroup();
+
+  settings_.beginGroup("Program");
+  data_directory_ = settings_.value("save_directory", QDir::homePath() + "/qpx/data").toString();
+  settings_.endGroup();
 }
 
 void FormListDaq::saveSettings() {
@@ -138,7 +144,7 @@ void FormListDaq::closeEvent(QCloseEvent *event) {
   }
 
 
-  if (!list_data_.empty()) {
+  if (list_reader_.size()) {
     int reply = QMessageBox::warning(this, "Contents present",
                                      "Discard?",
                                      QMessageBox::Yes|QMessageBox::Cancel);
@@ -264,14 +270,14 @@ void FormListDaq::displayStats(int idx)
 
 void FormListDaq::on_pushListStart_clicked()
 {
-  if (!list_data_.empty()) {
+  if (list_reader_.size()) {
     int reply = QMessageBox::warning(this, "Contents present",
                                      "Discard?",
                                      QMessageBox::Yes|QMessageBox::Cancel);
     if (reply != QMessageBox::Yes)
       return;
     my_run_ = true;
-    list_completed(Qpx::ListData());
+    list_completed(QString(), true);
   }
 
   emit statusText("List mode acquisition in progress...");
@@ -287,7 +293,12 @@ void FormListDaq::on_pushListStart_clicked()
   if (duration == 0)
     return;
 
-  runner_thread_.do_list(interruptor_, duration);
+  //one file per run, never truncate an earlier one
+  QDir().mkpath(data_directory_);
+  QString list_file = data_directory_ + "/qpx_list_"
+      + QDateTime::currentDateTime().toString("yyyyMMdd_hhmmss") + ".qls";
+
+  runner_thread_.do_list(interruptor_, duration, list_file);
 }
 
 void FormListDaq::on_pushListStop_clicked()
@@ -297,13 +308,24 @@ void FormListDaq::on_pushListStop_clicked()
   interruptor_.store(true);
 }
 
-void FormListDaq::list_completed(Qpx::ListData newEvents) {
+void FormListDaq::list_completed(QString file_name, bool success) {
   if (my_run_) {
-    list_data_ = newEvents;
+    if (!success)
+      QMessageBox::warning(this, "List mode run failed",
+                           "Could not acquire list mode data to " + file_name);
 
+    list_reader_.close();
     ui->listSpills->clear();
-    for (auto &s : list_data_)
-      ui->listSpills->addItem(QString::fromStdString(s->to_string()));
+
+    if (!file_name.isEmpty() && !list_reader_.open(file_name.toStdString()))
+      WARN << "<FormListDaq> Could not read back list mode run from " << file_name.toStdString();
+
+    for (size_t i=0; i < list_reader_.size(); ++i) {
+      std::string info = list_reader_.spill(i).to_string();
+      if (list_reader_.hit_count(i))
+        info += " [" + std::to_string(list_reader_.hit_count(i)) + "]";
+      ui->listSpills->addItem(QString::fromStdString(info));
+    }
 
     ui->pushListStop->setEnabled(false);
     this->setWindowTitle("List LIVE");
@@ -339,14 +361,12 @@ void FormListDaq::spillSelectionChanged(int row)
 //  ui->labelEventVals->setVisible(false);
 //  ui->tableHitValues->setVisible(false);
 
-  if ((row >= 0) && (row < static_cast<int>(list_data_.size())))
+  if ((row >= 0) && (row < static_cast<int>(list_reader_.size())))
   {
 
     for (int i = 0; i < row; i++)
     {
-      Qpx::SpillPtr sp = list_data_.at(i);
-      if (!sp)
-        continue;
+      const Qpx::Spill *sp = &list_reader_.spill(i);
       if (sp->detectors.size())
         for (size_t di = 0; di < sp->detectors.size(); di++)
         {
@@ -362,21 +382,26 @@ void FormListDaq::spillSelectionChanged(int row)
     }
 
 
-    Qpx::SpillPtr sp = list_data_.at(row);
-    if (sp)
-    {
-      hits_ = std::vector<Qpx::Hit>(sp->hits.begin(), sp->hits.end());
-      stats_ = sp->stats;
-      for (auto &q: sp->detectors)
-        spill_detectors_.add_a(q);
-      det_table_model_.update();
-      attr_model_.update(sp->state);
+    const Qpx::Spill *sp = &list_reader_.spill(row);
+    std::map<int16_t, Qpx::HitModel> models = hitmodels_;
+    for (auto &stats : sp->stats)
+      models[stats.first] = stats.second.model_hit;
+    std::list<Qpx::Hit> hits;
+    if (!list_reader_.read_hits(row, models, hits))
+      WARN << "<FormListDaq> Only " << hits.size() << " of "
+           << list_reader_.hit_count(row) << " hits readable in spill " << row;
+    hits_ = std::vector<Qpx::Hit>(hits.begin(), hits.end());
+    stats_ = sp->stats;
+    for (auto &q: sp->detectors)
+      spill_detectors_.add_a(q);
+    det_table_model_.update();
+    attr_model_.update(sp->state);
 
-      ui->treeAttribs->setVisible(sp->state != Qpx::Setting());
-      ui->labelState->setVisible(sp->state != Qpx::Setting());
+    ui->treeAttribs->setVisible(sp->state != Qpx::Setting());
+    ui->labelState->setVisible(sp->state != Qpx::Setting());
 
-      ui->tableDetectors->setVisible(sp->detectors.size());
-      ui->labelDetectors->setVisible(sp->detectors.size());
+    ui->tableDetectors->setVisible(sp->detectors.size());
+    ui->labelDetectors->setVisible(sp->detectors.size());
 
 //      ui->labelStats->setVisible(stats_.size());
 //      ui->tableStats->setVisible(stats_.size());
@@ -386,7 +411,6 @@ void FormListDaq::spillSelectionChanged(int row)
 //      ui->tableHits->setVisible(hits_.size());
 //      ui->labelEventVals->setVisible(hits_.size());
 //      ui->tableHitValues->setVisible(hits_.size());
-    }
   }
 
 
@@ -25,6 +25,7 @@
 
 #include <QWidget>
 #include "spill.h"
+#include "list_file.h"
 #include "thread_runner.h"
 #include "special_delegate.h"
 #include "widget_detectors.h"
@@ -58,7 +59,7 @@ private slots:
 
   void on_pushListStart_clicked();
   void on_pushListStop_clicked();
-  void list_completed(Qpx::ListData);
+  void list_completed(QString, bool);
 
 protected:
   void closeEvent(QCloseEvent*);
@@ -70,7 +71,9 @@ private:
   boost::atomic<bool> interruptor_;
 
 
-  Qpx::ListData     list_data_;  
+  //run goes to disk as it arrives, spills are read back one at a time
+  QString               data_directory_;
+  Qpx::ListFileReader   list_reader_;
 
 
   std::vector<Qpx::Hit>      hits_;
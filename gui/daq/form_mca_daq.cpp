@@ -232,7 +232,7 @@ void FormMcaDaq::toggle_push(bool enable, SourceStatus status) {
   ui->toggleIndefiniteRun->setEnabled(enable && online);
 
   ui->toolOpen->setEnabled(enable && !my_run_);
-  ui->toolSave->setEnabled(enable && nonempty && !my_run_);
+  ui->toolSave->setEnabled(enable && nonempty);
   ui->pushDetails->setEnabled(enable && nonempty && !my_run_);
 }
 
@@ -264,7 +264,9 @@ void FormMcaDaq::update_plots() {
       name = slist.back();
   }
 
-  if (my_run_)
+  if (project_->saving())
+    name += "  (saving)";
+  else if (my_run_)
     name += QString::fromUtf8("  \u25b6");
   else if (project_->changed())
     name += QString::fromUtf8(" \u2731");
@@ -294,7 +296,11 @@ void FormMcaDaq::update_plots() {
 
 void FormMcaDaq::projectSave()
 {
-  if (project_->changed() && (project_->identity() != "New project")) {
+  if (my_run_ && (project_->identity() != "New project")) {
+    //acquisition keeps sorting while the file is written
+    project_->save_in_background();
+    update_plots();
+  } else if (project_->changed() && (project_->identity() != "New project")) {
     int reply = QMessageBox::warning(this, "Save?",
                                      "Save changes to existing project: " + QString::fromStdString(project_->identity()),
                                      QMessageBox::Yes|QMessageBox::Cancel);
@@ -313,8 +319,12 @@ void FormMcaDaq::projectSaveAs()
                                           data_directory_, "qpx project file (*.qpx)");
   if (validateFile(this, fileName, true)) {
     LINFO << "Writing project to " << fileName.toStdString();
-    this->setCursor(Qt::WaitCursor);
-    project_->save_as(fileName.toStdString());
+    if (my_run_)
+      project_->save_in_background(fileName.toStdString());
+    else {
+      this->setCursor(Qt::WaitCursor);
+      project_->save_as(fileName.toStdString());
+    }
     update_plots();
   }
 
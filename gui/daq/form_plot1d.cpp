@@ -51,6 +51,7 @@ FormPlot1D::FormPlot1D(QWidget *parent) :
 
   connect(ui->mcaPlot, SIGNAL(clickedLeft(double)), this, SLOT(addMovingMarker(double)));
   connect(ui->mcaPlot, SIGNAL(clickedRight(double)), this, SLOT(removeMovingMarker(double)));
+  connect(ui->mcaPlot, SIGNAL(zoomed()), this, SLOT(plotZoomed()), Qt::QueuedConnection);
 
   connect(spectraSelector, SIGNAL(itemSelected(SelectorItem)), this, SLOT(spectrumDetails(SelectorItem)));
   connect(spectraSelector, SIGNAL(itemToggled(SelectorItem)), this, SLOT(spectrumLooksChanged(SelectorItem)));
@@ -169,6 +170,7 @@ void FormPlot1D::spectrumDetails(SelectorItem item)
 }
 
 void FormPlot1D::reset_content() {
+  plotted_.clear();
   moving.visible = false;
   markx.visible = false;
   marky.visible = false;
@@ -189,12 +191,18 @@ void FormPlot1D::update_plot() {
 
   calib_ = Calibration();
 
+  double visible = ui->mcaPlot->visible_fraction();
+  int pixels = ui->mcaPlot->plot_width();
+
   ui->mcaPlot->clearGraphs();
+  std::map<int64_t, PlotCounts> plotted;
   for (auto &q: mySpectra->get_sinks(1)) {
     Metadata md;
+    std::shared_ptr<const Sink> snap;
     if (q.second)
     {
-      md = q.second->metadata();
+      snap = q.second->snapshot();
+      md = snap->metadata();
 //      DBG << "\n" << q.second->debug();
     }
 
@@ -204,11 +212,31 @@ void FormPlot1D::update_plot() {
 
     if (md.get_attribute("visible").value_int) {
 
-      QVector<double> x = QVector<double>::fromStdVector(q.second->axis_values(0));
-      QVector<double> y(x.size());
+      std::vector<double> axis = snap->axis_values(0);
+
+      PlotCounts &pc = plotted[q.first];
+      if (plotted_.count(q.first))
+        pc = std::move(plotted_.at(q.first));
+      if ((pc.sink != q.second) || (pc.counts.size() != axis.size())) {
+        pc.sink = q.second;
+        pc.generation = 0;
+        pc.counts.assign(axis.size(), 0);
+        pc.decimated.invalidate();
+      }
+
+      SparseData changes;
+      pc.generation = snap->changes_since(pc.generation, changes);
+      for (size_t i = 0; i < changes.size(); ++i)
+        if (changes.coords[i] < pc.counts.size())
+          pc.counts[changes.coords[i]] = changes.values[i];
 
-      std::shared_ptr<EntryList> spectrum_data =
-          std::move(q.second->data_range({{0, x.size()}}));
+      //min/max per pixel column, kept until data or zoom changes
+      pc.decimated.update(pc.counts, pc.generation,
+                          MinMaxDecimator::block_for(pc.counts.size() * visible, pixels));
+      const std::vector<size_t> &channels = pc.decimated.channels();
+      const std::vector<double> &spectrum_data = pc.decimated.values();
+      QVector<double> x(channels.size());
+      QVector<double> y(channels.size());
 
       Detector detector = Detector();
       if (!md.detectors.empty())
@@ -218,18 +246,15 @@ void FormPlot1D::update_plot() {
       if (temp_calib.bits_ > calib_.bits_)
         calib_ = temp_calib;
 
-      for (auto it : *spectrum_data) {
+      for (size_t i = 0; i < spectrum_data.size(); ++i) {
 
-        double xx = x[it.first[0]];
+        double xx = axis[channels[i]];
+        x[i] = xx;
 
-//        double xx = it.first[0];
-//        if (xx < x.size())
-//          xx = x[xx];
-
-        double yy = to_double( it.second ) * rescale;
+        double yy = spectrum_data[i] * rescale;
         if (ui->pushPerLive->isChecked() && (livetime > 0))
           yy = yy / livetime;
-        y[it.first[0]] = yy;
+        y[i] = yy;
         if (!minima.count(xx) || (minima[xx] > yy))
           minima[xx] = yy;
         if (!maxima.count(xx) || (maxima[xx] < yy))
@@ -242,6 +267,7 @@ void FormPlot1D::update_plot() {
 
     }
   }
+  plotted_.swap(plotted);
 
   ui->mcaPlot->use_calibrated(calib_.valid());
   ui->mcaPlot->setLabels(QString::fromStdString(calib_.units_), "count");
@@ -258,6 +284,18 @@ void FormPlot1D::update_plot() {
   this->setCursor(Qt::ArrowCursor);
 }
 
+void FormPlot1D::plotZoomed()
+{
+  double visible = ui->mcaPlot->visible_fraction();
+  int pixels = ui->mcaPlot->plot_width();
+  for (auto &p : plotted_)
+    if (p.second.decimated.block() !=
+        MinMaxDecimator::block_for(p.second.counts.size() * visible, pixels)) {
+      update_plot();
+      return;
+    }
+}
+
 void FormPlot1D::on_pushFullInfo_clicked()
 {  
   SinkPtr someSpectrum = mySpectra->get_sink(spectraSelector->selected().data.toLongLong());
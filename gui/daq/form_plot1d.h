@@ -27,6 +27,7 @@
 #include "qsquarecustomplot.h"
 #include "widget_selector.h"
 #include "widget_plot_multi1d.h"
+#include "decimator.h"
 
 namespace Ui {
 class FormPlot1D;
@@ -91,6 +92,7 @@ private slots:
   void on_pushManip1D_clicked();
 
   void effCalRequested(QAction*);
+  void plotZoomed();
 
 private:
 
@@ -103,6 +105,15 @@ private:
   Qpx::Project *mySpectra;
   SelectorWidget *spectraSelector;
 
+  //counts of plotted sinks, patched with changes since generation
+  struct PlotCounts {
+    Qpx::SinkPtr sink;
+    uint64_t generation {0};
+    std::vector<double> counts;
+    MinMaxDecimator decimated;
+  };
+  std::map<int64_t, PlotCounts> plotted_;
+
   Marker1D moving, markx, marky;
   QMenu menuColors;
   QMenu menuDelete;
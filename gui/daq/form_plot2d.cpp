@@ -29,11 +29,14 @@ using namespace Qpx;
 FormPlot2D::FormPlot2D(QWidget *parent) :
   QWidget(parent),
   ui(new Ui::FormPlot2D),
-  current_spectrum_(-1)
+  mySpectra(nullptr),
+  current_spectrum_(-1),
+  generation_(0)
 {
   ui->setupUi(this);
 
   connect(ui->coincPlot, SIGNAL(markers_set(Coord,Coord)), this, SLOT(markers_moved(Coord,Coord)));
+  connect(ui->coincPlot, SIGNAL(viewport_changed()), this, SLOT(viewport_changed()));
 
   ui->spectrumSelector->set_only_one(true);
   connect(ui->spectrumSelector, SIGNAL(itemSelected(SelectorItem)), this, SLOT(choose_spectrum(SelectorItem)));
@@ -108,6 +111,7 @@ void FormPlot2D::setSpectra(Project& new_set) {
   mySpectra = &new_set;
   updateUI();
   current_spectrum_ = ui->spectrumSelector->selected().data.toLongLong();
+  generation_ = 0;
 }
 
 
@@ -119,6 +123,7 @@ void FormPlot2D::reset_content() {
   y_marker = Coord();
   ext_marker = Coord();
   current_spectrum_ = -1;
+  generation_ = 0;
   replot_markers();
 }
 
@@ -130,6 +135,7 @@ void FormPlot2D::choose_spectrum(SelectorItem item)
     return;
 
   current_spectrum_ = itm.data.toLongLong();
+  generation_ = 0;
 
   std::map<int64_t, SinkPtr> spectra = mySpectra->get_sinks(2);
 
@@ -294,11 +300,16 @@ void FormPlot2D::update_plot(bool force) {
     ui->pushDetails->setEnabled(some_spectrum && true);
     zoom_2d = new_zoom;
 
+    //read from published copy so plotting never holds up sorting
+    std::shared_ptr<const Sink> snap;
     Metadata md;
-    if (some_spectrum)
-      md = some_spectrum->metadata();
+    if (some_spectrum) {
+      snap = some_spectrum->snapshot();
+      md = snap->metadata();
+    }
 
     uint16_t newbits = md.get_attribute("resolution").value_int;
+    uint32_t oldrange = adjrange;
 
 //    DBG << "Bits = " << newbits;
 
@@ -312,12 +323,10 @@ void FormPlot2D::update_plot(bool force) {
 
       ui->pushSymmetrize->setEnabled(sym.value_int == 0);
 
-      std::shared_ptr<EntryList> spectrum_data =
-          std::move(some_spectrum->data_range({{0, adjrange}, {0, adjrange}}));
-      ui->coincPlot->update_plot(adjrange, adjrange, spectrum_data);
+      plot_data(snap, rescale2d || force || (oldrange != adjrange));
 
 //      DBG << "adjrange = " << adjrange;
-//      DBG << "spectrum data size = " << spectrum_data->size();
+//      DBG << "spectrum data size = " << spectrum_data.size();
 
       if (rescale2d || force /*|| (name_2d != newname)*/) {
 //        DBG << "rescaling 2d";
@@ -342,6 +351,7 @@ void FormPlot2D::update_plot(bool force) {
     } else {
       ui->coincPlot->reset_content();
       ui->coincPlot->refresh();
+      generation_ = 0;
     }
 
     replot_markers();
@@ -351,6 +361,59 @@ void FormPlot2D::update_plot(bool force) {
   this->setCursor(Qt::ArrowCursor);
 }
 
+void FormPlot2D::plot_data(std::shared_ptr<const Sink> spectrum, bool all) {
+  Pair x, y;
+  ui->coincPlot->visible_window(adjrange, adjrange, x, y);
+  uint16_t level = ui->coincPlot->suggested_level(x, y);
+  if (all || !ui->coincPlot->holds(x, y, level))
+    generation_ = 0;
+
+  if (generation_ && (level == 0)) {
+    //full resolution, only cells changed since last time
+    SparseData changes;
+    generation_ = spectrum->changes_since(generation_, changes);
+    ui->coincPlot->update_cells(changes);
+    return;
+  }
+
+  //window in view plus half its size around it to pan into,
+  //rebinned to screen resolution, refetched when anything changed
+  uint64_t generation = spectrum->generation();
+  if (generation_ && (generation == generation_))
+    return;
+
+  size_t marginx = (x.second - x.first + 1) / 2;
+  size_t marginy = (y.second - y.first + 1) / 2;
+  x = Pair(((x.first > marginx) ? (x.first - marginx) : 0) >> level << level,
+           std::min<size_t>(x.second + marginx, adjrange - 1));
+  y = Pair(((y.first > marginy) ? (y.first - marginy) : 0) >> level << level,
+           std::min<size_t>(y.second + marginy, adjrange - 1));
+
+  std::vector<double> values;
+  if (level)
+    spectrum->data_rebinned(level, {{x.first >> level, x.second >> level},
+                                    {y.first >> level, y.second >> level}}, values);
+  else
+    spectrum->data_dense({x, y}, values);
+  ui->coincPlot->update_window(adjrange, adjrange, x, y, values, level);
+  generation_ = generation;
+}
+
+void FormPlot2D::viewport_changed() {
+  if (!adjrange || (current_spectrum_ < 0) || (mySpectra == nullptr))
+    return;
+  Pair x, y;
+  ui->coincPlot->visible_window(adjrange, adjrange, x, y);
+  if (ui->coincPlot->holds(x, y, ui->coincPlot->suggested_level(x, y)))
+    return;
+
+  SinkPtr some_spectrum = mySpectra->get_sink(current_spectrum_);
+  if (!some_spectrum || (some_spectrum->dimensions() != 2))
+    return;
+
+  plot_data(some_spectrum->snapshot(), true);
+}
+
 void FormPlot2D::markers_moved(Coord x, Coord y) {
   x_marker = x;
   y_marker = y;
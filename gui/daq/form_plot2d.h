@@ -90,6 +90,7 @@ private slots:
   void choose_spectrum(SelectorItem item);
   void crop_changed();
   void spectrumDoubleclicked(SelectorItem item);
+  void viewport_changed();
 
   void on_pushSymmetrize_clicked();
 
@@ -105,6 +106,9 @@ private:
   //plot identity
   double zoom_2d, new_zoom;
   uint32_t adjrange;
+  uint64_t generation_; //of sink data last plotted, 0 to replot all
+
+  void plot_data(std::shared_ptr<const Qpx::Sink> spectrum, bool all);
 
   //markers
   AppearanceProfile my_marker;
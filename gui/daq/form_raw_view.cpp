@@ -31,6 +31,7 @@
 FormRawView::FormRawView(QWidget *parent) :
   QWidget(parent),
   ui(new Ui::FormRawView),
+  chunked_(false),
   spill_detectors_("Detectors"),
   attr_model_(this)
 {
@@ -302,7 +303,15 @@ void FormRawView::spillSelectionChanged(int row)
 
 
     Qpx::Spill& sp = spills_.at(row);
-    if (hit_counts_.at(row) > 0)
+    if (chunked_)
+    {
+      for (auto &stats : sp.stats)
+        hitmodels_[stats.second.source_channel] = stats.second.model_hit;
+      std::list<Qpx::Hit> hits;
+      list_file_.read_hits(row, hitmodels_, hits);
+      hits_.assign(hits.begin(), hits.end());
+    }
+    else if (hit_counts_.at(row) > 0)
     {
       file_bin_.seekg(bin_offsets_.at(row), std::ios::beg);
       for (size_t i = 0; i < hit_counts_.at(row); ++i)
@@ -401,7 +410,7 @@ void FormRawView::stats_selection_changed(QItemSelection, QItemSelection) {
 
 void FormRawView::on_pushLoadExperiment_clicked()
 {
-  QString fileName = QFileDialog::getOpenFileName(this, "Load raw", data_directory_, "qpx raw data (*.xml)");
+  QString fileName = QFileDialog::getOpenFileName(this, "Load raw", data_directory_, "qpx raw data (*.qls *.xml)");
   if (!validateFile(this, fileName, false))
     return;
 
@@ -423,6 +432,24 @@ void FormRawView::on_pushLoadExperiment_clicked()
   ui->listSpills->clear();
   spillSelectionChanged(-1);
 
+  list_file_.close();
+  chunked_ = false;
+  if (Qpx::ListFileReader::is_list_file(fileName.toStdString())) {
+    chunked_ = list_file_.open(fileName.toStdString());
+    for (size_t i=0; chunked_ && (i < list_file_.size()); ++i) {
+      spills_.push_back(list_file_.spill(i));
+      hit_counts_.push_back(list_file_.hit_count(i));
+
+      std::string text = spills_.back().to_string();
+      if (hit_counts_.back() > 0)
+        text += "  [" + std::to_string(hit_counts_.back()) + "]";
+
+      ui->listSpills->addItem(QString::fromStdString(text));
+    }
+    this->setCursor(Qt::ArrowCursor);
+    return;
+  }
+
   pugi::xml_document doc;
 
   if (!doc.load_file(fileName.toStdString().c_str())) {
@@ -25,6 +25,7 @@
 
 #include <QWidget>
 #include "spill.h"
+#include "list_file.h"
 #include "engine.h"
 #include "special_delegate.h"
 #include "widget_detectors.h"
@@ -71,6 +72,8 @@ private:
   std::vector<uint64_t>   bin_offsets_;
   std::ifstream  file_bin_;
   std::streampos bin_begin_, bin_end_;
+  bool                   chunked_;
+  Qpx::ListFileReader    list_file_;
 
 
   std::vector<Qpx::Hit>      hits_;
@@ -98,6 +98,11 @@ FormFitterSettings::FormFitterSettings(FitSettings &fs, QWidget *parent) :
   ui->doubleLateralSlack->setValue(fit_settings_.lateral_slack);
   ui->spinFitterMaxIterations->setValue(fit_settings_.fitter_max_iter);
 
+  for (auto &t : optimizer_types())
+    ui->comboOptimizer->addItem(QString::fromStdString(optimizer_to_string(t)),
+                                QVariant::fromValue(static_cast<int>(t)));
+  ui->comboOptimizer->setCurrentIndex(ui->comboOptimizer->findData(static_cast<int>(fit_settings_.optimizer)));
+
   on_checkOnlySum4_clicked();
   on_checkGaussOnly_clicked();
 }
@@ -167,6 +172,7 @@ void FormFitterSettings::on_buttonBox_accepted()
 
   fit_settings_.lateral_slack = ui->doubleLateralSlack->value();
   fit_settings_.fitter_max_iter = ui->spinFitterMaxIterations->value();
+  fit_settings_.optimizer = static_cast<OptimizerType>(ui->comboOptimizer->currentData().toInt());
 
   accept();
 }
@@ -0,0 +1,91 @@
+/*******************************************************************************
+ *
+ * This software was developed at the National Institute of Standards and
+ * Technology (NIST) by employees of the Federal Government in the course
+ * of their official duties. Pursuant to title 17 Section 105 of the
+ * United States Code, this software is not subject to copyright protection
+ * and is in the public domain. NIST assumes no responsibility whatsoever for
+ * its use by other parties, and makes no guarantees, expressed or implied,
+ * about its quality, reliability, or any other characteristic.
+ *
+ * This software can be redistributed and/or modified freely provided that
+ * any derivative works bear some notice that they are derived from it, and
+ * any modified versions bear some notice that they have been modified.
+ *
+ * Author(s):
+ *      Martin Shetty (NIST)
+ *
+ * Description:
+ *      MinMaxDecimator - reduces a spectrum to the minimum and maximum of
+ *                        each block of channels, for drawing
+ *
+ ******************************************************************************/
+
+#include "decimator.h"
+#include <cmath>
+#include <algorithm>
+
+size_t MinMaxDecimator::block_for(double visible_channels, int pixels)
+{
+  if ((pixels < 1) || (visible_channels <= pixels))
+    return 1;
+  //two points per block, so a block may span two pixel columns
+  return static_cast<size_t>(std::floor(2.0 * visible_channels / pixels));
+}
+
+bool MinMaxDecimator::update(const std::vector<double> &counts, uint64_t generation, size_t block)
+{
+  if (block < 1)
+    block = 1;
+
+  if (valid_ && (generation == generation_) && (block == block_) && (counts.size() == size_))
+    return false;
+
+  channels_.clear();
+  values_.clear();
+
+  if (block < 3) {
+    //nothing to gain
+    channels_.reserve(counts.size());
+    values_ = counts;
+    for (size_t i = 0; i < counts.size(); ++i)
+      channels_.push_back(i);
+  } else {
+    size_t blocks = (counts.size() + block - 1) / block;
+    channels_.reserve(2 * blocks);
+    values_.reserve(2 * blocks);
+    for (size_t start = 0; start < counts.size(); start += block) {
+      size_t end = std::min(start + block, counts.size());
+      size_t imin = start, imax = start;
+      for (size_t i = start + 1; i < end; ++i) {
+        if (counts[i] < counts[imin])
+          imin = i;
+        if (counts[i] > counts[imax])
+          imax = i;
+      }
+      //keep the extremes in channel order so lines connect correctly
+      size_t first = std::min(imin, imax), second = std::max(imin, imax);
+      if ((start == 0) && (first != 0)) {
+        channels_.push_back(0);
+        values_.push_back(counts[0]);
+      }
+      channels_.push_back(first);
+      values_.push_back(counts[first]);
+      if (second != first) {
+        channels_.push_back(second);
+        values_.push_back(counts[second]);
+      }
+    }
+    //full extent of the curve
+    if (channels_.back() != (counts.size() - 1)) {
+      channels_.push_back(counts.size() - 1);
+      values_.push_back(counts.back());
+    }
+  }
+
+  valid_ = true;
+  generation_ = generation;
+  block_ = block;
+  size_ = counts.size();
+  return true;
+}
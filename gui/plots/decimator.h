@@ -0,0 +1,58 @@
+/*******************************************************************************
+ *
+ * This software was developed at the National Institute of Standards and
+ * Technology (NIST) by employees of the Federal Government in the course
+ * of their official duties. Pursuant to title 17 Section 105 of the
+ * United States Code, this software is not subject to copyright protection
+ * and is in the public domain. NIST assumes no responsibility whatsoever for
+ * its use by other parties, and makes no guarantees, expressed or implied,
+ * about its quality, reliability, or any other characteristic.
+ *
+ * This software can be redistributed and/or modified freely provided that
+ * any derivative works bear some notice that they are derived from it, and
+ * any modified versions bear some notice that they have been modified.
+ *
+ * Author(s):
+ *      Martin Shetty (NIST)
+ *
+ * Description:
+ *      MinMaxDecimator - reduces a spectrum to the minimum and maximum of
+ *                        each block of channels, for drawing
+ *
+ ******************************************************************************/
+
+#ifndef MINMAX_DECIMATOR_H
+#define MINMAX_DECIMATOR_H
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+class MinMaxDecimator
+{
+public:
+  //channels per block so that visible channels fit in pixel columns
+  static size_t block_for(double visible_channels, int pixels);
+
+  //recalculates only if generation or block width changed
+  //returns true if points were recalculated
+  bool update(const std::vector<double> &counts, uint64_t generation, size_t block);
+  void invalidate() { valid_ = false; }
+
+  //retained points in channel order
+  const std::vector<size_t> &channels() const { return channels_; }
+  const std::vector<double> &values()   const { return values_; }
+
+  size_t block() const { return block_; }
+
+private:
+  bool valid_ {false};
+  uint64_t generation_ {0};
+  size_t block_ {0};
+  size_t size_ {0};
+
+  std::vector<size_t> channels_;
+  std::vector<double> values_;
+};
+
+#endif
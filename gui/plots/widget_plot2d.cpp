@@ -20,6 +20,7 @@
  ******************************************************************************/
 
 #include "widget_plot2d.h"
+#include <cmath>
 #include "ui_widget_plot2d.h"
 #include "qt_util.h"
 
@@ -41,6 +42,8 @@ WidgetPlot2D::WidgetPlot2D(QWidget *parent) :
   current_scale_type_ = "Logarithmic";
   show_gradient_scale_ = false;
   bits_ = 0;
+  level_ = 0;
+  size_x_ = size_y_ = 0;
   antialiased_ = false;
   show_labels_ = true;
 
@@ -83,6 +86,7 @@ WidgetPlot2D::WidgetPlot2D(QWidget *parent) :
   //connect(ui->coincPlot, SIGNAL(plottableClick(QCPAbstractPlottable*,QMouseEvent*)), this, SLOT(clicked_plottable(QCPAbstractPlottable*)));
   connect(ui->coincPlot, SIGNAL(selectionChangedByUser()), this, SLOT(selection_changed()));
   connect(ui->coincPlot, SIGNAL(clickedAbstractItem(QCPAbstractItem*)), this, SLOT(clicked_item(QCPAbstractItem*)));
+  connect(ui->coincPlot->xAxis, SIGNAL(rangeChanged(QCPRange)), this, SLOT(axis_range_changed(QCPRange)));
 
   menuExportFormat.addAction("png");
   menuExportFormat.addAction("jpg");
@@ -571,7 +575,7 @@ void WidgetPlot2D::replot_markers() {
   ui->coincPlot->replot();
 }
 
-void WidgetPlot2D::update_plot(uint64_t sizex, uint64_t sizey, std::shared_ptr<Qpx::EntryList> spectrum_data) {
+void WidgetPlot2D::update_plot(uint64_t sizex, uint64_t sizey, const Qpx::SparseData &spectrum_data) {
   //  DBG << "updating 2d";
 
 //  ui->coincPlot->clearGraphs();
@@ -588,10 +592,20 @@ void WidgetPlot2D::update_plot(uint64_t sizex, uint64_t sizey, std::shared_ptr<Q
     ui->verticalLayout->setSizeConstraint(QLayout::SetNoConstraint);
   }
 
-  if ((sizex > 0) && (sizey > 0) && (spectrum_data->size())) {
+  if ((sizex > 0) && (sizey > 0) && (spectrum_data.size())) {
     colorMap->data()->setSize(sizex, sizey);
-    for (auto it : *spectrum_data)
-      colorMap->data()->setCell(it.first[0], it.first[1], to_double(it.second));
+    colorMap->data()->fill(0);
+    size_x_ = sizex;
+    size_y_ = sizey;
+    window_x_ = Qpx::Pair(0, sizex - 1);
+    window_y_ = Qpx::Pair(0, sizey - 1);
+    level_ = 0;
+    set_data_range();
+    const size_t *coords = spectrum_data.coords.data();
+    for (auto &val : spectrum_data.values) {
+      colorMap->data()->setCell(coords[0], coords[1], val);
+      coords += 2;
+    }
     colorMap->rescaleDataRange(true);
     ui->coincPlot->updateGeometry();
   } else {
@@ -604,6 +618,120 @@ void WidgetPlot2D::update_plot(uint64_t sizex, uint64_t sizey, std::shared_ptr<Q
   replot_markers();
 }
 
+void WidgetPlot2D::update_window(uint64_t sizex, uint64_t sizey, Qpx::Pair x, Qpx::Pair y,
+                                 const std::vector<double> &values, uint16_t level) {
+  uint64_t cellsx = (x.second >> level) - (x.first >> level) + 1;
+  uint64_t cellsy = (y.second >> level) - (y.first >> level) + 1;
+
+  if (!sizex || !sizey || (x.first > x.second) || (y.first > y.second)
+      || (values.size() != cellsx * cellsy)) {
+    update_plot(sizex, sizey, Qpx::SparseData());
+    return;
+  }
+
+  //layout of window data matches colormap cells
+  colorMap->data()->setSize(cellsx, cellsy);
+  for (size_t j = 0; j < cellsy; ++j)
+    for (size_t i = 0; i < cellsx; ++i)
+      colorMap->data()->setCell(i, j, values[j * cellsx + i]);
+  size_x_ = sizex;
+  size_y_ = sizey;
+  window_x_ = x;
+  window_y_ = y;
+  level_ = level;
+  set_data_range();
+  colorMap->rescaleDataRange(true);
+  ui->coincPlot->updateGeometry();
+
+  replot_markers();
+}
+
+bool WidgetPlot2D::holds(Qpx::Pair x, Qpx::Pair y, uint16_t level) const {
+  return !colorMap->data()->isEmpty() && (level == level_)
+      && (window_x_.first <= x.first) && (x.second <= window_x_.second)
+      && (window_y_.first <= y.first) && (y.second <= window_y_.second);
+}
+
+void WidgetPlot2D::visible_window(uint64_t sizex, uint64_t sizey, Qpx::Pair &x, Qpx::Pair &y) const {
+  x = Qpx::Pair(0, sizex ? sizex - 1 : 0);
+  y = Qpx::Pair(0, sizey ? sizey - 1 : 0);
+  if (colorMap->data()->isEmpty() || !sizex || !sizey)
+    return;
+
+  double x1 = calib_x_.inverse_transform(ui->coincPlot->xAxis->range().lower, bits_);
+  double x2 = calib_x_.inverse_transform(ui->coincPlot->xAxis->range().upper, bits_);
+  double y1 = calib_y_.inverse_transform(ui->coincPlot->yAxis->range().lower, bits_);
+  double y2 = calib_y_.inverse_transform(ui->coincPlot->yAxis->range().upper, bits_);
+  if (!std::isfinite(x1) || !std::isfinite(x2) || !std::isfinite(y1) || !std::isfinite(y2))
+    return;
+
+  auto clamp = [](double lower, double upper, uint64_t size) {
+    double last = size - 1;
+    lower = std::min(std::max(std::floor(lower), 0.0), last);
+    upper = std::min(std::max(std::ceil(upper), lower), last);
+    return Qpx::Pair(lower, upper);
+  };
+  x = clamp(std::min(x1, x2), std::max(x1, x2), sizex);
+  y = clamp(std::min(y1, y2), std::max(y1, y2), sizey);
+}
+
+uint16_t WidgetPlot2D::suggested_level(Qpx::Pair x, Qpx::Pair y) const {
+  uint64_t visiblex = x.second - x.first + 1;
+  uint64_t visibley = y.second - y.first + 1;
+
+  double pixelsx = std::max(ui->coincPlot->axisRect()->width(), 1);
+  double pixelsy = std::max(ui->coincPlot->axisRect()->height(), 1);
+
+  uint16_t level = 0;
+  while (((visiblex / pow(2, level) > pixelsx) || (visibley / pow(2, level) > pixelsy))
+         && ((visiblex >> (level + 1)) > 0) && ((visibley >> (level + 1)) > 0))
+    ++level;
+  return level;
+}
+
+void WidgetPlot2D::axis_range_changed(QCPRange) {
+  emit viewport_changed();
+}
+
+void WidgetPlot2D::set_data_range() {
+  //cell centers in channels of full resolution
+  double width = pow(2, level_);
+  double firstx = (window_x_.first >> level_) * width + (width - 1) / 2.0;
+  double firsty = (window_y_.first >> level_) * width + (width - 1) / 2.0;
+  double lastx = (colorMap->data()->keySize() - 1) * width + firstx;
+  double lasty = (colorMap->data()->valueSize() - 1) * width + firsty;
+  colorMap->data()->setRange(QCPRange(calib_x_.transform(firstx, bits_), calib_x_.transform(lastx, bits_)),
+                             QCPRange(calib_y_.transform(firsty, bits_), calib_y_.transform(lasty, bits_)));
+}
+
+void WidgetPlot2D::rescale_to_matrix() {
+  ui->coincPlot->rescaleAxes();
+  //colormap may hold only a window, show the whole matrix
+  if (!colorMap->data()->isEmpty()
+      && (((window_x_.second - window_x_.first + 1) < size_x_)
+          || ((window_y_.second - window_y_.first + 1) < size_y_))) {
+    ui->coincPlot->xAxis->setRange(calib_x_.transform(-0.5, bits_), calib_x_.transform(size_x_ - 0.5, bits_));
+    ui->coincPlot->yAxis->setRange(calib_y_.transform(-0.5, bits_), calib_y_.transform(size_y_ - 0.5, bits_));
+  }
+}
+
+void WidgetPlot2D::update_cells(const Qpx::SparseData &changes) {
+  if (colorMap->data()->isEmpty() || !changes.size() || level_)
+    return;
+
+  //only cells within plotted window
+  const size_t *coords = changes.coords.data();
+  for (auto &val : changes.values) {
+    if ((window_x_.first <= coords[0]) && (coords[0] <= window_x_.second)
+        && (window_y_.first <= coords[1]) && (coords[1] <= window_y_.second))
+      colorMap->data()->setCell(coords[0] - window_x_.first, coords[1] - window_y_.first, val);
+    coords += 2;
+  }
+  colorMap->rescaleDataRange(true);
+
+  replot_markers();
+}
+
 void WidgetPlot2D::set_axes(Qpx::Calibration cal_x, Qpx::Calibration cal_y, int bits, QString zlabel) {
   Z_label_ = zlabel;
   for (int i=0; i < ui->coincPlot->plotLayout()->elementCount(); i++)
@@ -616,9 +744,8 @@ void WidgetPlot2D::set_axes(Qpx::Calibration cal_x, Qpx::Calibration cal_y, int
 
   colorMap->keyAxis()->setLabel(QString::fromStdString(calib_x_.axis_name()));
   colorMap->valueAxis()->setLabel(QString::fromStdString(calib_y_.axis_name()));
-  colorMap->data()->setRange(QCPRange(calib_x_.transform(0, bits_), calib_x_.transform(colorMap->data()->keySize() - 1, bits_)),
-                             QCPRange(calib_y_.transform(0, bits_), calib_y_.transform(colorMap->data()->valueSize() - 1, bits_)));
-  ui->coincPlot->rescaleAxes();
+  set_data_range();
+  rescale_to_matrix();
 }
 
 
@@ -652,7 +779,7 @@ void WidgetPlot2D::plot_2d_mouse_clicked(double x, double y, QMouseEvent *event,
 void WidgetPlot2D::zoom_out()
 {
   this->setCursor(Qt::WaitCursor);
-  ui->coincPlot->rescaleAxes();
+  rescale_to_matrix();
   ui->coincPlot->replot();
   this->setCursor(Qt::ArrowCursor);
 }
@@ -40,7 +40,22 @@ public:
   explicit WidgetPlot2D(QWidget *parent = 0);
   ~WidgetPlot2D();
 
-  void update_plot(uint64_t sizex, uint64_t sizey, std::shared_ptr<Qpx::EntryList> spectrum_data);
+  void update_plot(uint64_t sizex, uint64_t sizey, const Qpx::SparseData &spectrum_data);
+  void update_cells(const Qpx::SparseData &changes);
+
+  //dense window x*y (full resolution channels, inclusive) of a sizex*sizey matrix,
+  //rebinned by 2^level, dimension 0 varies fastest
+  void update_window(uint64_t sizex, uint64_t sizey, Qpx::Pair x, Qpx::Pair y,
+                     const std::vector<double> &values, uint16_t level);
+
+  //rebinning level of plotted data, and whether it covers window x*y at that level
+  uint16_t level() const { return level_; }
+  bool holds(Qpx::Pair x, Qpx::Pair y, uint16_t level) const;
+
+  //part of a sizex*sizey matrix within axis ranges, in full resolution channels,
+  //and coarsest level showing it at no less than screen resolution
+  void visible_window(uint64_t sizex, uint64_t sizey, Qpx::Pair &x, Qpx::Pair &y) const;
+  uint16_t suggested_level(Qpx::Pair x, Qpx::Pair y) const;
   void set_axes(Qpx::Calibration cal_x, Qpx::Calibration cal_y, int bits, QString zlabel);
   void refresh();
   void replot_markers();
@@ -70,6 +85,7 @@ public slots:
 signals:
   void markers_set(Coord x, Coord y);
   void stuff_selected();
+  void viewport_changed();
 
 private slots:
   //void clicked_plottable(QCPAbstractPlottable*);
@@ -81,6 +97,7 @@ private slots:
   void optionsChanged(QAction*);
   void exportRequested(QAction*);
   void clicked_item(QCPAbstractItem*);
+  void axis_range_changed(QCPRange);
 
 private:
 
@@ -111,6 +128,12 @@ private:
   //scaling
   Qpx::Calibration calib_x_, calib_y_;
   int bits_;
+  uint16_t level_;
+  uint64_t size_x_, size_y_;
+  Qpx::Pair window_x_, window_y_;
+
+  void set_data_range();
+  void rescale_to_matrix();
 
   void build_menu();
   void toggle_gradient_scale();
@@ -317,6 +317,7 @@ void WidgetPlotMulti1D::plot_rezoom() {
   minx_zoom = lowerc;
   maxx_zoom = upperc;
   force_rezoom_ = false;
+  emit zoomed();
 
   calc_y_bounds(lowerc, upperc);
 
@@ -329,6 +330,19 @@ void WidgetPlotMulti1D::plot_rezoom() {
   ui->mcaPlot->yAxis->setRangeUpper(maxy);
 }
 
+double WidgetPlotMulti1D::visible_fraction() const {
+  double full = maxx - minx;
+  if (!(full > 0))
+    return 1.0;
+  double shown = std::min(ui->mcaPlot->xAxis->range().upper, maxx)
+      - std::max(ui->mcaPlot->xAxis->range().lower, minx);
+  return std::max(std::min(shown / full, 1.0), 0.0);
+}
+
+int WidgetPlotMulti1D::plot_width() const {
+  return ui->mcaPlot->axisRect()->width();
+}
+
 void WidgetPlotMulti1D::tight_x() {
   //DBG << "tightning x to " << minx << " " << maxx;
   ui->mcaPlot->xAxis->setRangeLower(minx);
@@ -93,12 +93,17 @@ public:
 
   void use_calibrated(bool);
 
+  //share of full x extent currently shown, and its width in pixels
+  double visible_fraction() const;
+  int plot_width() const;
+
 public slots:
   void zoom_out();
 
 signals:
 
   void clickedLeft(double);
+  void zoomed();
   void clickedRight(double);
 //  void range_moved(double x, double y);
   void markers_selected();
@@ -54,7 +54,6 @@ qpx::qpx(QWidget *parent) :
 {
   qRegisterMetaType<std::vector<Qpx::Hit>>("std::vector<Qpx::Hit>");
   qRegisterMetaType<std::vector<Qpx::Detector>>("std::vector<Qpx::Detector>");
-  qRegisterMetaType<Qpx::ListData>("Qpx::ListData");
   qRegisterMetaType<Qpx::Setting>("Qpx::Setting");
   qRegisterMetaType<Qpx::TrajectoryNode>("Qpx::TrajectoryNode");
   qRegisterMetaType<Qpx::Calibration>("Qpx::Calibration");
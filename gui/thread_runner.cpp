@@ -34,6 +34,8 @@ ThreadRunner::ThreadRunner(QObject *parent) :
 {
   spectra_ = nullptr;
   interruptor_ = nullptr;
+  exp_project_ = nullptr;
+  target_energy_ = 0;
   action_ = kNone;
   flag_ = false;
   match_conditions_ = Qpx::Match::id;
@@ -68,7 +70,7 @@ void ThreadRunner::set_idle_refresh_frequency(int secs) {
 }
 
 
-void ThreadRunner::do_list(boost::atomic<bool> &interruptor, uint64_t timeout)
+void ThreadRunner::do_list(boost::atomic<bool> &interruptor, uint64_t timeout, QString file_name)
 {
   if (running_.load()) {
     WARN << "Runner busy";
@@ -78,6 +80,7 @@ void ThreadRunner::do_list(boost::atomic<bool> &interruptor, uint64_t timeout)
   terminating_.store(false);
   interruptor_ = &interruptor;
   timeout_ = timeout;
+  list_file_ = file_name;
   action_ = kList;
   if (!isRunning())
     start(HighPriority);
@@ -100,6 +103,24 @@ void ThreadRunner::do_run(Qpx::ProjectPtr spectra, boost::atomic<bool> &interrup
     start(HighPriority);
 }
 
+void ThreadRunner::do_batch_fit(Qpx::ExperimentProject &project, FitSettings settings,
+                                double target_energy, boost::atomic<bool> &interruptor)
+{
+  if (running_.load()) {
+    WARN << "Runner busy";
+    return;
+  }
+  QMutexLocker locker(&mutex_);
+  terminating_.store(false);
+  exp_project_ = &project;
+  fit_settings_ = settings;
+  target_energy_ = target_energy;
+  interruptor_ = &interruptor;
+  action_ = kBatchFit;
+  if (!isRunning())
+    start(HighPriority);
+}
+
 void ThreadRunner::do_initialize() {
   if (running_.load()) {
     WARN << "Runner busy";
@@ -246,9 +267,14 @@ void ThreadRunner::run()
     } else if (action_ == kList) {
       interruptor_->store(false);
       Qpx::SourceStatus ds = engine_.status() ^ Qpx::SourceStatus::can_run; //turn off can_run
-      Qpx::ListData newListRun = engine_.getList(timeout_, *interruptor_);
+      bool success = engine_.getList(timeout_, *interruptor_, list_file_.toStdString());
       action_ = kSettingsRefresh;
-      emit listComplete(newListRun);
+      emit listComplete(list_file_, success);
+    } else if (action_ == kBatchFit) {
+      interruptor_->store(false);
+      exp_project_->batch_fit(fit_settings_, target_energy_, *interruptor_);
+      action_ = kNone;
+      emit batchFitComplete();
     } else if (action_ == kInitialize) {
       QSettings settings;
       settings.beginGroup("Program");
@@ -33,9 +33,10 @@
 
 #include "engine.h"
 #include "project.h"
+#include "experiment.h"
 
 enum RunnerAction {kBoot, kShutdown, kPushSettings, kSetSetting, kSetDetector, kSetDetectors,
-    kList, kMCA, kOscil, kInitialize, kSettingsRefresh, kOptimize, kTerminate, kNone
+    kList, kMCA, kOscil, kInitialize, kSettingsRefresh, kOptimize, kBatchFit, kTerminate, kNone
 };
 
 class ThreadRunner : public QThread
@@ -57,8 +58,10 @@ public:
     void do_set_detector(int, Qpx::Detector);
     void do_set_detectors(std::map<int, Qpx::Detector>);
 
-    void do_list(boost::atomic<bool>&, uint64_t timeout);
+    void do_list(boost::atomic<bool>&, uint64_t timeout, QString file_name);
     void do_run(Qpx::ProjectPtr, boost::atomic<bool>&, uint64_t timeout);
+    void do_batch_fit(Qpx::ExperimentProject&, FitSettings, double target_energy,
+                      boost::atomic<bool>&);
 
     void do_optimize();
     void do_oscil();
@@ -70,7 +73,8 @@ public:
 signals:
     void bootComplete();
     void runComplete();
-    void listComplete(Qpx::ListData);
+    void listComplete(QString, bool);
+    void batchFitComplete();
     void settingsUpdated(Qpx::Setting, std::vector<Qpx::Detector>, Qpx::SourceStatus);
     void oscilReadOut(std::vector<Qpx::Hit>);
 
@@ -91,6 +95,11 @@ private:
     boost::atomic<bool> terminating_;
 
     uint64_t timeout_;
+    QString list_file_;
+
+    Qpx::ExperimentProject* exp_project_;
+    FitSettings fit_settings_;
+    double target_energy_;
 
     std::map<int, Qpx::Detector> detectors_;
     Qpx::Detector det_;
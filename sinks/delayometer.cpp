@@ -87,30 +87,15 @@ PreciseFloat Delayometer::_data(std::initializer_list<uint16_t> list) const {
     return 0;
 }
 
-std::unique_ptr<std::list<Entry>> Delayometer::_data_range(std::initializer_list<Pair> list) {
-//  int min, max;
-//  if (list.size() != 1) {
-//    min = 0;
-//    max = spectrum_.size();
-//  } else {
-//    Pair range = *list.begin();
-//    min = range.first;
-//    max = range.second;
-//  }
-
-//  //in range?
-  
-  std::unique_ptr<std::list<Entry>> result(new std::list<Entry>);
-  int i = 0;
+void Delayometer::_data_sparse(std::initializer_list<Pair> list, SparseData &data) const {
+  //coordinates are ordinals of recorded delays
+  Pair range = *list.begin();
+  size_t i = 0;
   for (auto &q : spectrum_) {
-    Entry newentry;
-    newentry.first.resize(1, 0);
-    newentry.first[0] = i;
-    newentry.second = q.second;
-    result->push_back(newentry);
+    if ((range.first <= i) && (i <= range.second))
+      data.add(i, to_double(q.second));
     i++;
   }
-  return result;
 }
 
 void Delayometer::_append(const Entry& e) {
@@ -121,6 +106,49 @@ void Delayometer::_append(const Entry& e) {
 //    }
 }
 
+//delay in native units of one timebase to nearest native unit of another
+static int64_t rebase(int64_t native, const TimeStamp &from, const TimeStamp &to)
+{
+  return std::llround(native * from.timebase_multiplier() / from.timebase_divider()
+                      * to.timebase_divider() / to.timebase_multiplier());
+}
+
+bool Delayometer::_merge(const Sink &other, bool same_run)
+{
+  const Delayometer *o = dynamic_cast<const Delayometer*>(&other);
+  if (!o || !merge_common(*o, same_run))
+    return false;
+
+  if (o->spectrum_.empty())
+    return true;
+
+  //bins of both go onto the finer of the two timebases
+  TimeStamp base = spectrum_.empty() ? o->timebase
+                                     : TimeStamp::common_timebase(timebase, o->timebase);
+  if (!base.same_base(timebase)) {
+    std::map<int64_t, PreciseFloat> ours;
+    ours.swap(spectrum_);
+    for (auto &q : ours)
+      spectrum_[rebase(q.first, timebase, base)] += q.second;
+  }
+  for (auto &q : o->spectrum_)
+    spectrum_[rebase(q.first, o->timebase, base)] += q.second;
+  timebase = base;
+
+  ns_.clear();
+  for (auto &q : spectrum_) {
+    ns_[q.first] = q.first * timebase.timebase_multiplier() / timebase.timebase_divider();
+    if (q.first > maxchan_)
+      maxchan_ = q.first;
+  }
+
+  axes_.resize(1);
+  axes_[0].clear();
+  for (auto &q : ns_)
+    axes_[0].push_back(static_cast<double>(q.second));
+  return true;
+}
+
 void Delayometer::_push_hit(const Hit& newhit)
 {
   if ((newhit.source_channel() < 0)
@@ -148,7 +176,7 @@ void Delayometer::_push_hit(const Hit& newhit)
     if (q.in_window(newhit)) {
       Event copy = q;
       if (copy.addHit(newhit)) {
-        if (validateEvent(copy)) {
+        if (validateEvent(copy) && in_sort_window(copy)) {
           recent_count_++;
           total_events_++;
           this->addEvent(copy);
@@ -39,12 +39,14 @@ protected:
   bool _initialize() override;
 
   PreciseFloat _data(std::initializer_list<uint16_t> list) const;
-  std::unique_ptr<std::list<Entry>> _data_range(std::initializer_list<Pair> list);
+  void _data_sparse(std::initializer_list<Pair> list, SparseData &data) const override;
   void _append(const Entry&) override;
+  bool _merge(const Sink&, bool same_run) override;
   void _set_detectors(const std::vector<Qpx::Detector>& dets) override;
 
   //event processing
   void _push_hit(const Hit&) override;
+  void drain_backlog() override { backlog.clear(); } //counted as hits arrive
 
   void addEvent(const Event&) override;
 
@@ -0,0 +1,94 @@
+/*******************************************************************************
+ *
+ * This software was developed at the National Institute of Standards and
+ * Technology (NIST) by employees of the Federal Government in the course
+ * of their official duties. Pursuant to title 17 Section 105 of the
+ * United States Code, this software is not subject to copyright protection
+ * and is in the public domain. NIST assumes no responsibility whatsoever for
+ * its use by other parties, and makes no guarantees, expressed or implied,
+ * about its quality, reliability, or any other characteristic.
+ *
+ * This software can be redistributed and/or modified freely provided that
+ * any derivative works bear some notice that they are derived from it, and
+ * any modified versions bear some notice that they have been modified.
+ *
+ * Author(s):
+ *      Martin Shetty (NIST)
+ *
+ * Description:
+ *      Qpx::RawCapture to store unparsed device buffers for replay
+ *
+ ******************************************************************************/
+
+#include "raw_capture.h"
+#include "daq_sink_factory.h"
+
+namespace Qpx {
+
+static SinkRegistrar<RawCapture> registrar("RawCapture");
+
+RawCapture::RawCapture()
+  : raw_words_(0)
+{
+  Setting base_options = metadata_.attributes();
+  metadata_ = Metadata("RawCapture", "Unparsed device buffers and stats to file, for replay through the device parser. Please provide path for valid and accessible directory", 0,
+                    {}, {});
+
+  Qpx::Setting file_setting;
+  file_setting.id_ = "file_dir";
+  file_setting.metadata.setting_type = Qpx::SettingType::dir_path;
+  file_setting.metadata.writable = true;
+  file_setting.metadata.flags.insert("preset");
+  file_setting.metadata.description = "path to temp output directory";
+  base_options.branches.add(file_setting);
+
+  metadata_.overwrite_all_attributes(base_options);
+}
+
+RawCapture::~RawCapture()
+{
+  _flush();
+}
+
+bool RawCapture::_initialize() {
+  Spectrum::_initialize();
+
+  file_dir_ = metadata_.get_attribute("file_dir").value_text;
+  if (file_dir_.empty())
+    return false;
+
+  file_name_ = file_dir_ + "/qpx_raw.cap";
+  writer_ = std::make_shared<SpillCaptureWriter>();
+  if (!writer_->open(file_name_)) {
+    writer_.reset();
+    return false;
+  }
+  raw_words_ = 0;
+  return true;
+}
+
+void RawCapture::_push_spill(const Spill& one_spill) {
+  if (!writer_)
+    return;
+
+  //stats still go through for live/real time
+  Spectrum::_push_spill(one_spill);
+
+  if (writer_->write(one_spill))
+    raw_words_ += one_spill.data.size();
+  else
+    writer_.reset();
+}
+
+void RawCapture::_flush() {
+  Spectrum::_flush();
+
+  if (writer_) {
+    DBG << "<RawCapture:" << metadata_.get_attribute("name").value_text << "> closing " << file_name_
+        << " with " << writer_->spills() << " spills, " << raw_words_ << " raw words";
+    writer_->close();
+    writer_.reset();
+  }
+}
+
+}
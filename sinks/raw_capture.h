@@ -0,0 +1,75 @@
+/*******************************************************************************
+ *
+ * This software was developed at the National Institute of Standards and
+ * Technology (NIST) by employees of the Federal Government in the course
+ * of their official duties. Pursuant to title 17 Section 105 of the
+ * United States Code, this software is not subject to copyright protection
+ * and is in the public domain. NIST assumes no responsibility whatsoever for
+ * its use by other parties, and makes no guarantees, expressed or implied,
+ * about its quality, reliability, or any other characteristic.
+ *
+ * This software can be redistributed and/or modified freely provided that
+ * any derivative works bear some notice that they are derived from it, and
+ * any modified versions bear some notice that they have been modified.
+ *
+ * Author(s):
+ *      Martin Shetty (NIST)
+ *
+ * Description:
+ *      Qpx::RawCapture to store unparsed device buffers for replay
+ *
+ ******************************************************************************/
+
+#ifndef RAW_CAPTURE_H
+#define RAW_CAPTURE_H
+
+#include "spectrum.h"
+#include "spill_capture.h"
+
+namespace Qpx {
+
+class RawCapture : public Spectrum
+{
+protected:
+  std::string file_dir_;
+  std::string file_name_;
+  std::shared_ptr<SpillCaptureWriter> writer_;
+
+  uint64_t raw_words_;
+
+public:
+  RawCapture();
+  RawCapture(const RawCapture&other)
+    : Spectrum(other)
+    , file_dir_(other.file_dir_)
+    , file_name_(other.file_name_)
+    , raw_words_(other.raw_words_)
+  {}
+
+  RawCapture* clone() const override { return new RawCapture(*this); }
+
+  ~RawCapture();
+
+protected:
+  std::string my_type() const override {return "RawCapture";}
+
+  bool _initialize() override;
+
+  PreciseFloat _data(std::initializer_list<size_t> list) const override
+    { return Sink::_data(list);}
+
+  //event processing
+  void _push_spill(const Spill&) override;
+  bool _set_sort_window(double, double) override {return false;} //one file, in acquisition order
+  void _push_hit(const Hit&) override {}
+
+  void addEvent(const Event&) override {}
+  void _flush() override;
+
+  std::string _data_to_xml() const override {return "written to file";}
+  uint16_t _data_from_xml(const std::string&) override {return 0;}
+};
+
+}
+
+#endif
@@ -22,6 +22,8 @@
  *
  ******************************************************************************/
 
+#include <limits>
+#include <cmath>
 #include "spectrum.h"
 #include "custom_logger.h"
 
@@ -32,7 +34,11 @@ Spectrum::Spectrum()
   , recent_count_(0)
   , coinc_window_(0)
   , max_delay_(0)
+  , sort_from_ns_(-std::numeric_limits<double>::infinity())
+  , sort_to_ns_(std::numeric_limits<double>::infinity())
   , bits_(0)
+  , stats_pending_(false)
+  , instant_rate_(0)
 {
   Setting attributes = metadata_.attributes();
 
@@ -209,6 +215,12 @@ bool Spectrum::_initialize() {
   max_delay_ += coinc_window_;
   //   DBG << "<" << metadata_.name << "> coinc " << coinc_window_ << " max delay " << max_delay_;
 
+  stats_pending_ = false;
+  start_time_ = metadata_.get_attribute("start_time").value_time;
+  live_time_ = metadata_.get_attribute("live_time").value_duration;
+  real_time_ = metadata_.get_attribute("real_time").value_duration;
+  instant_rate_ = metadata_.get_attribute("instant_rate").value_dbl;
+
   return false; //still too abstract
 }
 
@@ -270,7 +282,7 @@ void Spectrum::_push_hit(const Hit& newhit)
   Event evt;
   while (!backlog.empty() && (evt = backlog.front()).past_due(hit)) {
     backlog.pop_front();
-    if (validateEvent(evt)) {
+    if (validateEvent(evt) && in_sort_window(evt)) {
       recent_count_++;
       total_events_++;
       this->addEvent(evt);
@@ -307,11 +319,8 @@ void Spectrum::_push_stats(const StatsUpdate& newBlock) {
   if (newBlock.model_hit.name_to_idx.count("energy"))
     energy_idx_[newBlock.source_channel] = newBlock.model_hit.name_to_idx.at("energy");
 
-  Setting start_time = metadata_.get_attribute("start_time");
-  if (new_start && start_time.value_time.is_not_a_date_time()) {
-    start_time.value_time = newBlock.lab_time;
-    metadata_.set_attribute(start_time);
-  }
+  if (new_start && start_time_.is_not_a_date_time())
+    start_time_ = newBlock.lab_time;
 
   if (!chan_new
       && new_start
@@ -325,12 +334,10 @@ void Spectrum::_push_stats(const StatsUpdate& newBlock) {
 
   recent_end_ = newBlock;
 
-  Setting rate = metadata_.get_attribute("instant_rate");
-  rate.value_dbl = 0;
+  instant_rate_ = 0;
   double recent_time = (recent_end_.lab_time - recent_start_.lab_time).total_milliseconds() * 0.001;
   if (recent_time > 0)
-    rate.value_dbl = recent_count_ / recent_time;
-  metadata_.set_attribute(rate);
+    instant_rate_ = recent_count_ / recent_time;
 
   recent_count_ = 0;
 
@@ -372,20 +379,14 @@ void Spectrum::_push_stats(const StatsUpdate& newBlock) {
     real_times_[newBlock.source_channel] = real;
     live_times_[newBlock.source_channel] = live;
 
-    Setting live_time = metadata_.get_attribute("live_time");
-    Setting real_time = metadata_.get_attribute("real_time");
-
-    live_time.value_duration = real_time.value_duration = real;
+    live_time_ = real_time_ = real;
     for (auto &q : real_times_)
-      if (q.second.total_milliseconds() < real_time.value_duration.total_milliseconds())
-        real_time.value_duration = q.second;
+      if (q.second.total_milliseconds() < real_time_.total_milliseconds())
+        real_time_ = q.second;
 
     for (auto &q : live_times_)
-      if (q.second.total_milliseconds() < live_time.value_duration.total_milliseconds())
-        live_time.value_duration = q.second;
-
-    metadata_.set_attribute(live_time);
-    metadata_.set_attribute(real_time);
+      if (q.second.total_milliseconds() < live_time_.total_milliseconds())
+        live_time_ = q.second;
 
     //      DBG << "<Spectrum> \"" << metadata_.name << "\"  ********* "
     //             << "RT = " << to_simple_string(metadata_.real_time)
@@ -393,18 +394,47 @@ void Spectrum::_push_stats(const StatsUpdate& newBlock) {
 
   }
 
-  Setting res = metadata_.get_attribute("total_hits");
+  stats_pending_ = true;
+}
+
+void Spectrum::_export_attributes(Metadata &md) const
+{
+  if (!stats_pending_)
+    return;
+
+  Setting start_time = md.get_attribute("start_time");
+  start_time.value_time = start_time_;
+  md.set_attribute(start_time);
+
+  Setting rate = md.get_attribute("instant_rate");
+  rate.value_dbl = instant_rate_;
+  md.set_attribute(rate);
+
+  Setting live_time = md.get_attribute("live_time");
+  live_time.value_duration = live_time_;
+  md.set_attribute(live_time);
+
+  Setting real_time = md.get_attribute("real_time");
+  real_time.value_duration = real_time_;
+  md.set_attribute(real_time);
+
+  Setting res = md.get_attribute("total_hits");
   res.value_precise = total_hits_;
-  metadata_.set_attribute(res);
+  md.set_attribute(res);
 
-  Setting res2 = metadata_.get_attribute("total_events");
+  Setting res2 = md.get_attribute("total_events");
   res2.value_precise = total_events_;
-  metadata_.set_attribute(res2);
+  md.set_attribute(res2);
 }
 
-
 void Spectrum::_flush()
 {
+  if (std::isfinite(sort_to_ns_))
+    drain_backlog();
+
+  _export_attributes(metadata_);
+  stats_pending_ = false;
+
   Setting res = metadata_.get_attribute("total_hits");
   res.value_precise = total_hits_;
   metadata_.set_attribute(res);
@@ -414,6 +444,52 @@ void Spectrum::_flush()
   metadata_.set_attribute(res2);
 }
 
+void Spectrum::drain_backlog()
+{
+  //hits past the slice were read to cover these, so they are complete
+  while (!backlog.empty()) {
+    Event evt = backlog.front();
+    backlog.pop_front();
+    if (validateEvent(evt) && in_sort_window(evt)) {
+      recent_count_++;
+      total_events_++;
+      this->addEvent(evt);
+    }
+  }
+}
+
+bool Spectrum::merge_common(const Spectrum &other, bool same_run)
+{
+  if (other.bits_ != bits_)
+    return false;
+
+  total_hits_ += other.total_hits_;
+  total_events_ += other.total_events_;
+
+  //slices of one run share its clock, separate runs add up
+  if (!same_run) {
+    live_time_ += other.live_time_;
+    real_time_ += other.real_time_;
+    for (auto &t : other.real_times_)
+      real_times_[t.first] += t.second;
+    for (auto &t : other.live_times_)
+      live_times_[t.first] += t.second;
+    if (!other.start_time_.is_not_a_date_time()
+        && (start_time_.is_not_a_date_time() || (other.start_time_ < start_time_)))
+      start_time_ = other.start_time_;
+  }
+
+  stats_pending_ = true;
+  return true;
+}
+
+bool Spectrum::_set_sort_window(double from_ns, double to_ns)
+{
+  sort_from_ns_ = from_ns;
+  sort_to_ns_ = to_ns;
+  return true;
+}
+
 void Spectrum::_set_detectors(const std::vector<Qpx::Detector>& dets) {
   //private; no lock required
   //  DBG << "<Spectrum> _set_detectors";
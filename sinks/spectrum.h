@@ -49,15 +49,33 @@ protected:
   void _set_detectors(const std::vector<Qpx::Detector>& dets) override;
   void _recalc_axes() override;
 
+  void _export_attributes(Metadata&) const override;
+
+  bool _set_sort_window(double from_ns, double to_ns) override;
+  double _sort_margin() const override {return max_delay_;}
+
   virtual bool validateEvent(const Event&) const;
+  //events of a slice still waiting for a later hit, which is in next slice
+  virtual void drain_backlog();
+
+  //event belongs to this sink's slice of an offline sort
+  inline bool in_sort_window(const Event &evt) const
+  {
+    double t = evt.lower_time.to_nanosec();
+    return (t >= sort_from_ns_) && (t < sort_to_ns_);
+  }
   virtual void addEvent(const Event&) = 0;
 
+  //totals and stats of other, for _merge of derived types; false if resolution differs
+  bool merge_common(const Spectrum &other, bool same_run);
+
 protected:
   std::vector<int32_t> cutoff_logic_;
   std::vector<double>  delay_ns_;
 
   double max_delay_;
   double coinc_window_;
+  double sort_from_ns_, sort_to_ns_;
 
   std::map<int, std::list<StatsUpdate>> stats_list_;
   std::map<int, boost::posix_time::time_duration> real_times_;
@@ -74,6 +92,12 @@ protected:
 
   PreciseFloat total_hits_;
   PreciseFloat total_events_;
+
+  //hot counters updated with every stats block, ahead of metadata while stats_pending_
+  bool stats_pending_;
+  boost::posix_time::ptime start_time_;
+  boost::posix_time::time_duration live_time_, real_time_;
+  double instant_rate_;
 };
 
 }
@@ -22,6 +22,7 @@
 
 
 #include <fstream>
+#include <typeinfo>
 #include <boost/algorithm/string.hpp>
 #include "spectrum1D.h"
 #include "daq_sink_factory.h"
@@ -91,6 +92,7 @@ bool Spectrum1D::_initialize()
   cutoff_bin_ = metadata_.get_attribute("cutoff_bin").value_int;
 
   spectrum_.resize(pow(2, bits_), 0);
+  changes_.resize(spectrum_.size(), 1, 6);
 
   return true;
 }
@@ -106,37 +108,61 @@ PreciseFloat Spectrum1D::_data(std::initializer_list<size_t> list) const {
     return spectrum_[chan];
 }
 
-std::unique_ptr<std::list<Entry>> Spectrum1D::_data_range(std::initializer_list<Pair> list) {
-  size_t min, max;
-  if (list.size() != 1) {
-    min = 0;
-    max = pow(2, bits_);
-  } else {
-    Pair range = *list.begin();
-    min = range.first;
-    max = range.second;
-  }
+void Spectrum1D::_data_sparse(std::initializer_list<Pair> list, SparseData &data) const {
+  if (spectrum_.empty())
+    return;
 
-  if (max >= spectrum_.size())
-    max = spectrum_.size() - 1;
+  Pair range = *list.begin();
+  size_t min = range.first;
+  size_t max = std::min(range.second, spectrum_.size() - 1);
 
   //in range?
-  
-  std::unique_ptr<std::list<Entry>> result(new std::list<Entry>);
-  for (size_t i=min; i <= max; i++) {
-    Entry newentry;
-    newentry.first.resize(1, 0);
-    newentry.first[0] = i;
-    newentry.second = spectrum_[i];
-    result->push_back(newentry);
-  }
-  return result;
+
+  data.coords.reserve(data.coords.size() + max - min + 1);
+  data.values.reserve(data.values.size() + max - min + 1);
+  for (size_t i=min; i <= max; i++)
+    data.add(i, to_double(spectrum_[i]));
+}
+
+void Spectrum1D::_changes_since(uint64_t generation, SparseData &changes) const {
+  for (auto &tile : changes_.dirty_since(generation))
+    for (size_t i = tile.min0; (i <= tile.max0) && (i < spectrum_.size()); i++)
+      changes.add(i, to_double(spectrum_[i]));
+}
+
+Spectrum1D::Spectrum1D(const Spectrum1D& other, std::vector<PreciseFloat>&& counts)
+  : Spectrum(other)
+  , spectrum_(std::move(counts))
+  , monitors_(other.monitors_)
+  , cutoff_bin_(other.cutoff_bin_)
+  , maxchan_(other.maxchan_)
+{}
+
+Sink* Spectrum1D::_clone_onto(Sink& older, uint64_t since) const {
+  Spectrum1D *o = dynamic_cast<Spectrum1D*>(&older);
+  if (!o || (typeid(*o) != typeid(*this)) || (o->spectrum_.size() != spectrum_.size()))
+    return nullptr;
+
+  Spectrum1D *ret = clone_with(std::move(o->spectrum_));
+  for (auto &tile : changes_.dirty_since(since))
+    for (size_t i = tile.min0; (i <= tile.max0) && (i < spectrum_.size()); i++)
+      ret->spectrum_[i] = spectrum_[i];
+  return ret;
+}
+
+void Spectrum1D::_data_dense(std::initializer_list<Pair> list, std::vector<double> &values) const {
+  Pair range = *list.begin();
+  for (size_t i=range.first; (i <= range.second) && (i < spectrum_.size()); i++)
+    values[i - range.first] = to_double(spectrum_[i]);
 }
 
 void Spectrum1D::_append(const Entry& e) {
   for (size_t i = 0; i < e.first.size(); ++i)
     if (pattern_add_.relevant(i) && (e.first[i] < spectrum_.size())) {
       spectrum_[e.first[i]] += e.second;
+      changes_.touch(e.first[i]);
+      for (auto &m : monitors_)
+        m.add(e.first[i], static_cast<double>(e.second));
 //      metadata_.total_count += e.second;
       total_hits_ += e.second;
 
@@ -144,6 +170,38 @@ void Spectrum1D::_append(const Entry& e) {
     }
 }
 
+bool Spectrum1D::_merge(const Sink &other, bool same_run) {
+  const Spectrum1D *o = dynamic_cast<const Spectrum1D*>(&other);
+  if (!o || (o->spectrum_.size() != spectrum_.size()) || !merge_common(*o, same_run))
+    return false;
+
+  for (size_t i = 0; i < o->spectrum_.size(); ++i) {
+    if (o->spectrum_[i] == 0)
+      continue;
+    spectrum_[i] += o->spectrum_[i];
+    changes_.touch(i);
+    for (auto &m : monitors_)
+      m.add(i, static_cast<double>(o->spectrum_[i]));
+  }
+  maxchan_ = std::max(maxchan_, o->maxchan_);
+  return true;
+}
+
+bool Spectrum1D::_add_sum4_monitor(const SUM4Stream &region)
+{
+  SUM4Stream monitor = region;
+  monitor.reset();
+
+  //catch up with counts binned so far
+  double min = std::max(monitor.LB_left(), 0.0);
+  double max = std::min(monitor.RB_right(), static_cast<double>(spectrum_.size()) - 1);
+  for (double i = min; i <= max; ++i)
+    monitor.add(i, static_cast<double>(spectrum_[static_cast<size_t>(i)]));
+
+  monitors_.push_back(monitor);
+  return true;
+}
+
 void Spectrum1D::addHit(const Hit& newHit)
 {
   uint16_t en = newHit.value(energy_idx_.at(newHit.source_channel())).val(bits_);
@@ -151,8 +209,12 @@ void Spectrum1D::addHit(const Hit& newHit)
     return;
 
   ++spectrum_[en];
+  changes_.touch(en);
   total_hits_++;
 
+  for (auto &m : monitors_)
+    m.add(en, 1);
+
   if (en > maxchan_)
     maxchan_ = en;
 }
@@ -984,11 +1046,13 @@ bool Spectrum1D::read_ava(std::string filename) {
 
 void Spectrum1D::write_tka(std::string name) const {
   uint32_t range = (pow(2, bits_) - 2);
+  Metadata md = metadata_;
+  _export_attributes(md);
   std::ofstream myfile(name, std::ios::out | std::ios::app);
   //  myfile.precision(2);
   //  myfile << std::fixed;
-  myfile << (metadata_.get_attribute("live_time").value_duration.total_milliseconds() * 0.001) << std::endl
-         << (metadata_.get_attribute("real_time").value_duration.total_milliseconds() * 0.001) << std::endl;
+  myfile << (md.get_attribute("live_time").value_duration.total_milliseconds() * 0.001) << std::endl
+         << (md.get_attribute("real_time").value_duration.total_milliseconds() * 0.001) << std::endl;
       
   for (uint32_t i = 0; i < range; i++)
     myfile << spectrum_[i] << std::endl;
@@ -999,6 +1063,9 @@ void Spectrum1D::write_n42(std::string filename) const {
   pugi::xml_document doc;
   pugi::xml_node root = doc.append_child();
 
+  Metadata md = metadata_;
+  _export_attributes(md);
+
   std::stringstream durationdata;
   Qpx::Calibration myCalibration;
   if (metadata_.detectors[0].energy_calibrations_.has_a(Qpx::Calibration("Energy", bits_)))
@@ -1020,15 +1087,15 @@ void Spectrum1D::write_n42(std::string filename) const {
     node.append_child("DetectorType").append_child(pugi::node_pcdata).set_value(metadata_.detectors[0].type_.c_str());
   }
 
-  durationdata << to_iso_extended_string(metadata_.get_attribute("start_time").value_time) << "-5:00"; //fix this hack
+  durationdata << to_iso_extended_string(md.get_attribute("start_time").value_time) << "-5:00"; //fix this hack
   node.append_child("StartTime").append_child(pugi::node_pcdata).set_value(durationdata.str().c_str());
       
   durationdata.str(std::string()); //clear it
-  durationdata << "PT" << (metadata_.get_attribute("real_time").value_duration.total_milliseconds() * 0.001) << "S";
+  durationdata << "PT" << (md.get_attribute("real_time").value_duration.total_milliseconds() * 0.001) << "S";
   node.append_child("RealTime").append_child(pugi::node_pcdata).set_value(durationdata.str().c_str());
 
   durationdata.str(std::string()); //clear it
-  durationdata << "PT" << (metadata_.get_attribute("live_time").value_duration.total_milliseconds() * 0.001) << "S";
+  durationdata << "PT" << (md.get_attribute("live_time").value_duration.total_milliseconds() * 0.001) << "S";
   node.append_child("LiveTime").append_child(pugi::node_pcdata).set_value(durationdata.str().c_str());
 
   if (myCalibration.valid())
@@ -34,13 +34,26 @@ public:
   Spectrum1D* clone() const override { return new Spectrum1D(*this); }
 
 protected:
+  //copy of other with given counts, for snapshots
+  Spectrum1D(const Spectrum1D& other, std::vector<PreciseFloat>&& counts);
+  virtual Spectrum1D* clone_with(std::vector<PreciseFloat>&& counts) const
+    { return new Spectrum1D(*this, std::move(counts)); }
+
   std::string my_type() const override {return "1D";}
 
   bool _initialize() override;
 
   PreciseFloat _data(std::initializer_list<size_t> list) const override;
-  std::unique_ptr<std::list<Entry>> _data_range(std::initializer_list<Pair> list);
+  void _data_sparse(std::initializer_list<Pair> list, SparseData &data) const override;
+  void _data_dense(std::initializer_list<Pair> list, std::vector<double> &values) const override;
+  void _changes_since(uint64_t generation, SparseData &changes) const override;
+  Sink* _clone_onto(Sink& older, uint64_t since) const override;
   void _append(const Entry&) override;
+  bool _merge(const Sink&, bool same_run) override;
+
+  bool _add_sum4_monitor(const SUM4Stream&) override;
+  std::vector<SUM4Stream> _sum4_monitors() const override { return monitors_; }
+  void _clear_sum4_monitors() override { monitors_.clear(); }
   void _set_detectors(const std::vector<Qpx::Detector>& dets) override;
 
   //event processing
@@ -72,6 +85,7 @@ protected:
   bool read_spe_gammavision(std::string);
 
   std::vector<PreciseFloat> spectrum_;
+  std::vector<SUM4Stream> monitors_;
   uint32_t cutoff_bin_;
   uint16_t maxchan_;
 };
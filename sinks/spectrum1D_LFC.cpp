@@ -53,6 +53,18 @@ Spectrum1D_LFC::Spectrum1D_LFC()
   metadata_.overwrite_all_attributes(base_options);
 }
 
+Spectrum1D_LFC::Spectrum1D_LFC(const Spectrum1D_LFC& other, std::vector<PreciseFloat>&& counts)
+  : Spectrum1D(other, std::move(counts))
+  , time1_(other.time1_)
+  , time2_(other.time2_)
+  , time_sample_(other.time_sample_)
+  , channels_all_(other.channels_all_)
+  , channels_run_(other.channels_run_)
+  , count_current_(other.count_current_)
+  , count_total_(other.count_total_)
+  , my_channel_(other.my_channel_)
+{}
+
 bool Spectrum1D_LFC::_initialize() {
   if (!Spectrum1D::_initialize())
     return false;
@@ -89,6 +101,19 @@ void Spectrum1D_LFC::addHit(const Hit& newHit)
   total_hits_++;
 }
 
+bool Spectrum1D_LFC::_merge(const Sink &other, bool same_run)
+{
+  const Spectrum1D_LFC *o = dynamic_cast<const Spectrum1D_LFC*>(&other);
+  if (!o || !Spectrum1D::_merge(other, same_run))
+    return false;
+
+  //other's spectrum is already corrected as far as it got, keep it so
+  for (size_t i = 0; (i < channels_all_.size()) && (i < o->spectrum_.size()); ++i)
+    channels_all_[i] += o->spectrum_[i];
+  count_total_ += o->count_total_ + o->count_current_;
+  return true;
+}
+
 void Spectrum1D_LFC::_push_stats(const StatsUpdate& newStats)
 {
   Spectrum1D::_push_stats(newStats);
@@ -139,21 +164,22 @@ void Spectrum1D_LFC::_push_stats(const StatsUpdate& newStats)
     uint32_t res = pow(2, bits_);
     for (uint32_t i = 0; i < res; i++) {
       channels_all_[i] += fast_peaks_compensated * channels_run_[i] / count_current_;
-      if (channels_all_[i] > 0.0)
+      if (channels_all_[i] > 0.0) {
         spectrum_[i] = channels_all_[i];
+        changes_.touch(i);
+      }
       channels_run_[i] = 0.0;
     }
-    Setting real_time = metadata_.get_attribute("real_time");
-    Setting live_time = metadata_.get_attribute("live_time");
-    live_time.value_duration = real_time.value_duration;
-    metadata_.set_attribute(live_time);
+    live_time_ = real_time_;
 
     count_current_ = 0;
   } else {
     uint32_t res = pow(2, bits_);
     for (uint32_t i = 0; i < res; i++) {
-      if ((channels_run_[i] > 0.0) || (channels_all_[i] > 0.0))
+      if ((channels_run_[i] > 0.0) || (channels_all_[i] > 0.0)) {
         spectrum_[i] = channels_run_[i] + channels_all_[i];
+        changes_.touch(i);
+      }
     }
     total_hits_ += count_current_;
     time2_ = newStats;
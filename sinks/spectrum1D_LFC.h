@@ -36,10 +36,16 @@ public:
   Spectrum1D_LFC* clone() const override { return new Spectrum1D_LFC(*this); }
 
 protected:
+  Spectrum1D_LFC(const Spectrum1D_LFC& other, std::vector<PreciseFloat>&& counts);
+  Spectrum1D_LFC* clone_with(std::vector<PreciseFloat>&& counts) const override
+    { return new Spectrum1D_LFC(*this, std::move(counts)); }
+
   std::string my_type() const override {return "LFC1D";}
   bool _initialize() override;
   
   void _push_stats(const StatsUpdate&) override;
+  bool _merge(const Sink&, bool same_run) override;
+  bool _set_sort_window(double, double) override {return false;} //corrected by stats interval
 
   void addHit(const Hit&) override;
 
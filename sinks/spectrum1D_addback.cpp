@@ -50,6 +50,7 @@ void SpectrumAddback1D::addEvent(const Event& newEvent)
     return;
 
   ++spectrum_[sum];
+  changes_.touch(sum);
   total_hits_++;
 
   if (sum > maxchan_)
@@ -36,6 +36,11 @@ public:
   SpectrumAddback1D* clone() const override { return new SpectrumAddback1D(*this); }
 
 protected:
+  SpectrumAddback1D(const SpectrumAddback1D& other, std::vector<PreciseFloat>&& counts)
+    : Spectrum1D(other, std::move(counts)) {}
+  SpectrumAddback1D* clone_with(std::vector<PreciseFloat>&& counts) const override
+    { return new SpectrumAddback1D(*this, std::move(counts)); }
+
   std::string my_type() const override {return "Addback 1D";}
   void addEvent(const Event&) override;
 };
@@ -41,15 +41,6 @@ Spectrum2D::Spectrum2D()
                     {"m", "m4b", "mat"},
                     {"m4b", "mat"});
 
-  Qpx::Setting buf;
-  buf.id_ = "buffered";
-  buf.metadata.setting_type = Qpx::SettingType::boolean;
-  buf.metadata.unit = "T/F";
-  buf.metadata.description = "Buffered output for efficient plotting (more memory)";
-  buf.metadata.writable = true;
-  buf.metadata.flags.insert("preset");
-  base_options.branches.add(buf);
-
   Qpx::Setting sym;
   sym.id_ = "symmetrized";
   sym.metadata.setting_type = Qpx::SettingType::boolean;
@@ -81,7 +72,11 @@ bool Spectrum2D::_initialize() {
   
 //  energies_.resize(2);
   pattern_.resize(2, 0);
-  buffered_ = (metadata_.get_attribute("buffered").value_int != 0);
+  changes_.resize(pow(2, bits_), pow(2, bits_), 5);
+
+  pyramid_.resize(bits_);
+  for (auto &it : spectrum_)
+    pyramid_.add(it.first.first, it.first.second, to_double(it.second));
 
   adds = 0;
   for (size_t i=0; i < gts.size(); ++i) {
@@ -176,11 +171,26 @@ void Spectrum2D::_set_detectors(const std::vector<Qpx::Detector>& dets) {
 void Spectrum2D::_append(const Entry& e) {
   if (e.first.size() == 2) {
     spectrum_[std::pair<uint16_t,uint16_t>(e.first[0], e.first[1])] += e.second;
+    changes_.touch(e.first[0], e.first[1]);
+    pyramid_.add(e.first[0], e.first[1], to_double(e.second));
     total_events_ += e.second;
     total_hits_ += (2 * e.second);
   }
 }
 
+bool Spectrum2D::_merge(const Sink &other, bool same_run) {
+  const Spectrum2D *o = dynamic_cast<const Spectrum2D*>(&other);
+  if (!o || !merge_common(*o, same_run))
+    return false;
+
+  for (auto &it : o->spectrum_) {
+    spectrum_[it.first] += it.second;
+    changes_.touch(it.first.first, it.first.second);
+    pyramid_.add(it.first.first, it.first.second, to_double(it.second));
+  }
+  return true;
+}
+
 PreciseFloat Spectrum2D::_data(std::initializer_list<size_t> list) const {
   if (list.size() != 2)
     return 0;
@@ -195,54 +205,86 @@ PreciseFloat Spectrum2D::_data(std::initializer_list<size_t> list) const {
     return 0;
 }
 
-std::unique_ptr<EntryList> Spectrum2D::_data_range(std::initializer_list<Pair> list) {
-  int min0, min1, max0, max1;
-  if (list.size() != 2) {
-    min0 = min1 = 0;
-    max0 = max1 = pow(2, bits_);
-  } else {
-    Pair range0 = *list.begin(), range1 = *(list.begin()+1);
-    min0 = range0.first; max0 = range0.second;
-    min1 = range1.first; max1 = range1.second;
-  }
+void Spectrum2D::_data_sparse(std::initializer_list<Pair> list, SparseData &data) const {
+  Pair range0 = *list.begin(), range1 = *(list.begin()+1);
+  size_t min0 = range0.first, max0 = range0.second;
+  size_t min1 = range1.first, max1 = range1.second;
 
-  std::unique_ptr<std::list<Entry>> result(new std::list<Entry>);
 //  CustomTimer makelist(true);
 
-  if (buffered_ && !temp_spectrum_.empty()) {
-    for (auto it : temp_spectrum_) {
-      int co0 = it.first.first, co1 = it.first.second;
-      if ((min0 <= co0) && (co0 <= max0) && (min1 <= co1) && (co1 <= max1)) {
-        Entry newentry;
-        newentry.first.resize(2, 0);
-        newentry.first[0] = co0;
-        newentry.first[1] = co1;
-        newentry.second = it.second;
-        result->push_back(newentry);
-      }
+  data.coords.reserve(data.coords.size() + 2 * spectrum_.size());
+  data.values.reserve(data.values.size() + spectrum_.size());
+  for (auto &it : spectrum_) {
+    size_t co0 = it.first.first, co1 = it.first.second;
+    if ((min0 <= co0) && (co0 <= max0) && (min1 <= co1) && (co1 <= max1))
+      data.add(co0, co1, to_double(it.second));
+  }
+
+//  DBG << "<Spectrum2D> Making list for " << metadata_.name << " took " << makelist.ms() << "ms filled with "
+//         << data.size() << " elements";
+}
+
+void Spectrum2D::_changes_since(uint64_t generation, SparseData &changes) const {
+  for (auto &tile : changes_.dirty_since(generation))
+    for (size_t co0 = tile.min0; co0 <= tile.max0; ++co0) {
+      auto it = spectrum_.lower_bound(std::pair<uint16_t, uint16_t>(co0, tile.min1));
+      for (; (it != spectrum_.end()) && (it->first.first == co0)
+             && (it->first.second <= tile.max1); ++it)
+        changes.add(co0, it->first.second, to_double(it->second));
     }
-  } else {
-    for (auto it : spectrum_) {
-      int co0 = it.first.first, co1 = it.first.second;
-      if ((min0 <= co0) && (co0 <= max0) && (min1 <= co1) && (co1 <= max1)) {
-        Entry newentry;
-        newentry.first.resize(2, 0);
-        newentry.first[0] = co0;
-        newentry.first[1] = co1;
-        newentry.second = it.second;
-        result->push_back(newentry);
+}
+
+Spectrum2D::Spectrum2D(const Spectrum2D& other, SpectrumMap2D&& counts, Pyramid2D&& pyramid)
+  : Spectrum(other)
+  , pattern_(other.pattern_)
+  , spectrum_(std::move(counts))
+  , pyramid_(std::move(pyramid))
+  , pending_cells_(other.pending_cells_)
+{}
+
+Sink* Spectrum2D::_clone_onto(Sink& older, uint64_t since) const {
+  Spectrum2D *o = dynamic_cast<Spectrum2D*>(&older);
+  if (!o || (o->bits_ != bits_))
+    return nullptr;
+
+  Spectrum2D *ret = new Spectrum2D(*this, std::move(o->spectrum_), std::move(o->pyramid_));
+  SpectrumMap2D &counts = ret->spectrum_;
+  for (auto &tile : changes_.dirty_since(since))
+    for (size_t co0 = tile.min0; co0 <= tile.max0; ++co0) {
+      auto from = spectrum_.lower_bound(std::pair<uint16_t, uint16_t>(co0, tile.min1));
+      auto to = spectrum_.upper_bound(std::pair<uint16_t, uint16_t>(co0, tile.max1));
+      //cells only ever gain counts while binning, so the row in the copy is a subset
+      for (auto it = from; it != to; ++it) {
+        PreciseFloat &cell = counts[it->first];
+        if (cell != it->second) {
+          ret->pyramid_.add(co0, it->first.second, to_double(it->second - cell));
+          cell = it->second;
+        }
       }
     }
+  return ret;
+}
+
+void Spectrum2D::_data_rebinned(uint16_t level, std::initializer_list<Pair> list, std::vector<double> &values) const {
+  if (!pyramid_.has_level(level)) {
+    Sink::_data_rebinned(level, list, values);
+    return;
   }
-  if (!temp_spectrum_.empty()) {
-    boost::unique_lock<boost::mutex> uniqueLock(unique_mutex_, boost::defer_lock);
-    while (!uniqueLock.try_lock())
-      boost::this_thread::sleep_for(boost::chrono::seconds{1});
-    temp_spectrum_.clear(); //assumption about client
+  Pair range0 = *list.begin(), range1 = *(list.begin()+1);
+  pyramid_.get(level, range0.first, range0.second, range1.first, range1.second, values);
+}
+
+void Spectrum2D::_data_dense(std::initializer_list<Pair> list, std::vector<double> &values) const {
+  Pair range0 = *list.begin(), range1 = *(list.begin()+1);
+  size_t min0 = range0.first, max0 = range0.second;
+  size_t min1 = range1.first, max1 = range1.second;
+  size_t width = max0 - min0 + 1;
+
+  for (auto &it : spectrum_) {
+    size_t co0 = it.first.first, co1 = it.first.second;
+    if ((min0 <= co0) && (co0 <= max0) && (min1 <= co1) && (co1 <= max1))
+      values[(co1 - min1) * width + (co0 - min0)] = to_double(it.second);
   }
-//  DBG << "<Spectrum2D> Making list for " << metadata_.name << " took " << makelist.ms() << "ms filled with "
-//         << result->size() << " elements";
-  return result;
 }
 
 void Spectrum2D::addEvent(const Event& newEvent) {
@@ -253,15 +295,44 @@ void Spectrum2D::addEvent(const Event& newEvent) {
   if (newEvent.hits.count(pattern_[1]))
     chan2_en = newEvent.hits.at(pattern_[1]).value(energy_idx_.at(pattern_[1])).val(bits_);
   spectrum_[std::pair<uint16_t, uint16_t>(chan1_en,chan2_en)] += 1;
-  if (buffered_)
-    temp_spectrum_[std::pair<uint16_t, uint16_t>(chan1_en, chan2_en)] =
-        spectrum_[std::pair<uint16_t, uint16_t>(chan1_en, chan2_en)];
+  pending_cells_.push_back((uint32_t(chan2_en) << 16) | chan1_en);
   if (chan1_en)
     total_hits_++;
   if (chan2_en)
     total_hits_++;
 }
 
+void Spectrum2D::_push_spill(const Spill& one_spill) {
+  Spectrum::_push_spill(one_spill);
+  apply_pending();
+}
+
+void Spectrum2D::_flush() {
+  Spectrum::_flush();
+  apply_pending();
+}
+
+void Spectrum2D::apply_pending() {
+  if (pending_cells_.empty())
+    return;
+
+  std::sort(pending_cells_.begin(), pending_cells_.end());
+  size_t i = 0;
+  while (i < pending_cells_.size()) {
+    uint32_t cell = pending_cells_[i];
+    size_t count = 0;
+    while ((i < pending_cells_.size()) && (pending_cells_[i] == cell)) {
+      ++count;
+      ++i;
+    }
+    uint16_t c0 = cell & 0xFFFF;
+    uint16_t c1 = cell >> 16;
+    changes_.touch(c0, c1);
+    pyramid_.add(c0, c1, count);
+  }
+  pending_cells_.clear();
+}
+
 bool Spectrum2D::_write_file(std::string dir, std::string format) const {
   std::string name = metadata_.get_attribute("name").value_text;
   //change illegal characters
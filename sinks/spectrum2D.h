@@ -26,6 +26,7 @@
 #define SPECTRUM2D_H
 
 #include "spectrum.h"
+#include "pyramid.h"
 #include <unordered_map>
 
 namespace Qpx {
@@ -38,6 +39,9 @@ public:
 
 protected:
   typedef std::map<std::pair<uint16_t,uint16_t>, PreciseFloat> SpectrumMap2D;
+
+  //copy of other with given counts and their pyramid, for snapshots
+  Spectrum2D(const Spectrum2D& other, SpectrumMap2D&& counts, Pyramid2D&& pyramid);
   
   bool _initialize() override;
   void init_from_file(std::string filename);
@@ -45,11 +49,18 @@ protected:
   std::string my_type() const override {return "2D";}
 
   PreciseFloat _data(std::initializer_list<size_t> list ) const override;
-  std::unique_ptr<EntryList> _data_range(std::initializer_list<Pair> list);
+  void _data_sparse(std::initializer_list<Pair> list, SparseData &data) const override;
+  void _data_dense(std::initializer_list<Pair> list, std::vector<double> &values) const override;
+  void _changes_since(uint64_t generation, SparseData &changes) const override;
+  Sink* _clone_onto(Sink& older, uint64_t since) const override;
+  void _data_rebinned(uint16_t level, std::initializer_list<Pair> list, std::vector<double> &values) const override;
   void _set_detectors(const std::vector<Qpx::Detector>& dets) override;
 
   void addEvent(const Event&) override;
+  void _push_spill(const Spill&) override;
+  void _flush() override;
   void _append(const Entry&) override;
+  bool _merge(const Sink&, bool same_run) override;
 
   //save/load
   bool _write_file(std::string, std::string) const override;
@@ -71,8 +82,11 @@ protected:
 
   //the data itself
   SpectrumMap2D spectrum_;
-  SpectrumMap2D temp_spectrum_;
-  bool buffered_;
+  Pyramid2D pyramid_;
+
+  //cells hit since last spill, folded into pyramid and tracker once per spill
+  std::vector<uint32_t> pending_cells_;
+  void apply_pending();
 
   bool check_symmetrization();
 };
@@ -31,10 +31,11 @@ namespace Qpx {
 static SinkRegistrar<SpectrumRaw> registrar("Raw");
 
 SpectrumRaw::SpectrumRaw()
-  : open_bin_(false)
-  , open_xml_(false)
+  : compression_(0)
   , hits_this_spill_(0)
   , total_hits_(0)
+  , write_backlog_(0)
+  , dropped_hits_(0)
   , ignore_patterns_(true)
 {
   Setting base_options = metadata_.attributes();
@@ -49,6 +50,31 @@ SpectrumRaw::SpectrumRaw()
   file_setting.metadata.description = "path to temp output directory";
   base_options.branches.add(file_setting);
 
+  Qpx::Setting compression;
+  compression.id_ = "compression";
+  compression.metadata.setting_type = Qpx::SettingType::integer;
+  compression.metadata.writable = true;
+  compression.metadata.flags.insert("preset");
+  compression.metadata.minimum = 0;
+  compression.metadata.step = 1;
+  compression.metadata.maximum = 9;
+  compression.metadata.description = "zlib level for list mode chunks, 0 stores them uncompressed";
+  base_options.branches.add(compression);
+
+  Qpx::Setting backlog;
+  backlog.id_ = "write_backlog";
+  backlog.metadata.setting_type = Qpx::SettingType::integer;
+  backlog.metadata.writable = false;
+  backlog.metadata.description = "list mode chunks waiting for the writer thread";
+  base_options.branches.add(backlog);
+
+  Qpx::Setting dropped;
+  dropped.id_ = "dropped_hits";
+  dropped.metadata.setting_type = Qpx::SettingType::integer;
+  dropped.metadata.writable = false;
+  dropped.metadata.description = "hits not written because storage fell behind";
+  base_options.branches.add(dropped);
+
   metadata_.overwrite_all_attributes(base_options);
 }
 
@@ -65,44 +91,24 @@ bool SpectrumRaw::_initialize() {
   DBG << "<SpectrumRaw:" << metadata_.get_attribute("name").value_text << "> will ignore patterns";
 
   file_dir_ = metadata_.get_attribute("file_dir").value_text;
+  compression_ = metadata_.get_attribute("compression").value_int;
   if (file_dir_.empty())
     return false;
 
-  return init_bin();
-}
-
-bool SpectrumRaw::init_text() {
-  file_name_txt_ = file_dir_ + "/qpx_out.xml";
-  xml_root_ = xml_doc_.append_child("QpxListData");
-
-  metadata_.attributes().to_xml(xml_root_);
-
-  open_xml_ = true;
-  return true;
-}
-
-bool SpectrumRaw::init_bin() {
-  file_name_bin_ = file_dir_ + "/qpx_out.bin";
-
-  file_bin_.open(file_name_bin_, std::ofstream::out | std::ofstream::trunc | std::ofstream::binary);
-
-  if (!file_bin_.is_open())
-    return false;
-
-  if (!file_bin_.good() || !init_text()) {
-    file_bin_.close();
+  file_name_ = file_dir_ + "/qpx_out.qls";
+  //triple buffered, a slow disk costs hits in this sink only, never the others
+  writer_ = std::make_shared<ListFileWriter>(65536, compression_, 3);
+  if (!writer_->open(file_name_)) {
+    writer_.reset();
     return false;
   }
 
-  DBG << "<SpectrumRaw:" << metadata_.get_attribute("name").value_text << "> binary is good";
-
-  bin_begin_ = file_bin_.tellp();
-  open_bin_ = true;
+  DBG << "<SpectrumRaw:" << metadata_.get_attribute("name").value_text << "> writing " << file_name_;
   return true;
 }
 
 void SpectrumRaw::addEvent(const Event& newEvent) {
-  if (!open_bin_)
+  if (!writer_)
     return;
 
   std::multiset<Hit> all_hits;
@@ -124,52 +130,69 @@ void SpectrumRaw::_push_hit(const Hit& newhit)
 
 void SpectrumRaw::writeHit(const Hit& hit)
 {
-  if (open_bin_ && pattern_add_.relevant(hit.source_channel()))
+  if (writer_ && pattern_add_.relevant(hit.source_channel()))
   {
-    hit.write_bin(file_bin_);
+    writer_->add_hit(hit);
     hits_this_spill_++;
   }
 }
 
 
 void SpectrumRaw::_push_spill(const Spill& one_spill) {
-  if ((!open_xml_) || (!open_bin_))
+  if (!writer_)
     return;
 
-  uint64_t pos = file_bin_.tellp() - bin_begin_;
-
   Spectrum::_push_spill(one_spill);
 
   Spill copy = one_spill;
   copy.hits.clear();
+  copy.data.clear();
   std::map<int16_t, StatsUpdate> stats;
   for (auto &s : copy.stats)
     if (pattern_add_.relevant(s.first))
       stats[s.first] = s.second;
   copy.stats = stats;
-  copy.to_xml(xml_root_, true);
 
-  xml_root_.last_child().append_attribute("raw_hit_count").set_value(std::to_string(hits_this_spill_).c_str());
-  xml_root_.last_child().append_attribute("file_offset").set_value(std::to_string(pos).c_str());
+  //index entry goes to disk with the spill, nothing accumulates in memory
+  if (!writer_->add_spill(copy))
+    writer_.reset();
 
   total_hits_ += hits_this_spill_;
   hits_this_spill_ = 0;
+
+  if (writer_)
+    update_writer_stats();
+}
+
+void SpectrumRaw::update_writer_stats() {
+  write_backlog_ = writer_->backlog();
+  dropped_hits_ = writer_->dropped_hits();
+}
+
+void SpectrumRaw::_export_attributes(Metadata &md) const
+{
+  Spectrum::_export_attributes(md);
+
+  Setting backlog = md.get_attribute("write_backlog");
+  backlog.value_int = write_backlog_;
+  md.set_attribute(backlog);
+
+  Setting dropped = md.get_attribute("dropped_hits");
+  dropped.value_int = dropped_hits_;
+  md.set_attribute(dropped);
 }
 
 
 void SpectrumRaw::_flush() {
   Spectrum::_flush();
 
-  if (open_xml_) {
-    DBG << "<SpectrumRaw:" << metadata_.get_attribute("name").value_text << "> writing " << file_name_txt_;
-    if (!xml_doc_.save_file(file_name_txt_.c_str()))
-      ERR << "<SpectrumRaw> Failed to save " << file_name_txt_;
-    open_xml_ = false;
-  }
-  if (open_bin_) {
-    DBG << "<SpectrumRaw:" << metadata_.get_attribute("name").value_text << "> closing " << file_name_bin_;
-    file_bin_.close();
-    open_bin_ = false;
+  if (writer_) {
+    DBG << "<SpectrumRaw:" << metadata_.get_attribute("name").value_text << "> closing " << file_name_
+        << " with " << total_hits_ << " hits in " << writer_->bytes() << " bytes";
+    writer_->close();
+    update_writer_stats();
+    writer_.reset();
+    _export_attributes(metadata_);
   }
 }
 
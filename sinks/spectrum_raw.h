@@ -24,6 +24,7 @@
 #define SPECTRUM_RAW_H
 
 #include "spectrum.h"
+#include "list_file.h"
 
 namespace Qpx {
 
@@ -31,17 +32,13 @@ class SpectrumRaw : public Spectrum
 {
 protected:
   std::string file_dir_;
-  std::string file_name_bin_;
-  std::string file_name_txt_;
+  std::string file_name_;
+  int compression_;
 
-  std::ofstream file_bin_;
-  std::streampos bin_begin_;
-
-  bool open_xml_, open_bin_;
-  pugi::xml_document xml_doc_;
-  pugi::xml_node xml_root_;
+  std::shared_ptr<ListFileWriter> writer_;
 
   uint64_t hits_this_spill_, total_hits_;
+  uint64_t write_backlog_, dropped_hits_;
 
   bool ignore_patterns_;
 
@@ -50,12 +47,13 @@ public:
   SpectrumRaw(const SpectrumRaw&other)
     : Spectrum(other)
     , file_dir_(other.file_dir_)
-    , file_name_bin_(other.file_name_bin_)
-    , file_name_txt_(other.file_name_txt_)
+    , file_name_(other.file_name_)
+    , compression_(other.compression_)
     , hits_this_spill_(0)
     , total_hits_(0)
-    , open_xml_(false)
-    , open_bin_(false)
+    , write_backlog_(0)
+    , dropped_hits_(0)
+    , ignore_patterns_(other.ignore_patterns_)
   {}
 
   SpectrumRaw* clone() const override { return new SpectrumRaw(*this); }
@@ -69,19 +67,18 @@ protected:
 
   PreciseFloat _data(std::initializer_list<size_t> list) const override
     { return Sink::_data(list);}
-  std::unique_ptr<std::list<Entry>> _data_range(std::initializer_list<Pair> range)
-    { return Sink::_data_range(range); }
 
   //event processing
   void _push_spill(const Spill&) override;
+  bool _set_sort_window(double, double) override {return false;} //one file, in acquisition order
   void _push_hit(const Hit&) override;
 
   void addEvent(const Event&) override;
   void _flush() override;
 
-  bool init_text();
-  bool init_bin();
   void writeHit(const Hit&);
+  void update_writer_stats();
+  void _export_attributes(Metadata&) const override;
 
   std::string _data_to_xml() const override {return "written to file";}
   uint16_t _data_from_xml(const std::string&) override {return 0;}
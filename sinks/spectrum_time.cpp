@@ -53,6 +53,12 @@ bool TimeSpectrum::_initialize() {
     return false;
   }
 
+  pyramid_.resize(bits_);
+  for (size_t i = 0; i < spectra_.size(); ++i)
+    for (size_t j = 0; j < spectra_[i].size(); ++j)
+      if (spectra_[i][j] > 0)
+        pyramid_.add(i, j, to_double(spectra_[i][j]));
+
   return true;
 }
 
@@ -93,45 +99,41 @@ PreciseFloat TimeSpectrum::_data(std::initializer_list<size_t> list) const {
   return spectra_.at(coords[0]).at(coords[1]);
 }
 
-std::unique_ptr<std::list<Entry>> TimeSpectrum::_data_range(std::initializer_list<Pair> list)
+void TimeSpectrum::_data_sparse(std::initializer_list<Pair> list, SparseData &data) const
 {
-  size_t min0, min1, max0, max1;
-  if (list.size() != 2)
-  {
-    min0 = min1 = 0;
-    max0 = spectra_.size();
-    max1 = pow(2, bits_);
-  } else {
-    Pair range0 = *list.begin(), range1 = *(list.begin()+1);
-    min0 = range0.first; max0 = range0.second;
-    min1 = range1.first; max1 = range1.second;
-  }
+  Pair range0 = *list.begin(), range1 = *(list.begin()+1);
+  size_t min0 = range0.first, max0 = range0.second;
+  size_t min1 = range1.first, max1 = range1.second;
 
   if (max0 >= spectra_.size())
     max0 = spectra_.size();
   if (max1 >= pow(2, bits_))
     max1 = pow(2, bits_);
 
-  std::unique_ptr<std::list<Entry>> result(new std::list<Entry>);
 //  CustomTimer makelist(true);
 
   for (size_t i = min0; i < max0; ++i)
   {
-    for (size_t j = min1; j < max1; ++j)
+    const std::vector<PreciseFloat> &spectrum = spectra_.at(i);
+    for (size_t j = min1; (j < max1) && (j < spectrum.size()); ++j)
     {
-      PreciseFloat val = spectra_.at(i).at(j);
-      if (to_double(val) == 0)
+      double val = to_double(spectrum.at(j));
+      if (val == 0)
         continue;
-      Entry newentry;
-      newentry.first.resize(2, 0);
-      newentry.first[0] = i;
-      newentry.first[1] = j;
-      newentry.second = val;
-      result->push_back(newentry);
+      data.add(i, j, val);
     }
   }
+}
 
-  return result;
+void TimeSpectrum::_data_rebinned(uint16_t level, std::initializer_list<Pair> list, std::vector<double> &values) const
+{
+  if (!pyramid_.has_level(level))
+  {
+    Sink::_data_rebinned(level, list, values);
+    return;
+  }
+  Pair range0 = *list.begin(), range1 = *(list.begin()+1);
+  pyramid_.get(level, range0.first, range0.second, range1.first, range1.second, values);
 }
 
 void TimeSpectrum::_append(const Entry& e)
@@ -139,6 +141,54 @@ void TimeSpectrum::_append(const Entry& e)
   //do this
 }
 
+bool TimeSpectrum::_merge(const Sink &other, bool same_run)
+{
+  const TimeSpectrum *o = dynamic_cast<const TimeSpectrum*>(&other);
+  if (!o || !merge_common(*o, same_run))
+    return false;
+
+  //same run shares intervals, another run follows ours in time
+  size_t first = same_run ? 0 : spectra_.size();
+  double offset = 0;
+  if (!same_run && !seconds_.empty()) {
+    offset = to_double(seconds_.back());
+    if (!updates_.empty() && !o->updates_.empty())
+      offset = std::max(offset, (o->updates_.front().lab_time
+                                 - updates_.front().lab_time).total_milliseconds() * 0.001);
+  }
+
+  for (size_t i = 0; i < o->spectra_.size(); ++i) {
+    size_t k = first + i;
+    if (k >= spectra_.size())
+      spectra_.push_back(std::vector<PreciseFloat>(pow(2, bits_)));
+    for (size_t j = 0; (j < o->spectra_[i].size()) && (j < spectra_[k].size()); ++j)
+      if (o->spectra_[i][j] > 0) {
+        spectra_[k][j] += o->spectra_[i][j];
+        pyramid_.add(k, j, to_double(o->spectra_[i][j]));
+      }
+  }
+
+  first = same_run ? 0 : counts_.size();
+  for (size_t i = 0; i < o->counts_.size(); ++i) {
+    if (first + i < counts_.size())
+      counts_[first + i] += o->counts_[i];
+    else
+      counts_.push_back(o->counts_[i]);
+  }
+
+  first = same_run ? seconds_.size() : 0;
+  for (size_t i = first; i < o->seconds_.size(); ++i) {
+    seconds_.push_back(o->seconds_[i] + offset);
+    if (i < o->updates_.size())
+      updates_.push_back(o->updates_[i]);
+  }
+
+  axes_[0].clear();
+  for (auto &q : seconds_)
+    axes_[0].push_back(to_double(q));
+  return true;
+}
+
 void TimeSpectrum::addHit(const Hit& newHit)
 {
   uint16_t en = newHit.value(energy_idx_.at(newHit.source_channel())).val(bits_);
@@ -146,6 +196,7 @@ void TimeSpectrum::addHit(const Hit& newHit)
 //    return;
 
   spectra_[spectra_.size()-1][en]++;
+  pyramid_.add(spectra_.size()-1, en, 1);
   total_hits_++;
 
 //  if (en > maxchan_)
@@ -24,6 +24,7 @@
 #define SPECTRUM_TIME_H
 
 #include "spectrum.h"
+#include "pyramid.h"
 
 namespace Qpx {
 
@@ -39,8 +40,11 @@ protected:
   bool _initialize() override;
 
   PreciseFloat _data(std::initializer_list<size_t> list) const override;
-  std::unique_ptr<std::list<Entry>> _data_range(std::initializer_list<Pair> list);
+  void _data_sparse(std::initializer_list<Pair> list, SparseData &data) const override;
+  void _data_rebinned(uint16_t level, std::initializer_list<Pair> list, std::vector<double> &values) const override;
   void _append(const Entry&) override;
+  bool _merge(const Sink&, bool same_run) override;
+  bool _set_sort_window(double, double) override {return false;} //binned by stats interval
   void _set_detectors(const std::vector<Qpx::Detector>& dets) override;
 
   //event processing
@@ -57,6 +61,8 @@ protected:
   std::vector<PreciseFloat> counts_;
   std::vector<PreciseFloat> seconds_;
   std::vector<StatsUpdate>  updates_;
+
+  Pyramid2D pyramid_;
 };
 
 }
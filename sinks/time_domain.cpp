@@ -106,31 +106,24 @@ PreciseFloat TimeDomain::_data(std::initializer_list<size_t> list) const {
     return spectrum_[chan];
 }
 
-std::unique_ptr<std::list<Entry>> TimeDomain::_data_range(std::initializer_list<Pair> list) {
-  size_t min, max;
-  if (list.size() != 1) {
-    min = 0;
-    max = spectrum_.size();
-  } else {
-    Pair range = *list.begin();
-    min = range.first;
-    max = range.second;
-  }
+void TimeDomain::_data_sparse(std::initializer_list<Pair> list, SparseData &data) const {
+  if (spectrum_.empty())
+    return;
 
-  if (max >= spectrum_.size())
-    max = spectrum_.size() - 1;
+  Pair range = *list.begin();
+  size_t min = range.first;
+  size_t max = std::min(range.second, spectrum_.size() - 1);
 
   //in range?
-  
-  std::unique_ptr<std::list<Entry>> result(new std::list<Entry>);
-  for (size_t i=min; i <= max; i++) {
-    Entry newentry;
-    newentry.first.resize(1, 0);
-    newentry.first[0] = i;
-    newentry.second = spectrum_[i];
-    result->push_back(newentry);
-  }
-  return result;
+
+  for (size_t i=min; i <= max; i++)
+    data.add(i, to_double(spectrum_[i]));
+}
+
+void TimeDomain::_data_dense(std::initializer_list<Pair> list, std::vector<double> &values) const {
+  Pair range = *list.begin();
+  for (size_t i=range.first; (i <= range.second) && (i < spectrum_.size()); i++)
+    values[i - range.first] = to_double(spectrum_[i]);
 }
 
 void TimeDomain::_append(const Entry& e) {
@@ -141,6 +134,51 @@ void TimeDomain::_append(const Entry& e) {
     }
 }
 
+bool TimeDomain::_merge(const Sink &other, bool same_run)
+{
+  const TimeDomain *o = dynamic_cast<const TimeDomain*>(&other);
+  if (!o || (o->codomain != codomain) || !merge_common(*o, same_run))
+    return false;
+
+  if (same_run) {
+    //same intervals: rates add up, dead time is the run's own
+    for (size_t i = 0; (i < o->spectrum_.size()) && (i < spectrum_.size()); ++i)
+      if (codomain == 0)
+        spectrum_[i] += o->spectrum_[i];
+    for (size_t i = 0; (i < o->counts_.size()) && (i < counts_.size()); ++i)
+      counts_[i] += o->counts_[i];
+    for (size_t i = counts_.size(); i < o->counts_.size(); ++i)
+      counts_.push_back(o->counts_[i]);
+    for (size_t i = seconds_.size(); (i < o->seconds_.size()) && (i < o->spectrum_.size()); ++i) {
+      seconds_.push_back(o->seconds_[i]);
+      spectrum_.push_back(o->spectrum_[i]);
+      if (i < o->updates_.size())
+        updates_.push_back(o->updates_[i]);
+    }
+  } else {
+    //other run follows ours in time
+    double offset = 0;
+    if (!seconds_.empty()) {
+      offset = to_double(seconds_.back());
+      if (!updates_.empty() && !o->updates_.empty())
+        offset = std::max(offset, (o->updates_.front().lab_time
+                                   - updates_.front().lab_time).total_milliseconds() * 0.001);
+    }
+    for (size_t i = 0; (i < o->seconds_.size()) && (i < o->spectrum_.size()); ++i) {
+      seconds_.push_back(o->seconds_[i] + offset);
+      spectrum_.push_back(o->spectrum_[i]);
+    }
+    counts_.insert(counts_.end(), o->counts_.begin(), o->counts_.end());
+    updates_.insert(updates_.end(), o->updates_.begin(), o->updates_.end());
+  }
+
+  axes_.resize(1);
+  axes_[0].clear();
+  for (auto &q : seconds_)
+    axes_[0].push_back(to_double(q));
+  return true;
+}
+
 void TimeDomain::_push_stats(const StatsUpdate& newStats)
 {
   if (pattern_add_.relevant(newStats.source_channel))
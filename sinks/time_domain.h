@@ -39,8 +39,11 @@ protected:
   bool _initialize() override;
 
   PreciseFloat _data(std::initializer_list<size_t> list) const override;
-  std::unique_ptr<std::list<Entry>> _data_range(std::initializer_list<Pair> list);
+  void _data_sparse(std::initializer_list<Pair> list, SparseData &data) const override;
+  void _data_dense(std::initializer_list<Pair> list, std::vector<double> &values) const override;
   void _append(const Entry&) override;
+  bool _merge(const Sink&, bool same_run) override;
+  bool _set_sort_window(double, double) override {return false;} //binned by stats interval
   void _set_detectors(const std::vector<Qpx::Detector>& dets) override;
 
   //event processing
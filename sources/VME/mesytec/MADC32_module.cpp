@@ -49,28 +49,6 @@ MADC32::~MADC32() {
 }
 
 
-bool MADC32::daq_init() {
-
-  //for scaler
-  Qpx::Setting reset_counters("VME/MADC32/reset_ctr_ab");
-  reset_counters.enrich(setting_definitions_, true);
-  m_controller->write16(m_baseAddress + reset_counters.metadata.address, AddressModifier::A32_UserData, (uint16_t)2);
-
-  //the rest
-  Qpx::Setting reset("VME/MADC32/readout_reset");
-  reset.enrich(setting_definitions_, true);
-  m_controller->write16(m_baseAddress + reset.metadata.address, AddressModifier::A32_UserData, (uint16_t)1);
-
-  Qpx::Setting freset("VME/MADC32/FIFO_reset");
-  freset.enrich(setting_definitions_, true);
-  m_controller->write16(m_baseAddress + freset.metadata.address, AddressModifier::A32_UserData, (uint16_t)0);
-
-  Qpx::Setting st("VME/MADC32/start_acq");
-  st.enrich(setting_definitions_, true);
-  m_controller->write16(m_baseAddress + st.metadata.address, AddressModifier::A32_UserData, (uint16_t)1);
-
-}
-
 void MADC32::rebuild_structure(Qpx::Setting &set) {
   for (auto &k : set.branches.my_data_) {
     if ((k.metadata.setting_type == Qpx::SettingType::stem) && (k.id_ == "VME/MADC32/ChannelThresholds")) {
@@ -182,7 +160,8 @@ HitModel MADC32::model_hit() {
   return h;
 }
 
-std::list<Hit> MADC32::parse(std::list<uint32_t> data, uint64_t &evts, uint64_t &last_time, std::string &madc_pattern)
+std::list<Hit> MADC32::parse(std::list<uint32_t> data, uint64_t &evts, TimeUnwrap &clock, std::string &madc_pattern,
+                             int16_t channel_offset)
 {
   std::list<Hit> hits;
 
@@ -238,13 +217,7 @@ std::list<Hit> MADC32::parse(std::list<uint32_t> data, uint64_t &evts, uint64_t
     } else if ((word & footer_m) == footer_c) {
       madc_pattern += "F";
       uint64_t timestamp = word & footer_time_m;
-      uint64_t time_upper = last_time & 0xffffffffc0000000;
-      uint64_t last_time_lower = last_time & 0x000000003fffffff;
-      if (timestamp < last_time_lower) {
-        time_upper += 0x40000000;
-        DBG << "<MADC32> time rollover";
-      }
-      last_time = timestamp | time_upper;
+      uint64_t last_time = clock.unwrap(channel_offset, timestamp);
 
       for (auto &h : hits)
         h.set_timestamp_native(last_time);
@@ -259,7 +232,7 @@ std::list<Hit> MADC32::parse(std::list<uint32_t> data, uint64_t &evts, uint64_t
 //                  DBG << "  MADC hit detector=" << chan_nr << "  energy=" << nrg << "  overflow=" << overflow;
 
       energy.set_val(nrg);
-      Hit one_hit(chan_nr, model_hit());
+      Hit one_hit(chan_nr + channel_offset, model_hit());
 //      one_hit.energy = energy;
       one_hit.set_value(0, energy.val(13));
 
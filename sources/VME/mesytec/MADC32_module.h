@@ -38,9 +38,11 @@ public:
   std::string device_name() const override {return plugin_name();}
 
   void addReadout(VmeStack& stack, int style) override;
-  bool daq_init();
 
-  static std::list<Hit> parse(std::list<uint32_t> data, uint64_t &evts, uint64_t &last_time, std::string &madc_pattern);
+  //one readout of header, data words and footer; footer time is extended
+  //on clock (footer_time_bits wide) under channel_offset
+  static std::list<Hit> parse(std::list<uint32_t> data, uint64_t &evts, TimeUnwrap &clock, std::string &madc_pattern,
+                              int16_t channel_offset = 0);
   static HitModel model_hit();
 
 private:
@@ -47,4 +47,72 @@ void MTDC32::rebuild_structure(Qpx::Setting &set) {
 
 }
 
+HitModel MTDC32::model_hit() {
+  HitModel h;
+  h.timebase = TimeStamp(50, 1);
+  h.add_value("time", 16);
+  return h;
+}
+
+std::list<Hit> MTDC32::parse(std::list<uint32_t> data, uint64_t &evts, TimeUnwrap &clock, std::string &mtdc_pattern,
+                             int16_t channel_offset)
+{
+  std::list<Hit> hits;
+
+  uint64_t events = 0;
+  uint64_t headers = 0;
+  uint64_t footers = 0;
+
+  uint32_t header_m   = 0xff000000; // Header Mask
+  uint32_t header_c   = 0x40000000; // Header Compare
+
+  uint32_t footer_m      = 0xc0000000; // Footer Mask
+  uint32_t footer_c      = 0xc0000000; // Footer Compare
+  uint32_t footer_time_m = 0x3fffffff; // Mask for timestamp in footer
+
+  uint32_t evt_mask = 0xffc00000; // event header mask
+  uint32_t evt_c    = 0x04000000; // event compare
+
+  uint32_t det_mask = 0x003f0000; // Channel mask, 32 and 33 are triggers
+  uint32_t val_mask = 0x0000ffff; // Time difference mask
+
+  uint32_t junk_c  = 0xffffffff;
+
+  mtdc_pattern.clear();
+  HitModel model = model_hit();
+
+  for (auto &word : data) {
+    if (word == junk_c) {
+      mtdc_pattern += "J";
+    } else if ((word & header_m) == header_c) {
+      headers++;
+      mtdc_pattern += "H";
+    } else if ((word & footer_m) == footer_c) {
+      mtdc_pattern += "F";
+      uint64_t timestamp = word & footer_time_m;
+      uint64_t last_time = clock.unwrap(channel_offset, timestamp);
+
+      for (auto &h : hits)
+        h.set_timestamp_native(last_time);
+
+      footers++;
+    } else if ((word & evt_mask) == evt_c) {
+      Hit one_hit(((word & det_mask) >> 16) + channel_offset, model);
+      one_hit.set_value(0, word & val_mask);
+      hits.push_back(one_hit);
+      events++;
+      mtdc_pattern += "E";
+    } else {
+      mtdc_pattern += "?";
+    }
+  }
+
+  if ((headers != 1) || (headers != footers))
+    hits.clear();
+  else
+    evts += events;
+
+  return hits;
+}
+
 }
@@ -37,6 +37,11 @@ public:
   static std::string plugin_name() {return "VME/MTDC32";}
   std::string device_name() const override {return plugin_name();}
 
+  //one readout of header, data words and footer, as MADC32::parse
+  static std::list<Hit> parse(std::list<uint32_t> data, uint64_t &evts, TimeUnwrap &clock, std::string &mtdc_pattern,
+                              int16_t channel_offset = 0);
+  static HitModel model_hit();
+
 private:
   //no copying
   void operator=(MTDC32 const&);
@@ -160,6 +160,53 @@ bool MesytecVME::die() {
 }
 
 
+bool MesytecVME::daq_init() {
+  if (!m_controller)
+    return false;
+
+  //for scaler
+  Qpx::Setting reset_counters(this->device_name() + "/reset_ctr_ab");
+  reset_counters.enrich(setting_definitions_, true);
+  m_controller->write16(m_baseAddress + reset_counters.metadata.address, AddressModifier::A32_UserData, (uint16_t)2);
+
+  //the rest
+  Qpx::Setting reset(this->device_name() + "/readout_reset");
+  reset.enrich(setting_definitions_, true);
+  m_controller->write16(m_baseAddress + reset.metadata.address, AddressModifier::A32_UserData, (uint16_t)1);
+
+  Qpx::Setting freset(this->device_name() + "/FIFO_reset");
+  freset.enrich(setting_definitions_, true);
+  m_controller->write16(m_baseAddress + freset.metadata.address, AddressModifier::A32_UserData, (uint16_t)0);
+
+  Qpx::Setting st(this->device_name() + "/start_acq");
+  st.enrich(setting_definitions_, true);
+  m_controller->write16(m_baseAddress + st.metadata.address, AddressModifier::A32_UserData, (uint16_t)1);
+
+  return true;
+}
+
+bool MesytecVME::daq_stop() {
+  if (!m_controller)
+    return false;
+
+  Qpx::Setting st(this->device_name() + "/start_acq");
+  st.enrich(setting_definitions_, true);
+  m_controller->write16(m_baseAddress + st.metadata.address, AddressModifier::A32_UserData, (uint16_t)0);
+  return true;
+}
+
+void MesytecVME::addReadout(VmeStack& stack, int style) {
+  if (style != 0)
+    return;
+
+  //read 'too many' words and let BERR terminate the transfer
+  Qpx::Setting reset(this->device_name() + "/readout_reset");
+  reset.enrich(setting_definitions_, true);
+  stack.addFifoRead32(m_baseAddress, readamod, (size_t)45);
+  stack.addWrite16(m_baseAddress + reset.metadata.address, initamod, (uint16_t)1);
+  stack.addDelay(5);
+}
+
 bool MesytecVME::read_settings_bulk(Qpx::Setting &set) const {
   if (set.id_ != device_name())
     return false;
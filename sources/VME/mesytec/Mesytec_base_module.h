@@ -24,6 +24,7 @@
 #define MESYTEC_BASE_MODULE
 
 #include "vmemodule.h"
+#include "time_unwrap.h"
 
 #define MESYTEC_ADDRESS_SPACE_LENGTH				0x10000000
 
@@ -47,10 +48,21 @@ public:
   bool write_settings_bulk(Qpx::Setting &set) override;
   bool read_settings_bulk(Qpx::Setting &set) const override;
 
+  //counters, readout and FIFO reset, then start acquisition
+  bool daq_init() override;
+  bool daq_stop() override;
+
   //VmeModule
   uint32_t baseAddressSpaceLength() const override { return MESYTEC_ADDRESS_SPACE_LENGTH; }
   bool connected() const override;
   std::string firmwareName() const;
+  //single event from FIFO, terminated by BERR
+  void addReadout(VmeStack& stack, int style) override;
+
+  //width of event counter/timestamp in readout footers, for TimeUnwrap
+  static const uint16_t footer_time_bits = 30;
+  //footer clock ticks (50 ns) beyond which a gap on one channel is reported, 10 s
+  static const uint64_t footer_max_jump = 200000000;
 
   //MesytecRC
   bool RC_wait(double millisex = 5.0) const;
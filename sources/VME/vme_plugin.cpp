@@ -21,6 +21,8 @@
  ******************************************************************************/
 
 #include "vme_plugin.h"
+#include <cerrno>
+#include <cstring>
 #include <boost/lexical_cast.hpp>
 #include <boost/filesystem.hpp>
 #include <boost/algorithm/string.hpp>
@@ -33,11 +35,22 @@
 
 #include "vmusb.h"
 #include "vmusb2.h"
+#include "vmusb_sim.h"
+#include "vmusb_buffer.h"
+#include "MADC32_module.h"
+#include "MTDC32_module.h"
 
 namespace Qpx {
 
 static SourceRegistrar<QpxVmePlugin> registrar("VME");
 
+//VM-USB buffers are at most 13k 16-bit words
+static const size_t readout_buffer_len16 = 16384;
+static const int    readout_timeout_ms = 100;
+static const int    readout_max_errors = 10;
+static const int    readout_stop_timeouts = 10;
+static const double spill_interval_ms = 1000;
+
 QpxVmePlugin::QpxVmePlugin() {
 
   status_ = SourceStatus::loaded | SourceStatus::can_boot;
@@ -71,8 +84,8 @@ bool QpxVmePlugin::daq_start(SynchronizedQueue<Spill*>* out_queue) {
 
   run_status_.store(1);
   raw_queue_ = new SynchronizedQueue<Spill*>();
-  //runner_ = new boost::thread(&worker_run_dbl, this, raw_queue_);
-  //parser_ = new boost::thread(&worker_parse, this, raw_queue_, out_queue);
+  runner_ = new boost::thread(&worker_run, this, raw_queue_);
+  parser_ = new boost::thread(&worker_parse, this, raw_queue_, out_queue);
 
   return true;
 }
@@ -81,7 +94,39 @@ bool QpxVmePlugin::daq_init() {
   if (!controller_ || !controller_->connected())
     return false;
 
-  controller_->daq_init();
+  if (!controller_->daq_init())
+    return false;
+
+  //one stack reads every module on each trigger, in a fixed order
+  readout_.clear();
+  VmeStack* stack = controller_->newStack();
+  int16_t channels = 0;
+  for (auto &q : modules_) {
+    if (!q.second || !q.second->connected())
+      continue;
+    Readout r;
+    r.module = q.second;
+    r.channel_offset = channels;
+    if (std::dynamic_pointer_cast<MADC32>(q.second)) {
+      r.tdc = false;
+      channels += 32;
+    } else if (std::dynamic_pointer_cast<MTDC32>(q.second)) {
+      r.tdc = true;
+      channels += 34;
+    } else
+      continue;
+    q.second->daq_init();
+    q.second->addReadout(*stack, 0);
+    readout_.push_back(r);
+    DBG << "<VmePlugin> Reading out " << q.first << " as channels "
+        << r.channel_offset << "-" << (channels - 1);
+  }
+
+  bool loaded = !readout_.empty() && controller_->load_readout(0, *stack);
+  delete stack;
+  if (!loaded)
+    WARN << "<VmePlugin> Could not load readout stack for " << readout_.size() << " modules";
+  return loaded;
 }
 
 bool QpxVmePlugin::daq_stop() {
@@ -121,6 +166,205 @@ bool QpxVmePlugin::daq_running() {
   return (run_status_.load() > 0);
 }
 
+void QpxVmePlugin::worker_run(QpxVmePlugin* callback, SynchronizedQueue<Spill*>* spill_queue) {
+  VmeController *controller = callback->controller_;
+  std::vector<uint16_t> buffer(readout_buffer_len16);
+
+  //parser takes run start from first spill
+  spill_queue->enqueue(new Spill());
+
+  controller->daq_start();
+
+  Spill* fetched_spill = new Spill();
+  boost::posix_time::ptime spill_start = fetched_spill->time;
+  int errors = 0;
+  int timeouts = 0;
+  uint64_t buffers = 0;
+  bool stopping = false;
+
+  while (true) {
+    if (!stopping && (callback->run_status_.load() == 2)) {
+      //controller flushes what it holds, ending with last buffer
+      controller->daq_stop();
+      for (auto &r : callback->readout_)
+        r.module->daq_stop();
+      stopping = true;
+    }
+
+    size_t bytes = 0;
+    int ret = controller->daq_read(buffer.data(), buffer.size() * sizeof(uint16_t),
+                                   &bytes, readout_timeout_ms);
+    if (ret < 0) {
+      if (errno != ETIMEDOUT)
+        errors++;
+      else if (stopping)
+        timeouts++;
+      if (errors >= readout_max_errors) {
+        ERR << "<VmePlugin::runner> Giving up after " << errors << " failed reads";
+        break;
+      }
+      if (timeouts >= readout_stop_timeouts) {
+        WARN << "<VmePlugin::runner> No last buffer after stop, giving up";
+        break;
+      }
+    } else if (bytes >= sizeof(uint16_t)) {
+      timeouts = 0;
+      //each buffer goes as its length in 16-bit words, then the words packed in pairs
+      uint32_t words16 = bytes / sizeof(uint16_t);
+      size_t at = fetched_spill->data.size();
+      fetched_spill->data.resize(at + 1 + (words16 + 1) / 2, 0);
+      fetched_spill->data[at] = words16;
+      memcpy(fetched_spill->data.data() + at + 1, buffer.data(), words16 * sizeof(uint16_t));
+      buffers++;
+      if (stopping && (buffer[0] & VmUsbBuffer::last_buffer))
+        break;
+    } else if (stopping)
+      break;
+
+    boost::posix_time::ptime now = boost::posix_time::microsec_clock::universal_time();
+    if ((now - spill_start).total_milliseconds() >= spill_interval_ms) {
+      fetched_spill->time = now;
+      spill_queue->enqueue(fetched_spill);
+      fetched_spill = new Spill();
+      spill_start = now;
+    }
+  }
+
+  if (!stopping) {
+    controller->daq_stop();
+    for (auto &r : callback->readout_)
+      r.module->daq_stop();
+  }
+
+  fetched_spill->time = boost::posix_time::microsec_clock::universal_time();
+  spill_queue->enqueue(fetched_spill);
+
+  DBG << "<VmePlugin::runner> Read " << buffers << " buffers";
+  callback->run_status_.store(3);
+}
+
+void QpxVmePlugin::worker_parse(QpxVmePlugin* callback, SynchronizedQueue<Spill*>* in_queue, SynchronizedQueue<Spill*>* out_queue) {
+
+  struct Channels {
+    bool tdc;
+    int16_t channel_offset;
+    int16_t channels;
+    uint64_t events;
+  };
+
+  std::vector<Channels> modules;
+  for (auto &r : callback->readout_)
+    modules.push_back(Channels{r.tdc, r.channel_offset, int16_t(r.tdc ? 34 : 32), 0});
+
+  //one footer clock per module, kept under its first channel
+  TimeUnwrap clock(MesytecVME::footer_time_bits, MesytecVME::footer_max_jump);
+
+  HitModel madc_model = MADC32::model_hit();
+  HitModel mtdc_model = MTDC32::model_hit();
+
+  Spill* spill;
+  boost::posix_time::ptime run_start = boost::posix_time::microsec_clock::universal_time();
+  bool started = false;
+  uint64_t buffers = 0, bad_buffers = 0, events = 0, bad_events = 0;
+  std::list<VmUsbEvent> decoded;
+  std::string pattern;
+
+  while ((spill = in_queue->dequeue()) != NULL) {
+    if (!started) {
+      //start stats go in a spill of their own, ahead of any hits
+      run_start = spill->time;
+      for (auto &m : modules)
+        for (int16_t i = 0; i < m.channels; ++i) {
+          StatsUpdate &s = spill->stats[m.channel_offset + i];
+          s.stats_type = StatsType::start;
+          s.source_channel = m.channel_offset + i;
+          s.model_hit = m.tdc ? mtdc_model : madc_model;
+          s.lab_time = run_start;
+        }
+      started = true;
+      out_queue->enqueue(spill);
+      continue;
+    }
+
+    const uint32_t* data = spill->data.data();
+    size_t idx = 0;
+    while (idx < spill->data.size()) {
+      uint32_t words16 = data[idx++];
+      size_t words32 = (words16 + 1) / 2;
+      if (idx + words32 > spill->data.size())
+        break;
+      buffers++;
+      decoded.clear();
+      uint16_t header = 0;
+      if (!VmUsbBuffer::decode(reinterpret_cast<const uint16_t*>(data + idx), words16, decoded, header))
+        bad_buffers++;
+      idx += words32;
+
+      for (auto &e : decoded) {
+        if (e.stack_id != 0)
+          continue;
+
+        //each module's readout runs from its header to its footer, in stack order
+        size_t m = 0;
+        std::list<uint32_t> segment;
+        bool event_ok = true;
+        for (auto &word : e.words) {
+          segment.push_back(word);
+          if ((word & 0xc0000000) != 0xc0000000)
+            continue;
+          if (m < modules.size()) {
+            Channels &mod = modules[m];
+            std::list<Hit> hits = mod.tdc
+                ? MTDC32::parse(segment, mod.events, clock, pattern, mod.channel_offset)
+                : MADC32::parse(segment, mod.events, clock, pattern, mod.channel_offset);
+            if (hits.empty() && (pattern.find('E') != std::string::npos))
+              event_ok = false;
+            spill->hits.splice(spill->hits.end(), hits);
+          } else
+            event_ok = false;
+          segment.clear();
+          m++;
+        }
+        if (!segment.empty() || (m != modules.size()))
+          event_ok = false;
+        if (event_ok)
+          events++;
+        else
+          bad_events++;
+      }
+    }
+
+    for (auto &m : modules)
+      for (int16_t i = 0; i < m.channels; ++i) {
+        StatsUpdate &s = spill->stats[m.channel_offset + i];
+        s.source_channel = m.channel_offset + i;
+        s.model_hit = m.tdc ? mtdc_model : madc_model;
+        s.lab_time = spill->time;
+        //no dead time readback, sinks take live time = real time
+        s.items["native_time"] = clock.last(m.channel_offset);
+      }
+
+    spill->data.clear();
+    out_queue->enqueue(spill);
+  }
+
+  Spill* stop_spill = new Spill();
+  for (auto &m : modules)
+    for (int16_t i = 0; i < m.channels; ++i) {
+      StatsUpdate &s = stop_spill->stats[m.channel_offset + i];
+      s.stats_type = StatsType::stop;
+      s.source_channel = m.channel_offset + i;
+      s.model_hit = m.tdc ? mtdc_model : madc_model;
+      s.lab_time = stop_spill->time;
+      s.items["native_time"] = clock.last(m.channel_offset);
+    }
+  out_queue->enqueue(stop_spill);
+
+  DBG << "<VmePlugin::parser> Parsed " << events << " events from " << buffers
+      << " buffers, " << bad_events << " bad events, " << bad_buffers << " bad buffers, "
+      << clock.to_string();
+}
+
 
 bool QpxVmePlugin::read_settings_bulk(Qpx::Setting &set) const {
   if (set.id_ != device_name())
@@ -218,6 +462,15 @@ bool QpxVmePlugin::boot() {
   } else if (controller_name_ == "VmUsb2") {
     controller_ = new VmUsb2();
     controller_->connect(0);
+  } else if (controller_name_ == "VmUsbSim") {
+    controller_ = new VmUsbSim();
+    controller_->connect(0);
+  } else
+    controller_ = nullptr;
+
+  if (!controller_) {
+    WARN << "<VmePlugin> Unknown controller type " << controller_name_;
+    return false;
   }
 
   if (!controller_->connected()) {
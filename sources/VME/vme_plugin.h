@@ -70,12 +70,25 @@ protected:
 
   std::map<std::string, std::shared_ptr<VmeModule>> modules_;
 
+  //modules in order of readout stack, channels of each start at offset
+  struct Readout {
+    std::shared_ptr<VmeModule> module;
+    bool tdc;
+    int16_t channel_offset;
+  };
+  std::vector<Readout> readout_;
+
   //Multithreading
   boost::atomic<int> run_status_;
   boost::thread *runner_;
   boost::thread *parser_;
   SynchronizedQueue<Spill*>* raw_queue_;
 
+  //runner drains controller buffers, a spill's worth at a time
+  static void worker_run(QpxVmePlugin* callback, SynchronizedQueue<Spill*>* spill_queue);
+  //parser decodes them in order, timestamps carry across spills
+  static void worker_parse(QpxVmePlugin* callback, SynchronizedQueue<Spill*>* in_queue, SynchronizedQueue<Spill*>* out_queue);
+
 };
 
 
@@ -50,6 +50,11 @@ public:
   virtual void start_daq() {}
   virtual void stop_daq() {}
 
+  //autonomous mode: controller runs loaded stack on each trigger and buffers
+  //its output; daq_read drains one buffer, 0 on success (transferCount may be 0)
+  virtual bool load_readout(uint8_t stack_id, VmeStack& stack) { return false; }
+  virtual int  daq_read(void* data, size_t bufferSize, size_t* transferCount, int timeout_ms) { return -1; }
+
   virtual void     writeIrqMask(uint8_t mask) {}
   virtual uint8_t      readIrqMask() {return 0xFF;}
 
@@ -1,4 +1,6 @@
 #include "vmusb.h"
+#include <cerrno>
+#include <algorithm>
 #include "custom_logger.h"
 #include <boost/utility/binary.hpp>
 
@@ -360,6 +362,21 @@ void VmUsb::daq_stop() {
   xxusbRegisterWrite(udev, 0, XXUSB_ACTION_STOP);
 }
 
+int VmUsb::daq_read(void* data, size_t bufferSize, size_t* transferCount, int timeout_ms) {
+  *transferCount = 0;
+  if (!udev || !xxusbBulkRead)
+    return -1;
+  short status = xxusbBulkRead(udev, static_cast<char*>(data),
+                               static_cast<short>(std::min<size_t>(bufferSize, 0x7FFF)),
+                               static_cast<short>(timeout_ms));
+  if (status < 0) {
+    errno = -status;
+    return -1;
+  }
+  *transferCount = status;
+  return 0;
+}
+
 void VmUsb::clear_registers() {
   xxusbRegisterWrite(udev, 0, XXUSB_ACTION_CLEAR);
 }
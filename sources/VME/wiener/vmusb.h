@@ -42,6 +42,7 @@ public:
 
   void daq_start();
   void daq_stop();
+  int  daq_read(void* data, size_t bufferSize, size_t* transferCount, int timeout_ms);
 
   virtual void clear_registers();
   virtual void trigger_USB();
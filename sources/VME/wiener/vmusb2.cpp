@@ -82,7 +82,26 @@ bool VmUsb2::daq_init() {
 //                            (CVMUSB::GlobalModeRegister::bufferLen13K <<
 //                                  CVMUSB::GlobalModeRegister::bufferLenShift));
 
+  m_listOffset = 0;
+  return true;
+}
+
+/*!
+  Load a readout stack for autonomous mode, behind any loaded before it
+  since daq_init. Stack 0 runs on NIM 1 trigger, stack 1 is the scaler stack.
+*/
+bool VmUsb2::load_readout(uint8_t stack_id, VmeStack& stack)
+{
+  VmUsbStack* list = dynamic_cast<VmUsbStack*>(&stack);
+  if (!list)
+    return false;
 
+  if (loadList(stack_id, *list, m_listOffset) < 0) {
+    ERR << "<VmUsb> Failed to load stack " << int(stack_id) << ", errno=" << errno;
+    return false;
+  }
+  m_listOffset += list->size();
+  return true;
 }
 
 void VmUsb2::daq_start() {
@@ -638,6 +657,7 @@ VmUsb2::VmUsb2()
   m_handle = nullptr;
   m_timeout = DEFAULT_TIMEOUT;
   m_irqMask = 0xFF;
+  m_listOffset = 0;
 }
 
 VmUsb2::~VmUsb2()
@@ -738,6 +758,7 @@ void VmUsb2::disconnect() {
   m_handle = nullptr;
   m_serialNumber.clear();
   m_irqMask = 0xFF;
+  m_listOffset = 0;
 }
 
 
@@ -74,6 +74,10 @@ public:
   // should call the following function to read acquired data.
   int usbRead(void* data, size_t bufferSize, size_t* transferCount, int timeout = 2000);
 
+  bool load_readout(uint8_t stack_id, VmeStack& stack);
+  int  daq_read(void* data, size_t bufferSize, size_t* transferCount, int timeout_ms)
+    { return usbRead(data, bufferSize, transferCount, timeout_ms); }
+
   void     writeIrqMask(uint8_t mask);
   uint8_t  readIrqMask();
 
@@ -84,6 +88,7 @@ private:
   int                     m_timeout; // Timeout used when user doesn't give one.
 
   uint8_t m_irqMask;
+  off_t   m_listOffset;               // Next free place in stack memory.
 
   void writeActionRegister(uint16_t value);
 
@@ -0,0 +1,105 @@
+/*******************************************************************************
+ *
+ * This software was developed at the National Institute of Standards and
+ * Technology (NIST) by employees of the Federal Government in the course
+ * of their official duties. Pursuant to title 17 Section 105 of the
+ * United States Code, this software is not subject to copyright protection
+ * and is in the public domain. NIST assumes no responsibility whatsoever for
+ * its use by other parties, and makes no guarantees, expressed or implied,
+ * about its quality, reliability, or any other characteristic.
+ *
+ * This software can be redistributed and/or modified freely provided that
+ * any derivative works bear some notice that they are derived from it, and
+ * any modified versions bear some notice that they have been modified.
+ *
+ * Author(s):
+ *      Martin Shetty (NIST)
+ *
+ * Description:
+ *      VmUsbBuffer - layout of VM-USB autonomous mode data buffers
+ *
+ ******************************************************************************/
+
+#include "vmusb_buffer.h"
+#include <algorithm>
+
+const uint16_t VmUsbBuffer::last_buffer;
+const uint16_t VmUsbBuffer::scaler;
+const uint16_t VmUsbBuffer::multi_buffer;
+const uint16_t VmUsbBuffer::count_mask;
+const uint16_t VmUsbBuffer::stack_shift;
+const uint16_t VmUsbBuffer::continuation;
+const uint16_t VmUsbBuffer::terminator;
+
+bool VmUsbBuffer::decode(const uint16_t *data, size_t words16,
+                         std::list<VmUsbEvent> &events, uint16_t &header)
+{
+  if (!words16)
+    return false;
+
+  header = data[0];
+  size_t segments = header & count_mask;
+  size_t idx = 1;
+
+  VmUsbEvent event;
+  bool continuing = false;
+  for (size_t s = 0; s < segments; ++s) {
+    if (idx >= words16)
+      return false;
+    uint16_t event_header = data[idx++];
+    size_t length = event_header & count_mask;
+    if (idx + length > words16)
+      return false;
+
+    if (!continuing) {
+      event.stack_id = event_header >> stack_shift;
+      event.words.clear();
+    }
+
+    size_t end = idx + length;
+    for (; idx + 1 < end; idx += 2)
+      event.words.push_back(data[idx] | (static_cast<uint32_t>(data[idx + 1]) << 16));
+    if (idx < end) //16 bit read last in stack
+      event.words.push_back(data[idx++]);
+
+    continuing = (event_header & continuation);
+    if (!continuing)
+      events.push_back(std::move(event));
+  }
+
+  //events spanning buffers are not enabled in global mode
+  if (continuing)
+    return false;
+
+  return ((idx >= words16) || (data[idx] == terminator));
+}
+
+uint16_t VmUsbBuffer::encode(uint8_t stack_id, const std::vector<uint32_t> &words,
+                             std::vector<uint16_t> &buffer)
+{
+  //whole 32 bit words per segment
+  const size_t max_words = (count_mask / 2);
+  size_t done = 0;
+  uint16_t segments = 0;
+  do {
+    size_t n = std::min(max_words, words.size() - done);
+    uint16_t event_header = (stack_id << stack_shift) | (n * 2);
+    if (done + n < words.size())
+      event_header |= continuation;
+    buffer.push_back(event_header);
+    for (size_t i = done; i < done + n; ++i) {
+      buffer.push_back(words[i] & 0xFFFF);
+      buffer.push_back(words[i] >> 16);
+    }
+    done += n;
+    segments++;
+  } while (done < words.size());
+  return segments;
+}
+
+void VmUsbBuffer::seal(std::vector<uint16_t> &buffer, uint16_t segments, uint16_t flags)
+{
+  buffer.insert(buffer.begin(), (segments & count_mask) | flags);
+  buffer.push_back(terminator);
+  buffer.push_back(terminator);
+}
@@ -0,0 +1,71 @@
+/*******************************************************************************
+ *
+ * This software was developed at the National Institute of Standards and
+ * Technology (NIST) by employees of the Federal Government in the course
+ * of their official duties. Pursuant to title 17 Section 105 of the
+ * United States Code, this software is not subject to copyright protection
+ * and is in the public domain. NIST assumes no responsibility whatsoever for
+ * its use by other parties, and makes no guarantees, expressed or implied,
+ * about its quality, reliability, or any other characteristic.
+ *
+ * This software can be redistributed and/or modified freely provided that
+ * any derivative works bear some notice that they are derived from it, and
+ * any modified versions bear some notice that they have been modified.
+ *
+ * Author(s):
+ *      Martin Shetty (NIST)
+ *
+ * Description:
+ *      VmUsbBuffer - layout of VM-USB autonomous mode data buffers
+ *
+ *      One buffer is a header word, then events, then 0xFFFF terminators,
+ *      all in 16 bit words:
+ *        buffer header   [15] last buffer  [14] scaler  [13] multi-buffer
+ *                        [11:0] number of event segments
+ *        event header    [15:13] stack id  [12] continues in next segment
+ *                        [11:0] number of 16 bit words following
+ *      32 bit reads by a stack come out as low word, then high word.
+ *
+ ******************************************************************************/
+
+#ifndef VMUSB_BUFFER_H
+#define VMUSB_BUFFER_H
+
+#include <vector>
+#include <list>
+#include <cstdint>
+#include <cstddef>
+
+struct VmUsbEvent
+{
+  uint8_t stack_id;
+  std::list<uint32_t> words;
+};
+
+class VmUsbBuffer
+{
+public:
+  static const uint16_t last_buffer  = 0x8000;
+  static const uint16_t scaler       = 0x4000;
+  static const uint16_t multi_buffer = 0x2000;
+  static const uint16_t count_mask   = 0x0FFF;
+
+  static const uint16_t stack_shift  = 13;
+  static const uint16_t continuation = 0x1000;
+  static const uint16_t terminator   = 0xFFFF;
+
+  //complete events appended to events; false if buffer is malformed,
+  //events decoded before the problem are kept
+  static bool decode(const uint16_t *data, size_t words16,
+                     std::list<VmUsbEvent> &events, uint16_t &header);
+
+  //one event as a stack would leave it, segmented if longer than 12 bits count;
+  //returns number of segments, which buffer header counts
+  static uint16_t encode(uint8_t stack_id, const std::vector<uint32_t> &words,
+                         std::vector<uint16_t> &buffer);
+
+  //header in front, terminator behind events already in buffer
+  static void seal(std::vector<uint16_t> &buffer, uint16_t segments, uint16_t flags = 0);
+};
+
+#endif
@@ -0,0 +1,232 @@
+/*******************************************************************************
+ *
+ * This software was developed at the National Institute of Standards and
+ * Technology (NIST) by employees of the Federal Government in the course
+ * of their official duties. Pursuant to title 17 Section 105 of the
+ * United States Code, this software is not subject to copyright protection
+ * and is in the public domain. NIST assumes no responsibility whatsoever for
+ * its use by other parties, and makes no guarantees, expressed or implied,
+ * about its quality, reliability, or any other characteristic.
+ *
+ * This software can be redistributed and/or modified freely provided that
+ * any derivative works bear some notice that they are derived from it, and
+ * any modified versions bear some notice that they have been modified.
+ *
+ * Author(s):
+ *      Martin Shetty (NIST)
+ *
+ * Description:
+ *      VmUsbSim - stand-in for a VM-USB and a crate of Mesytec modules
+ *
+ ******************************************************************************/
+
+#include "vmusb_sim.h"
+#include <algorithm>
+#include <cstring>
+#include "vmusb_buffer.h"
+#include "custom_timer.h"
+#include "custom_logger.h"
+
+//as in Mesytec settings files, offsets from module base
+static const uint32_t MesytecFirmware = 0x600E;
+static const uint32_t MesytecStartAcq = 0x603A;
+
+static const uint16_t MADC32_Firmware = 0x0203;
+static const uint16_t MTDC32_Firmware = 0x0105;
+
+//most words one module adds to an event: header, 3 hits, footer
+static const size_t max_module_words = 5;
+
+VmUsbSim::VmUsbSim()
+  : connected_(false)
+  , running_(false)
+  , flush_(false)
+  , loaded_(false)
+  , rate_(0)
+  , triggers_(0)
+  , hits_(0)
+  , clock_(0)
+  , rng_(1)
+{
+  add_madc32(0x00000000);
+  add_mtdc32(0x10000000);
+}
+
+void VmUsbSim::systemReset()
+{
+  boost::unique_lock<boost::mutex> lock(mutex_);
+  registers_.clear();
+  running_ = flush_ = loaded_ = false;
+}
+
+void VmUsbSim::clear_modules()
+{
+  boost::unique_lock<boost::mutex> lock(mutex_);
+  modules_.clear();
+  memory_.clear();
+}
+
+void VmUsbSim::add_madc32(uint32_t base)
+{
+  add_module(base, MADC32_Firmware, false);
+}
+
+void VmUsbSim::add_mtdc32(uint32_t base)
+{
+  add_module(base, MTDC32_Firmware, true);
+}
+
+void VmUsbSim::add_module(uint32_t base, uint16_t firmware, bool tdc)
+{
+  boost::unique_lock<boost::mutex> lock(mutex_);
+  memory_[base + MesytecFirmware] = firmware;
+  modules_.push_back(Module{base, tdc});
+}
+
+void VmUsbSim::write16(uint32_t vmeAddress, AddressModifier am, uint16_t data)
+{
+  boost::unique_lock<boost::mutex> lock(mutex_);
+  memory_[vmeAddress] = data;
+}
+
+uint16_t VmUsbSim::read16(uint32_t vmeAddress, AddressModifier am)
+{
+  boost::unique_lock<boost::mutex> lock(mutex_);
+  if (memory_.count(vmeAddress))
+    return memory_.at(vmeAddress);
+  return 0;
+}
+
+void VmUsbSim::write32(uint32_t vmeAddress, AddressModifier am, uint32_t data)
+{
+  write16(vmeAddress, am, data & 0xFFFF);
+  write16(vmeAddress + 2, am, data >> 16);
+}
+
+uint32_t VmUsbSim::read32(uint32_t vmeAddress, AddressModifier am)
+{
+  return read16(vmeAddress, am) | (static_cast<uint32_t>(read16(vmeAddress + 2, am)) << 16);
+}
+
+void VmUsbSim::writeRegister(uint16_t vmeAddress, uint32_t data)
+{
+  boost::unique_lock<boost::mutex> lock(mutex_);
+  registers_[vmeAddress] = data;
+}
+
+uint32_t VmUsbSim::readRegister(uint16_t vmeAddress)
+{
+  boost::unique_lock<boost::mutex> lock(mutex_);
+  if (registers_.count(vmeAddress))
+    return registers_.at(vmeAddress);
+  return 0;
+}
+
+bool VmUsbSim::daq_init()
+{
+  boost::unique_lock<boost::mutex> lock(mutex_);
+  running_ = flush_ = loaded_ = false;
+  triggers_ = hits_ = 0;
+  return connected_;
+}
+
+void VmUsbSim::daq_start()
+{
+  boost::unique_lock<boost::mutex> lock(mutex_);
+  if (!loaded_)
+    WARN << "<VmUsbSim> Starting without readout stack, buffers will be empty";
+  start_ = boost::posix_time::microsec_clock::universal_time();
+  running_ = true;
+  flush_ = false;
+}
+
+void VmUsbSim::daq_stop()
+{
+  boost::unique_lock<boost::mutex> lock(mutex_);
+  if (running_)
+    flush_ = true;
+  running_ = false;
+}
+
+bool VmUsbSim::load_readout(uint8_t stack_id, VmeStack& stack)
+{
+  //stack content is not interpreted, modules started by their own registers
+  boost::unique_lock<boost::mutex> lock(mutex_);
+  if (stack_id == 0)
+    loaded_ = (dynamic_cast<VmUsbStack*>(&stack) != nullptr);
+  return loaded_;
+}
+
+void VmUsbSim::trigger(std::vector<uint32_t> &words)
+{
+  std::exponential_distribution<double> gap(0.05);
+  clock_ += 1 + static_cast<uint64_t>(gap(rng_));
+  triggers_++;
+
+  for (auto &m : modules_) {
+    if (!memory_.count(m.base + MesytecStartAcq) || (memory_.at(m.base + MesytecStartAcq) != 1))
+      continue;
+
+    size_t header = words.size();
+    uint32_t module_id = (m.base >> 24) & 0xFF;
+    words.push_back(0x40000000 | (module_id << 16) | ((m.tdc ? 0 : 4) << 12));
+
+    uint32_t chans = 1 + rng_() % (max_module_words - 2);
+    uint32_t first = rng_() % 32;
+    for (uint32_t i = 0; i < chans; ++i) {
+      uint32_t chan = (first + i) % 32;
+      uint32_t value = m.tdc ? (rng_() & 0xFFFF) : (rng_() & 0x1FFF);
+      words.push_back(0x04000000 | (chan << 16) | value);
+    }
+    hits_ += chans;
+
+    words.push_back(0xC0000000 | (clock_ & 0x3FFFFFFF));
+    words[header] |= (chans + 1);
+  }
+}
+
+int VmUsbSim::daq_read(void* data, size_t bufferSize, size_t* transferCount, int timeout_ms)
+{
+  *transferCount = 0;
+  std::vector<uint16_t> buffer;
+  uint16_t segments = 0;
+  bool last = false;
+
+  {
+    boost::unique_lock<boost::mutex> lock(mutex_);
+    if (running_ && loaded_) {
+      uint64_t due = -1;
+      if (rate_ > 0) {
+        double elapsed = (boost::posix_time::microsec_clock::universal_time() - start_).total_microseconds() * 0.000001;
+        uint64_t total = static_cast<uint64_t>(rate_ * elapsed);
+        due = (total > triggers_) ? (total - triggers_) : 0;
+      }
+
+      //header, event header and terminators around largest event
+      size_t max_event16 = 2 * max_module_words * modules_.size() + 4;
+      std::vector<uint32_t> words;
+      while (due && (segments < VmUsbBuffer::count_mask)
+             && ((buffer.size() + max_event16) * sizeof(uint16_t) <= bufferSize)) {
+        words.clear();
+        trigger(words);
+        due--;
+        if (words.empty())
+          break;
+        segments += VmUsbBuffer::encode(0, words, buffer);
+      }
+    }
+    last = flush_;
+    flush_ = false;
+  }
+
+  if (!segments && !last) {
+    wait_ms(std::min(timeout_ms, 10));
+    return 0;
+  }
+
+  VmUsbBuffer::seal(buffer, segments, last ? VmUsbBuffer::last_buffer : 0);
+  size_t bytes = std::min(bufferSize, buffer.size() * sizeof(uint16_t));
+  memcpy(data, buffer.data(), bytes);
+  *transferCount = bytes;
+  return 0;
+}
@@ -0,0 +1,100 @@
+/*******************************************************************************
+ *
+ * This software was developed at the National Institute of Standards and
+ * Technology (NIST) by employees of the Federal Government in the course
+ * of their official duties. Pursuant to title 17 Section 105 of the
+ * United States Code, this software is not subject to copyright protection
+ * and is in the public domain. NIST assumes no responsibility whatsoever for
+ * its use by other parties, and makes no guarantees, expressed or implied,
+ * about its quality, reliability, or any other characteristic.
+ *
+ * This software can be redistributed and/or modified freely provided that
+ * any derivative works bear some notice that they are derived from it, and
+ * any modified versions bear some notice that they have been modified.
+ *
+ * Author(s):
+ *      Martin Shetty (NIST)
+ *
+ * Description:
+ *      VmUsbSim - stand-in for a VM-USB and a crate of Mesytec modules,
+ *                 for running the VME acquisition without hardware
+ *
+ ******************************************************************************/
+
+#ifndef VMUSB_SIM_H
+#define VMUSB_SIM_H
+
+#include <map>
+#include <vector>
+#include <random>
+#include <boost/thread/mutex.hpp>
+#include <boost/date_time/posix_time/posix_time.hpp>
+
+#include "../vmecontroller.h"
+#include "vmusb_stack.h"
+
+class VmUsbSim : public VmeController
+{
+public:
+  //MADC32 at 0x00000000 and MTDC32 at 0x10000000, triggered as fast as read
+  VmUsbSim();
+
+  std::string controllerName(void) { return "VM-USB (simulated)"; }
+  std::string serialNumber(void) { return "SIM"; }
+  bool connect(uint16_t target) { connected_ = true; return true; }
+  bool connect(std::string target) { return connect(uint16_t(0)); }
+  bool connected() { return connected_; }
+  void systemReset();
+
+  VmeStack* newStack() { return new VmUsbStack(); }
+
+  void       write16(uint32_t vmeAddress, AddressModifier am, uint16_t data);
+  uint16_t    read16(uint32_t vmeAddress, AddressModifier am);
+
+  void        write32(uint32_t vmeAddress, AddressModifier am, uint32_t data);
+  uint32_t     read32(uint32_t vmeAddress, AddressModifier am);
+
+  void    writeRegister(uint16_t vmeAddress, uint32_t data);
+  uint32_t readRegister(uint16_t vmeAddress);
+
+  bool daq_init();
+  void daq_start();
+  void daq_stop();
+
+  bool load_readout(uint8_t stack_id, VmeStack& stack);
+  int  daq_read(void* data, size_t bufferSize, size_t* transferCount, int timeout_ms);
+
+  //crate contents; a module answers with its firmware code and, once its
+  //acquisition is started, adds its data to every triggered event
+  void clear_modules();
+  void add_madc32(uint32_t base);
+  void add_mtdc32(uint32_t base);
+
+  //triggers per second, 0 to fill every buffer read
+  void set_rate(double rate) { rate_ = rate; }
+  uint64_t triggers() const { return triggers_; }
+  uint64_t hits() const { return hits_; }
+
+private:
+  struct Module {
+    uint32_t base;
+    bool tdc;
+  };
+
+  boost::mutex mutex_;
+  std::map<uint32_t, uint16_t> memory_;
+  std::map<uint16_t, uint32_t> registers_;
+  std::vector<Module> modules_;
+
+  bool connected_;
+  bool running_, flush_, loaded_;
+  double rate_;
+  uint64_t triggers_, hits_, clock_;
+  boost::posix_time::ptime start_;
+  std::mt19937 rng_;
+
+  void add_module(uint32_t base, uint16_t firmware, bool tdc);
+  void trigger(std::vector<uint32_t> &words);
+};
+
+#endif
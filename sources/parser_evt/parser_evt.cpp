@@ -329,7 +329,7 @@ void ParserEVT::worker_run(ParserEVT* callback, SynchronizedQueue<Spill*>* spill
   uint64_t count = 0;
   uint64_t events = 0;
   uint64_t lost_events = 0;
-  uint64_t last_time = 0;
+  TimeUnwrap clock(MADC32::footer_time_bits, MADC32::footer_max_jump);
 
   CFileDataSource* evt_file = nullptr;
   CRingItem* item = nullptr;
@@ -465,7 +465,7 @@ void ParserEVT::worker_run(ParserEVT* callback, SynchronizedQueue<Spill*>* spill
               }
 
               std::string madc_pattern;
-              std::list<Hit> hits = Qpx::MADC32::parse(MADC_data, events, last_time, madc_pattern);
+              std::list<Hit> hits = Qpx::MADC32::parse(MADC_data, events, clock, madc_pattern);
 
               for (auto &h : hits) {
                 if (!starts_signalled.count(h.source_channel())) {
@@ -540,7 +540,7 @@ void ParserEVT::worker_run(ParserEVT* callback, SynchronizedQueue<Spill*>* spill
              << (100.0 * count / callback->expected_rbuf_items_) << "%  cumulative hits = " << events
              << "   hits lost in bad buffers = " << lost_events
              << " (" << 100.0*lost_events/(events + lost_events) << "%)"
-             << " recent timestamp = " << boost::posix_time::to_iso_extended_string(ts) ;//"  last time_upper = " << (last_time & 0xffffffffc0000000);
+             << " recent timestamp = " << boost::posix_time::to_iso_extended_string(ts) << "  " << clock.to_string();
 
 
 
@@ -42,6 +42,7 @@ ParserRaw::ParserRaw() {
 
   loop_data_ = false;
   override_timestamps_= false;
+  chunked_ = false;
 }
 
 bool ParserRaw::die() {
@@ -49,8 +50,12 @@ bool ParserRaw::die() {
     file_bin_.close();
 
   source_file_bin_.clear();
+  list_file_.close();
+  chunked_ = false;
 
   spills_.clear();
+  hit_counts_.clear();
+  bin_offsets_.clear();
   bin_begin_ = 0;
   bin_end_ = 0;
 
@@ -133,7 +138,7 @@ bool ParserRaw::read_settings_bulk(Qpx::Setting &set) const {
       else if ((q.metadata.setting_type == Qpx::SettingType::integer) && (q.id_ == "ParserRaw/Spills"))
         q.value_int = spills_.size();
       else if ((q.metadata.setting_type == Qpx::SettingType::integer) && (q.id_ == "ParserRaw/Hits"))
-        q.value_int = (bin_end_ - bin_begin_) / 12;
+        q.value_int = chunked_ ? list_file_.total_hits() : (bin_end_ - bin_begin_) / 12;
       else if ((q.metadata.setting_type == Qpx::SettingType::time) && (q.id_ == "ParserRaw/StartTime")) {
         if (!spills_.empty())
           q.value_time = spills_.front().time;
@@ -177,6 +182,9 @@ bool ParserRaw::boot() {
 
   status_ = SourceStatus::loaded | SourceStatus::can_boot;
 
+  if (ListFileReader::is_list_file(source_file_))
+    return boot_list_file();
+
   pugi::xml_document doc;
 
   if (!doc.load_file(source_file_.c_str())) {
@@ -251,6 +259,25 @@ bool ParserRaw::boot() {
 }
 
 
+bool ParserRaw::boot_list_file() {
+  if (!list_file_.open(source_file_) || !list_file_.size()) {
+    WARN << "<ParserRaw> No spills in " << source_file_;
+    list_file_.close();
+    return false;
+  }
+
+  for (size_t i=0; i < list_file_.size(); ++i) {
+    spills_.push_back(list_file_.spill(i));
+    hit_counts_.push_back(list_file_.hit_count(i));
+  }
+
+  chunked_ = true;
+  current_spill_ = 0;
+  source_file_bin_ = source_file_;
+  status_ = SourceStatus::loaded | SourceStatus::booted | SourceStatus::can_run;
+  return true;
+}
+
 void ParserRaw::get_all_settings() {
   if (status_ & SourceStatus::booted) {
   }
@@ -326,7 +353,16 @@ Spill ParserRaw::get_spill() {
   one_spill = spills_.at(current_spill_);
 
   //      DBG << "<Sorter> will produce no of events " << spills_.front().events_in_spill;
-  if (hit_counts_.at(current_spill_) > 0)
+  if (chunked_)
+  {
+    //stats are written with the spill that carried the hits
+    for (auto &s : one_spill.stats)
+      hitmodels_[s.second.source_channel] = s.second.model_hit;
+    if (!list_file_.read_hits(current_spill_, hitmodels_, one_spill.hits))
+      WARN << "<ParserRaw> Only " << one_spill.hits.size() << " of "
+           << hit_counts_.at(current_spill_) << " hits readable in spill " << current_spill_;
+  }
+  else if (hit_counts_.at(current_spill_) > 0)
   {
     file_bin_.seekg(bin_offsets_.at(current_spill_), std::ios::beg);
     for (size_t i = 0; i < hit_counts_.at(current_spill_); ++i)
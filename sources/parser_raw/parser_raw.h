@@ -25,6 +25,7 @@
 
 #include "daq_source.h"
 #include "detector.h"
+#include "list_file.h"
 #include <boost/thread.hpp>
 #include <boost/atomic.hpp>
 
@@ -82,7 +83,12 @@ protected:
   std::ifstream  file_bin_;
   std::streampos bin_begin_, bin_end_;
 
+  //chunked list mode (qpx_out.qls), legacy is xml index + qpx_out.bin
+  bool chunked_;
+  ListFileReader list_file_;
+
   Spill get_spill();
+  bool boot_list_file();
 
 
 };
@@ -27,6 +27,7 @@
 #include "custom_logger.h"
 #include "custom_timer.h"
 #include "daq_source_factory.h"
+#include "spill_capture.h"
 
 //XIA stuff:
 #include <string.h>
@@ -43,6 +44,9 @@ namespace Qpx {
 
 static SourceRegistrar<Pixie4> registrar("Pixie4");
 
+//replay reads captures faster than they parse, hold it this many spills ahead
+static const size_t replay_queue_spills = 16;
+
 Pixie4::Pixie4() {
   boot_files_.resize(7);
   system_parameter_values_.resize(N_SYSTEM_PAR, 0.0);
@@ -51,6 +55,8 @@ Pixie4::Pixie4() {
 
   run_poll_interval_ms_ = 100;
   run_type_ = 0x103;
+  keep_raw_ = false;
+  replaying_ = false;
 
   status_ = SourceStatus::loaded | SourceStatus::can_boot;
 
@@ -106,7 +112,7 @@ bool Pixie4::daq_start(SynchronizedQueue<Spill*>* out_queue) {
   run_status_.store(1);
 
 
-  for (size_t i=0; i < channel_indices_.size(); ++i)
+  for (size_t i=0; !replaying_ && (i < channel_indices_.size()); ++i)
   {
     //DBG << "start daq run mod " << i;
     for (auto &q : channel_indices_[i])
@@ -115,7 +121,8 @@ bool Pixie4::daq_start(SynchronizedQueue<Spill*>* out_queue) {
     set_mod("MAX_EVENTS",  static_cast<double>(0), Module(i));
   }
 
-  raw_queue_ = new SynchronizedQueue<Spill*>();
+  //live readout must never block on the parser, replay may
+  raw_queue_ = new SynchronizedQueue<Spill*>(replaying_ ? replay_queue_spills : 0);
 
   if (parser_ != nullptr)
     delete parser_;
@@ -123,7 +130,10 @@ bool Pixie4::daq_start(SynchronizedQueue<Spill*>* out_queue) {
 
   if (runner_ != nullptr)
     delete runner_;
-  runner_ = new boost::thread(&worker_run_dbl, this, raw_queue_);
+  if (replaying_)
+    runner_ = new boost::thread(&worker_replay, this, raw_queue_);
+  else
+    runner_ = new boost::thread(&worker_run_dbl, this, raw_queue_);
 
   return true;
 }
@@ -204,6 +214,12 @@ bool Pixie4::read_settings_bulk(Qpx::Setting &set) const {
           k.value_int = run_type_;
         if ((k.metadata.setting_type == Qpx::SettingType::integer) && (k.id_ == "Pixie4/Poll interval"))
           k.value_int = run_poll_interval_ms_;
+        if ((k.metadata.setting_type == Qpx::SettingType::boolean) && (k.id_ == "Pixie4/Run settings/Keep raw buffers"))
+          k.value_int = keep_raw_;
+        if ((k.metadata.setting_type == Qpx::SettingType::file_path) && (k.id_ == "Pixie4/Run settings/Replay file")) {
+          k.value_text = replay_file_;
+          k.metadata.writable = !(status_ & SourceStatus::booted);
+        }
       }
     } else if ((q.metadata.setting_type == Qpx::SettingType::stem) && (q.id_ == "Pixie4/Files")) {
       for (auto &k : q.branches.my_data_) {
@@ -461,6 +477,10 @@ bool Pixie4::write_settings_bulk(Qpx::Setting &set) {
           run_type_ = k.value_int;
         else if (k.id_ == "Pixie4/Run settings/Poll interval")
           run_poll_interval_ms_ = k.value_int;
+        else if (k.id_ == "Pixie4/Run settings/Keep raw buffers")
+          keep_raw_ = k.value_int;
+        else if ((k.id_ == "Pixie4/Run settings/Replay file") && !(status_ & SourceStatus::booted))
+          replay_file_ = k.value_text;
       }
     } else if ((q.metadata.setting_type == Qpx::SettingType::stem) && (q.id_ == "Pixie4/System")) {
       if (!(status_ & SourceStatus::booted))
@@ -541,6 +561,19 @@ bool Pixie4::boot() {
   }
 
   status_ = SourceStatus::loaded | SourceStatus::can_boot;
+  replaying_ = false;
+
+  if (!replay_file_.empty()) {
+    SpillCaptureReader capture;
+    if (!capture.open(replay_file_) || !capture.size()) {
+      ERR << "<Pixie4> Nothing to replay in " << replay_file_;
+      return false;
+    }
+    LINFO << "<Pixie4> Replaying " << capture.size() << " captured spills, no hardware will be accessed";
+    replaying_ = true;
+    status_ = SourceStatus::loaded | SourceStatus::booted | SourceStatus::can_run;
+    return true;
+  }
 
   S32 retval;
   set_sys("OFFLINE_ANALYSIS", 0);  //attempt live boot first
@@ -628,13 +661,22 @@ std::list<Hit> Pixie4::oscilloscope() {
 
 
 void Pixie4::get_all_settings() {
-  if (status_ & SourceStatus::booted) {
+  if ((status_ & SourceStatus::booted) && !replaying_) {
     get_sys_all();
     get_mod_all(Module::all);
     get_chan_all(Channel::all, Module::all);
   }
 }
 
+void Pixie4::get_volatile_settings() {
+  //only read-only readbacks change on their own (LIVE_TIME, INPUT_COUNT_RATE,
+  //FAST_PEAKS, RUN_TIME...), writable parameters hold what was last written
+  if ((status_ & SourceStatus::booted) && !replaying_) {
+    get_mod_stats(Module::all);
+    get_chan_stats(Channel::all, Module::all);
+  }
+}
+
 
 void Pixie4::reset_counters_next_run() {
   for (size_t i=0; i < channel_indices_.size(); ++i) {
@@ -1422,137 +1464,238 @@ void Pixie4::worker_run_dbl(Pixie4* callback, SynchronizedQueue<Spill*>* spill_q
 
 
 
-void Pixie4::worker_parse (Pixie4* callback, SynchronizedQueue<Spill*>* in_queue, SynchronizedQueue<Spill*>* out_queue) {
+namespace {
 
-//  DBG << "<Pixie4> parser thread starting";
+//module buffers decode out of order, spills leave in the order they came
+struct ParseJob {
+  uint64_t sequence;
+  Spill*   spill;
+};
 
-  Spill* spill;
-  std::vector<std::vector<int32_t>> channel_indices = callback->channel_indices_;
+class ParseSequencer {
+public:
+  ParseSequencer(SynchronizedQueue<Spill*>* out_queue)
+    : out_queue_(out_queue), next_(0), events_(0), cycles_(0), parse_us_(0) {}
 
-  uint64_t all_events = 0, cycles = 0;
-  CustomTimer parse_timer;
-  HitModel model = callback->model_hit();
+  void done(const ParseJob &job, uint64_t events, bool parsed, double us) {
+    boost::unique_lock<boost::mutex> lock(mutex_);
+    finished_[job.sequence] = job.spill;
+    events_ += events;
+    if (parsed)
+      cycles_++;
+    parse_us_ += us;
+    while (!finished_.empty() && (finished_.begin()->first == next_)) {
+      out_queue_->enqueue(finished_.begin()->second);
+      finished_.erase(finished_.begin());
+      next_++;
+    }
+  }
 
-  while ((spill = in_queue->dequeue()) != NULL ) {
-    parse_timer.resume();
-
-    if (spill->data.size() > 0) {
-      cycles++;
-      uint16_t* buff16 = (uint16_t*) spill->data.data();
-      uint32_t idx = 0, buf_end, spill_events = 0;
-
-      while (true) {
-        uint16_t buf_ndata  = buff16[idx++];
-        uint32_t buf_end = idx + buf_ndata - 1;
-
-        if (   (buf_ndata == 0)
-               || (buf_ndata > max_buf_len)
-               || (buf_end   > list_mem_len16))
-          break;
-
-        uint16_t buf_module = buff16[idx++];
-        uint16_t buf_format = buff16[idx++];
-        uint16_t buf_timehi = buff16[idx++];
-        uint16_t buf_timemi = buff16[idx++];
-        idx++; //uint16_t buf_timelo = buff16[idx++]; unused
-        uint16_t task_a = (buf_format & 0x0F00);
-        uint16_t task_b = (buf_format & 0x000F);
-
-        while ((task_a == 0x0100) && (idx < buf_end)) {
-
-          std::bitset<16> pattern (buff16[idx++]);
-
-          uint16_t evt_time_hi = buff16[idx++];
-          uint16_t evt_time_lo = buff16[idx++];
-
-          std::multiset<Hit> ordered;
-
-          for (size_t i=0; i < NUMBER_OF_CHANNELS; i++) {
-            if (!pattern[i])
-              continue;
-
-            int16_t sourcechan = -1;
-            if ((buf_module < channel_indices.size()) &&
-                (i < channel_indices[buf_module].size()) &&
-                (channel_indices[buf_module][i] >= 0))
-              sourcechan = channel_indices[buf_module][i];
-
-            Hit one_hit(sourcechan, model);
-
-            uint64_t hi = buf_timehi;
-            uint64_t mi = evt_time_hi;
-            uint64_t lo = evt_time_lo;
-            uint16_t chan_trig_time = lo;
-            uint16_t chan_time_hi   = hi;
-
-            one_hit.set_value(1, pattern[4]); //Front panel input value
-
-            if (task_b == 0x0000) {
-              uint16_t trace_len  = buff16[idx++] - 9;
-              one_hit.set_value(0, buff16[idx++]); //energy
-              one_hit.set_value(2, buff16[idx++]); //XIA_PSA
-              one_hit.set_value(3, buff16[idx++]); //user_PSA
-              idx += 3;
-              hi                  = buff16[idx++]; //not always?
-              one_hit.set_trace(std::vector<uint16_t>(buff16 + idx, buff16 + idx + trace_len));
-              idx += trace_len;
-            } else if (task_b == 0x0001) {
-              idx++;
-              chan_trig_time      = buff16[idx++];
-              one_hit.set_value(0, buff16[idx++]); //energy
-              one_hit.set_value(2, buff16[idx++]); //XIA_PSA
-              one_hit.set_value(3, buff16[idx++]); //user_PSA
-              idx += 3;
-              hi                  = buff16[idx++];
-            } else if (task_b == 0x0002) {
-              chan_trig_time      = buff16[idx++];
-              one_hit.set_value(0, buff16[idx++]); //energy
-              one_hit.set_value(2, buff16[idx++]); //XIA_PSA
-              one_hit.set_value(3, buff16[idx++]); //user_PSA
-            } else if (task_b == 0x0003) {
-              chan_trig_time      = buff16[idx++];
-              one_hit.set_value(0, buff16[idx++]); //energy
-            } else
-              ERR << "<Pixie4::parser> Parsed event type invalid or does not match run type";
+  uint64_t events() const { return events_; }
+  uint64_t cycles() const { return cycles_; }
+  double parse_us() const { return parse_us_; }
 
-            if (!pattern[i+8])
-              one_hit.set_value(0, 0); //energy invalid or approximate
+private:
+  SynchronizedQueue<Spill*>* out_queue_;
+  boost::mutex mutex_;
+  std::map<uint64_t, Spill*> finished_;
+  uint64_t next_;
+  uint64_t events_, cycles_;
+  double parse_us_;
+};
 
-            //Corrections for overflow, page 30 in Pixie-4 user manual
-            if (chan_trig_time > evt_time_lo)
-              mi--;
-            if (evt_time_hi < buf_timemi)
-              hi++;
-            if ((task_b == 0x0000) || (task_b == 0x0001))
-              hi = chan_time_hi;
-            lo = chan_trig_time;
-            uint64_t time = (hi << 32) + (mi << 16) + lo;
+}
 
-            one_hit.set_timestamp_native(time);
+//feeds captured buffers to the parser as fast as it takes them
+void Pixie4::worker_replay(Pixie4* callback, SynchronizedQueue<Spill*>* spill_queue) {
+  SpillCaptureReader capture;
+  if (!capture.open(callback->replay_file_)) {
+    callback->run_status_.store(3);
+    return;
+  }
 
-            if (sourcechan >= 0)
-              ordered.insert(one_hit);
-          }
+  CustomTimer replay_timer(true);
+  uint64_t words = 0;
+  size_t i = 0;
+  for (; (i < capture.size()) && (callback->run_status_.load() != 2); ++i) {
+    Spill* spill = new Spill;
+    if (!capture.read(i, *spill)) {
+      ERR << "<Pixie4::replay> Could not read spill " << i << " of " << callback->replay_file_;
+      delete spill;
+      break;
+    }
+    spill->hits.clear();
+    words += spill->data.size();
+    spill_queue->enqueue(spill);
+  }
 
-          for (auto &q : ordered) {
-            spill->hits.push_back(q);
-            spill_events++;
-          }
+  DBG << "<Pixie4::replay> Replayed " << i << " spills, " << words << " words in " << replay_timer.ms() << " ms";
+  callback->run_status_.store(3);
+}
 
-        };
+void Pixie4::worker_parse (Pixie4* callback, SynchronizedQueue<Spill*>* in_queue, SynchronizedQueue<Spill*>* out_queue) {
+
+//  DBG << "<Pixie4> parser thread starting";
+
+  std::vector<std::vector<int32_t>> channel_indices = callback->channel_indices_;
+  HitModel model = callback->model_hit();
+  bool keep_raw = callback->keep_raw_;
+
+  //runner enqueues one spill per module and cycle, so modules decode side by side
+  size_t workers = std::min<size_t>(std::max<size_t>(channel_indices.size(), 1),
+                                    std::max<unsigned>(boost::thread::hardware_concurrency(), 1));
+
+  //bounded, so a bounded in_queue actually holds its producer back
+  SynchronizedQueue<ParseJob*> jobs(2 * workers);
+  ParseSequencer sequencer(out_queue);
+
+  boost::thread_group decoders;
+  for (size_t i=0; i < workers; ++i)
+    decoders.create_thread([&jobs, &sequencer, &channel_indices, &model, keep_raw] {
+      ParseJob* job;
+      while ((job = jobs.dequeue()) != NULL) {
+        CustomTimer parse_timer(true);
+        bool parsed = !job->spill->data.empty();
+        uint64_t events = parse_spill(job->spill, channel_indices, model);
+        if (!keep_raw)
+          job->spill->data.clear();
+        sequencer.done(*job, events, parsed, parse_timer.us());
+        delete job;
       }
-      all_events += spill_events;
-    }
-    spill->data.clear();
-    out_queue->enqueue(spill);
-    parse_timer.stop();
-  }
+    });
 
-  if (cycles == 0)
+  Spill* spill;
+  uint64_t sequence = 0;
+  while ((spill = in_queue->dequeue()) != NULL)
+    jobs.enqueue(new ParseJob{sequence++, spill});
+
+  //one terminator per decoder, queued behind any remaining jobs
+  for (size_t i=0; i < workers; ++i)
+    jobs.enqueue(NULL);
+  decoders.join_all();
+
+  if (sequencer.cycles() == 0)
     DBG << "<Pixie4::parser> Buffer queue closed without events";
   else
-    DBG << "<Pixie4::parser> Parsed " << all_events << " events, with avg time/spill: " << parse_timer.us()/cycles << "us";
+    DBG << "<Pixie4::parser> Parsed " << sequencer.events() << " events with "
+        << workers << " decoders, avg time/spill: " << sequencer.parse_us()/sequencer.cycles() << "us";
 }
 
+uint64_t Pixie4::parse_spill(Spill* spill,
+                             const std::vector<std::vector<int32_t>> &channel_indices,
+                             const HitModel &model) {
+  if (spill->data.empty())
+    return 0;
+
+  uint16_t* buff16 = (uint16_t*) spill->data.data();
+  uint32_t idx = 0, spill_events = 0;
+
+  while (true) {
+    uint16_t buf_ndata  = buff16[idx++];
+    uint32_t buf_end = idx + buf_ndata - 1;
+
+    if (   (buf_ndata == 0)
+           || (buf_ndata > max_buf_len)
+           || (buf_end   > list_mem_len16))
+      break;
+
+    uint16_t buf_module = buff16[idx++];
+    uint16_t buf_format = buff16[idx++];
+    uint16_t buf_timehi = buff16[idx++];
+    uint16_t buf_timemi = buff16[idx++];
+    idx++; //uint16_t buf_timelo = buff16[idx++]; unused
+    uint16_t task_a = (buf_format & 0x0F00);
+    uint16_t task_b = (buf_format & 0x000F);
+
+    const std::vector<int32_t>* module_channels = nullptr;
+    if (buf_module < channel_indices.size())
+      module_channels = &channel_indices[buf_module];
+
+    while ((task_a == 0x0100) && (idx < buf_end)) {
+
+      std::bitset<16> pattern (buff16[idx++]);
+
+      uint16_t evt_time_hi = buff16[idx++];
+      uint16_t evt_time_lo = buff16[idx++];
+
+      //hits are built in place, then the event is ordered and moved in without copying
+      std::list<Hit> ordered;
+
+      for (size_t i=0; i < NUMBER_OF_CHANNELS; i++) {
+        if (!pattern[i])
+          continue;
+
+        int16_t sourcechan = -1;
+        if (module_channels &&
+            (i < module_channels->size()) &&
+            ((*module_channels)[i] >= 0))
+          sourcechan = (*module_channels)[i];
+
+        ordered.emplace_back(sourcechan, model);
+        Hit &one_hit = ordered.back();
+
+        uint64_t hi = buf_timehi;
+        uint64_t mi = evt_time_hi;
+        uint64_t lo = evt_time_lo;
+        uint16_t chan_trig_time = lo;
+        uint16_t chan_time_hi   = hi;
+
+        one_hit.set_value(1, pattern[4]); //Front panel input value
+
+        if (task_b == 0x0000) {
+          uint16_t trace_len  = buff16[idx++] - 9;
+          one_hit.set_value(0, buff16[idx++]); //energy
+          one_hit.set_value(2, buff16[idx++]); //XIA_PSA
+          one_hit.set_value(3, buff16[idx++]); //user_PSA
+          idx += 3;
+          hi                  = buff16[idx++]; //not always?
+          one_hit.set_trace(buff16 + idx, trace_len);
+          idx += trace_len;
+        } else if (task_b == 0x0001) {
+          idx++;
+          chan_trig_time      = buff16[idx++];
+          one_hit.set_value(0, buff16[idx++]); //energy
+          one_hit.set_value(2, buff16[idx++]); //XIA_PSA
+          one_hit.set_value(3, buff16[idx++]); //user_PSA
+          idx += 3;
+          hi                  = buff16[idx++];
+        } else if (task_b == 0x0002) {
+          chan_trig_time      = buff16[idx++];
+          one_hit.set_value(0, buff16[idx++]); //energy
+          one_hit.set_value(2, buff16[idx++]); //XIA_PSA
+          one_hit.set_value(3, buff16[idx++]); //user_PSA
+        } else if (task_b == 0x0003) {
+          chan_trig_time      = buff16[idx++];
+          one_hit.set_value(0, buff16[idx++]); //energy
+        } else
+          ERR << "<Pixie4::parser> Parsed event type invalid or does not match run type";
+
+        if (!pattern[i+8])
+          one_hit.set_value(0, 0); //energy invalid or approximate
+
+        //Corrections for overflow, page 30 in Pixie-4 user manual
+        if (chan_trig_time > evt_time_lo)
+          mi--;
+        if (evt_time_hi < buf_timemi)
+          hi++;
+        if ((task_b == 0x0000) || (task_b == 0x0001))
+          hi = chan_time_hi;
+        lo = chan_trig_time;
+        uint64_t time = (hi << 32) + (mi << 16) + lo;
+
+        one_hit.set_timestamp_native(time);
+
+        if (sourcechan < 0)
+          ordered.pop_back();
+      }
+
+      //stable, so equal timestamps keep channel order as multiset insertion did
+      ordered.sort();
+      spill_events += ordered.size();
+      spill->hits.splice(spill->hits.end(), ordered);
+    };
+  }
+  return spill_events;
+}
 
 }
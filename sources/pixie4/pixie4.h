@@ -51,8 +51,9 @@ public:
   bool write_settings_bulk(Qpx::Setting &set) override;
   bool read_settings_bulk(Qpx::Setting &set) const override;
   void get_all_settings() override;
+  void get_volatile_settings() override;
   bool boot() override;
-  bool die() override {status_ = SourceStatus::loaded | SourceStatus::can_boot; return true;}
+  bool die() override {status_ = SourceStatus::loaded | SourceStatus::can_boot; replaying_ = false; return true;}
 
   std::list<Hit> oscilloscope() override;
 
@@ -69,6 +70,9 @@ protected:
   //setup
   int  run_type_;
   int  run_poll_interval_ms_;
+  bool keep_raw_;
+  std::string replay_file_;
+  bool replaying_;
 
   std::string XIA_file_directory_;
   std::vector<std::string> boot_files_;
@@ -86,7 +90,11 @@ protected:
   SynchronizedQueue<Spill*>* raw_queue_;
 
   static void worker_parse(Pixie4* callback, SynchronizedQueue<Spill*>* in_queue, SynchronizedQueue<Spill*>* out_queue);
+  static uint64_t parse_spill(Spill* spill,
+                              const std::vector<std::vector<int32_t>> &channel_indices,
+                              const HitModel &model);
   static void worker_run_dbl(Pixie4* callback, SynchronizedQueue<Spill*>* spill_queue);
+  static void worker_replay(Pixie4* callback, SynchronizedQueue<Spill*>* spill_queue);
 
   //CONVENIENCE FUNCTIONS//
   void rebuild_structure(Qpx::Setting &set);
@@ -282,21 +282,27 @@ bool Simulator2D::boot() {
   std::vector<double> distribution(resolution_*resolution_, 0.0);   //optimize somehow
 
   uint32_t res = pow(2, source_res);
-  std::unique_ptr<std::list<Qpx::Entry>> spec_list(spectrum->data_range({{0,res},{0,res}}));
+  Qpx::SparseData spec_list;
+  spectrum->data_sparse({{0,res},{0,res}}, spec_list);
+  const size_t *coords = spec_list.coords.data();
 
   if (adjust_bits >= 0)
   {
-    for (auto it : *spec_list)
-      distribution[(it.first[0] >> adjust_bits) * resolution_
-          + (it.first[1] >> adjust_bits)]
-          =  static_cast<double>(it.second) / totevts;
+    for (auto &val : spec_list.values) {
+      distribution[(coords[0] >> adjust_bits) * resolution_
+          + (coords[1] >> adjust_bits)]
+          =  val / totevts;
+      coords += 2;
+    }
   }
   else
   {
-    for (auto it : *spec_list)
-      distribution[(it.first[0] << (-adjust_bits)) * resolution_
-          + (it.first[1] << (-adjust_bits))]
-          =  static_cast<double>(it.second) / totevts;
+    for (auto &val : spec_list.values) {
+      distribution[(coords[0] << (-adjust_bits)) * resolution_
+          + (coords[1] << (-adjust_bits))]
+          =  val / totevts;
+      coords += 2;
+    }
   }
 
   LINFO << "<Simulator2D> Creating discrete distribution for simulation";